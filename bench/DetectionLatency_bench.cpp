@@ -0,0 +1,161 @@
+#include "pch.h"
+#include "NoHangConfig.h"
+#include "ScenarioGenerator.h"
+#include "SystemSnapshot.h"
+#include "TrayApp.h"
+#include <QApplication>
+#include <QEventLoop>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// End-to-end detection latency. A ScenarioGenerator plays each crisis into
+// fake /proc and /sys files while a TrayApp samples them; a trial times the
+// write that first crosses a nohang threshold (judged by the stateless
+// iconNameFor on a snapshot of the same files) to the moment the tray
+// publishes a raised icon. Each trial starts at a random offset so the
+// crossing lands anywhere in the sampler and render periods.
+//
+// Scheduling modes: the sampler thread at the default policy, and with
+// --lock-memory, which asks for SCHED_FIFO (silently the default policy
+// without CAP_SYS_NICE) and locks the process in RAM.
+
+static constexpr int kTrials = 25;
+static constexpr auto kStep = std::chrono::milliseconds(5);   // one scenario step
+static constexpr int kMaxStartDelayMs = 1000;                 // one render period
+static constexpr int kTimeoutMs = 5000;
+
+using Clock = std::chrono::steady_clock;
+
+static const QString kNormalIcon = QStringLiteral("security-low");
+
+static const char kConfig[] =
+    "warning_threshold_min_mem = 25 %\n"
+    "soft_threshold_min_mem = 10 %\n"
+    "hard_threshold_min_mem = 5 %\n"
+    "warning_threshold_min_swap = 50 %\n"
+    "hard_threshold_min_swap = 10 %\n"
+    "warning_threshold_max_zram = 50 %\n"
+    "hard_threshold_max_zram = 90 %\n"
+    "warning_threshold_max_psi = 20\n"
+    "soft_threshold_max_psi = 40\n"
+    "hard_threshold_max_psi = 80\n"
+    "psi_metrics = some\n"
+    "psi_excess_duration = 0\n";
+
+// Run the event loop until done() holds, false on timeout
+static bool waitFor(TrayApp& tray, const std::function<bool()>& done, int timeoutMs) {
+    if (done()) return true;
+    QEventLoop loop;
+    QObject::connect(&tray, &TrayApp::iconChanged, &loop, [&] {
+        if (done()) loop.quit();
+    });
+    QTimer::singleShot(timeoutMs, &loop, &QEventLoop::quit);
+    loop.exec();
+    return done();
+}
+
+static double percentile(std::vector<double> v, double q) {
+    // Nearest rank
+    std::sort(v.begin(), v.end());
+    const size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(v.size())));
+    return v[std::clamp<size_t>(rank, 1, v.size()) - 1];
+}
+
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    ScenarioGenerator gen;
+    if (!gen.isValid()) {
+        std::fprintf(stderr, "cannot create the scenario root\n");
+        return 1;
+    }
+    const QString cfgPath = gen.root() + QStringLiteral("/nohang.conf");
+    QFile cfgFile(cfgPath);
+    if (!cfgFile.open(QIODevice::WriteOnly) || cfgFile.write(kConfig) < 0) return 1;
+    cfgFile.close();
+    NoHangConfig cfg;
+    cfg.ensureParsed(cfgPath);
+
+    struct Mode {
+        const char* name;
+        bool lockMemory;
+    };
+    static constexpr Mode kModes[] = {{"default", false}, {"lock-memory", true}};
+
+    std::printf("%-12s %-12s %9s %9s %7s\n", "mode", "scenario", "p50 ms", "p99 ms", "missed");
+    for (const Mode& mode : kModes) {
+        gen.write(ScenarioGenerator::Scenario::LinearLeak, 0);
+        TrayApp tray;
+        QString icon;
+        Clock::time_point changedAt;
+        QObject::connect(&tray, &TrayApp::iconChanged, [&](const QString& name) {
+            icon = name;
+            changedAt = Clock::now();
+        });
+        tray.setSnapshotRoots(gen.procRoot(), gen.sysRoot());
+        tray.setFixedConfig(cfgPath);
+        tray.setCgroupSubtree(QString());
+        tray.setLimitCgroup(QString());
+        tray.setWatchCgroups({});
+        tray.setDBusEnabled(false);
+        tray.setLockMemory(mode.lockMemory);
+        tray.start();
+
+        for (const ScenarioGenerator::Scenario s : ScenarioGenerator::kScenarios) {
+            std::vector<double> latencies;
+            int missed = 0;
+            for (int trial = 0; trial < kTrials; ++trial) {
+                gen.write(s, 0);
+                if (!waitFor(tray, [&] { return icon == kNormalIcon; }, kTimeoutMs)) {
+                    ++missed;
+                    continue;
+                }
+
+                std::atomic<bool> stop {false};
+                std::atomic<Clock::rep> crossedAt {0}; // 0 until crossed
+                const int delayMs = QRandomGenerator::global()->bounded(kMaxStartDelayMs);
+                std::thread writer([&] {
+                    SystemSnapshot ref(gen.procRoot(), gen.sysRoot());
+                    std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+                    const int last = ScenarioGenerator::steps(s) - 1;
+                    for (int step = 1; !stop.load(std::memory_order_relaxed); ++step) {
+                        gen.write(s, std::min(step, last));
+                        const Clock::rep at = Clock::now().time_since_epoch().count();
+                        if (crossedAt.load(std::memory_order_relaxed) == 0) {
+                            ref.refresh();
+                            if (TrayApp::iconNameFor(cfg, ref) != kNormalIcon) crossedAt.store(at);
+                        }
+                        std::this_thread::sleep_for(kStep);
+                    }
+                });
+                const bool raised = waitFor(tray, [&] { return icon != kNormalIcon; }, kMaxStartDelayMs + kTimeoutMs);
+                stop = true;
+                writer.join();
+                const Clock::rep crossed = crossedAt.load();
+                if (!raised || crossed == 0) {
+                    ++missed;
+                    continue;
+                }
+                const auto latency = changedAt - Clock::time_point(Clock::duration(crossed));
+                latencies.push_back(std::chrono::duration<double, std::milli>(latency).count());
+            }
+            if (latencies.empty()) {
+                std::printf("%-12s %-12s %9s %9s %7d\n", mode.name, ScenarioGenerator::name(s), "-", "-", missed);
+                continue;
+            }
+            std::printf("%-12s %-12s %9.1f %9.1f %7d\n", mode.name, ScenarioGenerator::name(s),
+                        percentile(latencies, 0.50), percentile(latencies, 0.99), missed);
+        }
+    }
+    return 0;
+}
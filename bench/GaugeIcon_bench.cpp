@@ -0,0 +1,45 @@
+#include "pch.h"
+#include "GaugeIcon.h"
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <cstdio>
+
+// Cost of the painted tray icon per tick: an icon for a state never seen
+// (one pixmap painted per size) against one already cached, which is what
+// a steady or oscillating system pays.
+
+static constexpr int kTicks = 10000;
+
+int main(int argc, char** argv) {
+    qputenv("QT_QPA_PLATFORM", QByteArray("offscreen"));
+    QGuiApplication app(argc, argv);
+    GaugeIcon g;
+
+    QElapsedTimer timer;
+    timer.start();
+    int states = 0;
+    for (int ram = 0; ram <= GaugeIcon::kLevels; ++ram) {
+        for (int psi = 0; psi <= GaugeIcon::kLevels; ++psi, ++states) {
+            GaugeIcon::State s;
+            s.ram = static_cast<quint8>(ram);
+            s.psi = static_cast<quint8>(psi);
+            g.update(s, GaugeIcon::Theme::Light);
+            g.icon();
+        }
+    }
+    std::printf("new state:    %.1f us per icon (%d pixmaps painted, %d cached in %lld KiB)\n",
+                timer.nsecsElapsed() / 1e3 / states, g.painted(), g.cached(),
+                static_cast<long long>(g.cachedBytes() / 1024));
+
+    const int painted = g.painted();
+    timer.restart();
+    for (int t = 0; t < kTicks; ++t) {
+        GaugeIcon::State s;
+        s.ram = static_cast<quint8>(t % 2 + 3); // flips between two cached states
+        g.update(s, GaugeIcon::Theme::Light);
+        g.icon();
+    }
+    std::printf("cached state: %.1f us per icon (%d painted)\n", timer.nsecsElapsed() / 1e3 / kTicks,
+                g.painted() - painted);
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include "pch.h"
+#include "HistoryWindow.h"
+#include "SystemSnapshot.h"
+#include "Thresholds.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <cmath>
+#include <cstdio>
+
+// Cost of the history chart with a full day of samples: a full redraw per
+// range (LTTB over every sample shown, then the lines) and the per-tick
+// partial redraw that runs while the window is open. A full 24 h redraw
+// should stay close to the 5 min one since both draw one point per column.
+
+static constexpr int kRounds = 20;
+static constexpr int kTicks = 600;
+static constexpr qint64 kStartMs = 1700000000000;
+
+static SampleHistory::Values values(int i) {
+    const double wave = std::sin(i * 2 * M_PI / 3600.0);
+    return {float(6000 + 3000 * wave), float(4096 - (i % 7200) * 0.5), float((i % 7200) * 0.5),
+            float(std::max(0.0, 20 * wave)), float(std::max(0.0, 10 * wave))};
+}
+
+int main(int argc, char** argv) {
+    qputenv("QT_QPA_PLATFORM", QByteArray("offscreen"));
+    QApplication app(argc, argv);
+    QTemporaryDir dir;
+    SystemSnapshot snap(dir.path(), dir.path());
+    ThresholdSet th;
+    th.warn_mem_free.mib = 2000;
+    th.soft_mem_free.mib = 1000;
+    th.hard_mem_free.mib = 500;
+
+    SampleHistory history;
+    int i = 0;
+    for (; i < SampleHistory::kDefaultCapacity; ++i)
+        history.append(kStartMs + qint64(i) * 1000, values(i), Severity::Normal);
+
+    HistoryWindow w(&history);
+    w.resize(1600, 700);
+    w.show();
+    QApplication::processEvents();
+    w.refresh(th, snap);
+
+    for (int seconds : HistoryWindow::kRangesSeconds) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int r = 0; r < kRounds; ++r) w.setRangeSeconds(seconds + 1 - r % 2); // each a new range
+        std::printf("full redraw %6d s: %.2f ms (%d columns)\n", seconds, timer.nsecsElapsed() / 1e6 / kRounds,
+                    w.columns());
+    }
+
+    const int before = w.partialRedraws();
+    QElapsedTimer timer;
+    timer.start();
+    for (int t = 0; t < kTicks; ++t, ++i) {
+        history.append(kStartMs + qint64(i) * 1000, values(i), Severity::Normal);
+        w.refresh(th, snap);
+    }
+    std::printf("tick at 24 h: %.3f ms per sample (%d partial, %d full redraws)\n",
+                timer.nsecsElapsed() / 1e6 / kTicks, w.partialRedraws() - before, w.fullRedraws());
+    return 0;
+}
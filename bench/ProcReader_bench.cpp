@@ -0,0 +1,86 @@
+#include "pch.h"
+#include "../tests/FakeProc.h"
+#include "ProcReader.h"
+#include "SystemSnapshot.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <cstdio>
+
+// Compares syscalls and wall time per refresh between the pread and io_uring
+// backends, for SystemSnapshot itself and for a wide batch that mimics a
+// refresh touching dozens of small files.
+
+static constexpr int kIterations = 2000;
+
+using FakeProc::writeFile;
+
+static void makeFixture(const QString& root, QStringList* wide) {
+    writeFile(root + "/proc/meminfo",
+              "MemTotal:       16384000 kB\nMemAvailable:    8192000 kB\n"
+              "SwapTotal:       4096000 kB\nSwapFree:        2048000 kB\n");
+    writeFile(root + "/proc/swaps",
+              "Filename Type Size Used Priority\n/dev/zram0 partition 4096000 2048000 100\n");
+    writeFile(root + "/proc/pressure/memory",
+              "some avg10=1.00 avg60=0.50 avg300=0.10 total=1000\n"
+              "full avg10=0.50 avg60=0.20 avg300=0.05 total=500\n");
+    writeFile(root + "/sys/block/zram0/disksize", "4294967296\n");
+    writeFile(root + "/sys/block/zram0/mm_stat", "1048576 524288 600000 0 700000 10 0\n");
+    for (int i = 0; i < 48; ++i) {
+        const QString p = root + QStringLiteral("/sys/fs/cgroup/slice%1/memory.current").arg(i);
+        writeFile(p, QByteArray::number(1048576ll * (i + 1)) + '\n');
+        *wide << p;
+    }
+}
+
+static void benchSnapshot(const char* label, const QString& procRoot, const QString& sysRoot,
+                          ProcReader::Backend backend) {
+    SystemSnapshot snap(procRoot, sysRoot, ProcReader::create(backend));
+    snap.refresh(); // open everything once
+    const quint64 before = snap.reader().syscalls();
+    QElapsedTimer t;
+    t.start();
+    for (int i = 0; i < kIterations; ++i) snap.refresh();
+    const double us = t.nsecsElapsed() / 1000.0 / kIterations;
+    std::printf("%-28s %-9s %8.2f syscalls/refresh %9.2f us/refresh\n", label,
+                snap.reader().backend() == ProcReader::Backend::IoUring ? "io_uring" : "pread",
+                double(snap.reader().syscalls() - before) / kIterations, us);
+}
+
+static void benchWide(const char* label, const QStringList& paths, ProcReader::Backend backend) {
+    auto r = ProcReader::create(backend);
+    for (const QString& p : paths) r->add(p);
+    r->readAll();
+    const quint64 before = r->syscalls();
+    QElapsedTimer t;
+    t.start();
+    for (int i = 0; i < kIterations; ++i) r->readAll();
+    const double us = t.nsecsElapsed() / 1000.0 / kIterations;
+    std::printf("%-28s %-9s %8.2f syscalls/refresh %9.2f us/refresh (%lld files)\n", label,
+                r->backend() == ProcReader::Backend::IoUring ? "io_uring" : "pread",
+                double(r->syscalls() - before) / kIterations, us, static_cast<long long>(paths.size()));
+}
+
+int main() {
+    QTemporaryDir dir;
+    QStringList fixtureWide;
+    makeFixture(dir.path(), &fixtureWide);
+
+    QStringList liveWide{QStringLiteral("/proc/meminfo"), QStringLiteral("/proc/vmstat"),
+                         QStringLiteral("/proc/swaps"), QStringLiteral("/proc/pressure/memory"),
+                         QStringLiteral("/proc/pressure/cpu"), QStringLiteral("/proc/pressure/io"),
+                         QStringLiteral("/proc/loadavg"), QStringLiteral("/proc/stat")};
+    for (const QString& name : QDir(QStringLiteral("/sys/fs/cgroup")).entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+        for (const char* f : {"memory.current", "memory.max", "memory.swap.current", "memory.pressure"})
+            if (QFile::exists(QStringLiteral("/sys/fs/cgroup/%1/%2").arg(name, QLatin1String(f))))
+                liveWide << QStringLiteral("/sys/fs/cgroup/%1/%2").arg(name, QLatin1String(f));
+
+    for (auto backend : {ProcReader::Backend::Pread, ProcReader::Backend::IoUring}) {
+        benchSnapshot("snapshot, fixture tree", dir.path() + "/proc", dir.path() + "/sys", backend);
+        benchSnapshot("snapshot, live /proc", QStringLiteral("/proc"), QStringLiteral("/sys"), backend);
+        benchWide("wide batch, fixture tree", fixtureWide, backend);
+        benchWide("wide batch, live /proc", liveWide, backend);
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include "pch.h"
+#include "ThresholdSimulator.h"
+#include <QElapsedTimer>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// A week of 1 s samples judged against 36 candidate configs, a grid of RAM
+// and PSI thresholds. The goal is well under a second for all of them.
+
+static constexpr int kSamples = 7 * 24 * 3600;
+static constexpr int kMemSteps = 6;
+static constexpr int kPsiSteps = 6;
+
+int main() {
+    ThresholdSimulator sim;
+    sim.reserve(kSamples);
+    for (int i = 0; i < kSamples; ++i) {
+        // Daily working set swings plus a leak that is restarted every 5 h
+        ThresholdSimulator::Sample s;
+        const double day = std::sin(i * 2 * M_PI / 86400.0);
+        s.memTotalMiB = 16384;
+        s.memAvailableMiB = static_cast<float>(6000 + 3000 * day - (i % 18000) * 0.3);
+        s.swapTotalMiB = 8192;
+        s.swapFreeMiB = static_cast<float>(8192 - (i % 18000) * 0.2);
+        s.zramDiskMiB = 8192;
+        s.zramUsedMiB = 8192 - s.swapFreeMiB;
+        s.psiSomeAvg10 = static_cast<float>(std::max(0.0, 40 - s.memAvailableMiB / 100.0));
+        s.psiFullAvg10 = s.psiSomeAvg10 / 2;
+        sim.append(qint64(i) * 1000, s);
+    }
+
+    std::vector<ThresholdsPercent> configs;
+    for (int m = 0; m < kMemSteps; ++m) {
+        for (int p = 0; p < kPsiSteps; ++p) {
+            ThresholdsPercent t;
+            t.warn_mem_percent = 20 + 2 * m;
+            t.soft_mem_percent = 8 + m;
+            t.hard_mem_percent = 4;
+            t.warn_swap_percent_free = 30;
+            t.warn_zram_percent_used = 70;
+            t.warn_psi = 10 + 5 * p;
+            t.soft_psi = 30 + 5 * p;
+            t.psi_metrics = QStringLiteral("some");
+            t.psi_duration = 10;
+            configs.push_back(t);
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    long long events = 0;
+    for (const ThresholdsPercent& t : configs) {
+        const ThresholdSimulator::Result r = sim.evaluate(t);
+        events += r.events[ThresholdSimulator::Warn];
+    }
+    const qint64 ms = timer.elapsed();
+    std::printf("%zu configs over %d samples in %lld ms (%.1f ms each), %lld warn events\n", configs.size(), kSamples,
+                static_cast<long long>(ms), double(ms) / configs.size(), events);
+    return 0;
+}
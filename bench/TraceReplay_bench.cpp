@@ -0,0 +1,55 @@
+#include "pch.h"
+#include "SeverityEngine.h"
+#include "SystemSnapshot.h"
+#include "Thresholds.h"
+#include "TraceReplay.h"
+#include <QElapsedTimer>
+#include <cstdio>
+
+// A day of 1 s samples, generated in memory, replayed as fast as possible
+// through SystemSnapshot, Thresholds::compute and SeverityEngine. The goal
+// is well under a second.
+
+static constexpr int kFrames = 86400;
+
+static QByteArray dayTrace() {
+    QByteArray text;
+    text.reserve(qsizetype(kFrames) * 420);
+    for (int i = 0; i < kFrames; ++i) {
+        // A slow sawtooth leak so the engine has transitions to make
+        const qint64 availableKiB = 8 * 1024 * 1024 - qint64(i % 3600) * 2200;
+        text += "@" + QByteArray::number(qint64(i) * 1000) + "\n";
+        text += "==> /proc/meminfo <==\nMemTotal:       16777216 kB\nMemFree:         1048576 kB\nMemAvailable:    ";
+        text += QByteArray::number(availableKiB) + " kB\nSwapTotal:       8388608 kB\nSwapFree:        8000000 kB\n";
+        text += "\n==> /proc/swaps <==\nFilename\tType\tSize\tUsed\tPriority\n/dev/zram0\tpartition\t8388604\t388608\t100\n";
+        text += "\n==> /proc/pressure/memory <==\nsome avg10=0.50 avg60=0.20 avg300=0.10 total=1\n"
+                "full avg10=0.10 avg60=0.00 avg300=0.00 total=1\n";
+        text += "\n==> /sys/block/zram0/disksize <==\n8589930496\n";
+        text += "\n==> /sys/block/zram0/mm_stat <==\n397934592 99483648 104857600 0 104857600 0 0\n";
+    }
+    return text;
+}
+
+int main() {
+    TraceReplay replay;
+    replay.setTrace(dayTrace());
+    const SystemSnapshot& snap = replay.snapshot();
+    ThresholdsPercent t;
+    t.warn_mem_percent = 20;
+    t.soft_mem_percent = 10;
+    t.hard_mem_percent = 5;
+    SeverityEngine severity;
+    int transitions = 0;
+    QObject::connect(&replay, &TraceReplay::sampled, [&] {
+        const ThresholdSet th = Thresholds::compute(t, snap);
+        if (severity.update(th, snap, replay.nowMs() / 1000.0)) ++transitions;
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    replay.run();
+    const qint64 ms = timer.elapsed();
+    std::printf("replayed %d frames in %lld ms (%.0f frames/s), %d transitions\n", replay.position(),
+                static_cast<long long>(ms), ms > 0 ? replay.position() * 1000.0 / ms : 0.0, transitions);
+    return 0;
+}
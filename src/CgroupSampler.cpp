@@ -0,0 +1,214 @@
+// ===== src/CgroupSampler.cpp =====
+#include "pch.h"
+#include "CgroupSampler.h"
+#include "ProcParse.h"
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+static constexpr uint32_t kDirEvents = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+// memory.current, memory.max and memory.swap.current hold one number,
+// memory.pressure two short lines; ProcReader grows a buffer if one fills
+static constexpr qsizetype kValueBuffer = 32;
+static constexpr qsizetype kPressureBuffer = 256;
+
+CgroupSampler::CgroupSampler(const QString& cgroupRoot, const QString& subtree, int maxDepth,
+                             ProcReader::Backend backend)
+    : m_cgroupRoot(cgroupRoot), m_maxDepth(maxDepth), m_backend(backend) {
+    m_root = m_cgroupRoot;
+    const QString sub = subtree.startsWith(QLatin1Char('/')) ? subtree.mid(1) : subtree;
+    if (!sub.isEmpty()) m_root += QLatin1Char('/') + sub;
+}
+
+CgroupSampler::~CgroupSampler() {
+    if (m_inotify >= 0) ::close(m_inotify);
+}
+
+void CgroupSampler::drainEvents() {
+    if (m_inotify < 0) return;
+    alignas(inotify_event) char buf[4096];
+    for (;;) {
+        const ssize_t n = ::read(m_inotify, buf, sizeof(buf));
+        if (n <= 0) break; // EAGAIN: nothing pending
+        for (ssize_t off = 0; off < n;) {
+            const auto* e = reinterpret_cast<const inotify_event*>(buf + off);
+            off += static_cast<ssize_t>(sizeof(inotify_event) + e->len);
+            if (e->mask & IN_Q_OVERFLOW) {
+                m_stale = true; // events were lost, only a full walk is safe
+                continue;
+            }
+            const auto it = m_watches.constFind(e->wd);
+            if (it == m_watches.cend()) continue; // a subtree already dropped
+            if (e->mask & IN_IGNORED) {
+                // The kernel removed the watch; for the walk root itself,
+                // walk again so usage() empties
+                if (it->isEmpty()) m_stale = true;
+                m_watches.erase(it);
+                continue;
+            }
+            if (!(e->mask & IN_ISDIR) || e->len == 0) continue;
+            const QString parent = *it; // the handlers change m_watches
+            const QString name = QFile::decodeName(e->name);
+            if (e->mask & (IN_CREATE | IN_MOVED_TO)) childAdded(parent, name);
+            else childRemoved(parent, name);
+        }
+    }
+}
+
+void CgroupSampler::walk() {
+    // Start over on the same reader and inotify instance, dropping every
+    // slot and watch of the previous walk
+    if (!m_reader) m_reader = ProcReader::create(m_backend);
+    if (m_inotify < 0) m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    for (qsizetype i = 0; i < m_nodes.size(); ++i) drop(i);
+    m_nodes.clear();
+    m_usage.clear();
+    m_watches.clear();
+    ++m_walks;
+    walkDir(QString(), 0);
+}
+
+bool CgroupSampler::walkDir(const QString& rel, int depth) {
+    const QString dir = rel.isEmpty() ? m_root : m_root + QLatin1Char('/') + rel;
+    const QByteArray dirName = QFile::encodeName(dir);
+    DIR* d = opendir(dirName.constData());
+    if (!d) return false;
+
+    Node n;
+    // Watch before listing, so a child created in between is not missed.
+    // Nodes at the depth limit are leaves whatever their children.
+    if (m_inotify >= 0 && depth < m_maxDepth) {
+        n.wd = inotify_add_watch(m_inotify, dirName.constData(), kDirEvents);
+        if (n.wd >= 0) m_watches.insert(n.wd, rel);
+    }
+
+    CgroupUsage u;
+    u.path = rel;
+    u.depth = depth;
+    // The root cgroup has no memory.current on older kernels, do not keep
+    // retrying files that are not there
+    auto slot = [&](const char* name, qsizetype size) {
+        const QString path = dir + QLatin1Char('/') + QLatin1String(name);
+        return QFile::exists(path) ? m_reader->add(path, size) : -1;
+    };
+    n.current = slot("memory.current", kValueBuffer);
+    n.max = slot("memory.max", kValueBuffer);
+    n.swap = slot("memory.swap.current", kValueBuffer);
+    n.pressure = slot("memory.pressure", kPressureBuffer);
+
+    QStringList children;
+    while (depth < m_maxDepth) {
+        dirent* e = readdir(d);
+        if (!e) break;
+        if (e->d_name[0] == '.') continue;
+        if (e->d_type != DT_DIR && e->d_type != DT_UNKNOWN) continue;
+        const QString name = QFile::decodeName(e->d_name);
+        if (e->d_type == DT_UNKNOWN && !QFileInfo(dir + QLatin1Char('/') + name).isDir()) continue;
+        children.push_back(name);
+    }
+    closedir(d);
+
+    const qsizetype index = m_usage.size();
+    m_usage.push_back(u);
+    m_nodes.push_back(n);
+    children.sort();
+    int walked = 0;
+    for (const QString& c : std::as_const(children))
+        walked += walkDir(rel.isEmpty() ? c : rel + QLatin1Char('/') + c, depth + 1);
+    m_nodes[index].children = walked;
+    m_usage[index].leaf = walked == 0;
+    return true;
+}
+
+void CgroupSampler::childAdded(const QString& parent, const QString& name) {
+    const qsizetype p = indexOf(parent);
+    if (p < 0) return;
+    const QString rel = parent.isEmpty() ? name : parent + QLatin1Char('/') + name;
+    if (indexOf(rel) >= 0) return; // already listed by the walk that added the watch
+    if (!walkDir(rel, m_usage[p].depth + 1)) return; // gone again
+    ++m_nodes[p].children;
+    m_usage[p].leaf = false;
+    ++m_updates;
+}
+
+void CgroupSampler::childRemoved(const QString& parent, const QString& name) {
+    const QString rel = parent.isEmpty() ? name : parent + QLatin1Char('/') + name;
+    if (indexOf(rel) < 0) return;
+    const QString prefix = rel + QLatin1Char('/');
+    for (qsizetype i = m_usage.size() - 1; i >= 0; --i) {
+        const QString& path = m_usage[i].path;
+        if (path != rel && !path.startsWith(prefix)) continue;
+        drop(i);
+        m_usage.remove(i);
+        m_nodes.remove(i);
+    }
+    const qsizetype p = indexOf(parent);
+    if (p >= 0 && --m_nodes[p].children == 0) m_usage[p].leaf = true;
+    ++m_updates;
+}
+
+void CgroupSampler::drop(qsizetype i) {
+    const Node& n = m_nodes[i];
+    for (int slot : {n.current, n.max, n.swap, n.pressure})
+        if (slot >= 0) m_reader->remove(slot);
+    if (n.wd >= 0 && m_watches.remove(n.wd)) inotify_rm_watch(m_inotify, n.wd);
+}
+
+qsizetype CgroupSampler::indexOf(const QString& rel) const {
+    for (qsizetype i = 0; i < m_usage.size(); ++i)
+        if (m_usage[i].path == rel) return i;
+    return -1;
+}
+
+void CgroupSampler::sample() {
+    drainEvents();
+    if (m_stale) {
+        m_stale = false;
+        walk();
+    }
+    m_reader->readAll();
+
+    auto value = [&](int slot, qint64 missing) -> qint64 {
+        if (slot < 0 || !m_reader->ok(slot)) return missing;
+        return ProcParse::cgroupValue(m_reader->data(slot), missing);
+    };
+    for (qsizetype i = 0; i < m_usage.size(); ++i) {
+        const Node& n = m_nodes[i];
+        CgroupUsage& u = m_usage[i];
+        u.currentBytes = value(n.current, -1);
+        u.maxBytes = value(n.max, -1);
+        u.swapCurrentBytes = value(n.swap, 0);
+        u.someAvg10 = u.fullAvg10 = 0;
+        if (n.pressure >= 0 && m_reader->ok(n.pressure)) {
+            ProcParse::forEachLine(m_reader->data(n.pressure), [&](QByteArrayView line) {
+                if (line.startsWith("some ")) u.someAvg10 = ProcParse::keyedValue(line, "avg10=");
+                else if (line.startsWith("full ")) u.fullAvg10 = ProcParse::keyedValue(line, "avg10=");
+            });
+        }
+    }
+}
+
+template <typename Keep>
+static QVector<CgroupUsage> largest(const QVector<CgroupUsage>& all, int n, Keep keep) {
+    QVector<CgroupUsage> out;
+    for (const CgroupUsage& u : all)
+        if (keep(u) && u.currentBytes >= 0) out.push_back(u);
+    const qsizetype k = std::min<qsizetype>(std::max(n, 0), out.size());
+    std::partial_sort(out.begin(), out.begin() + k, out.end(), [](const CgroupUsage& a, const CgroupUsage& b) {
+        return a.currentBytes != b.currentBytes ? a.currentBytes > b.currentBytes : a.path < b.path;
+    });
+    out.resize(k);
+    return out;
+}
+
+QVector<CgroupUsage> CgroupSampler::topLeaves(int n) const {
+    return largest(m_usage, n, [](const CgroupUsage& u) { return u.leaf && u.depth > 0; });
+}
+
+QVector<CgroupUsage> CgroupSampler::topChildren(int n) const {
+    return largest(m_usage, n, [](const CgroupUsage& u) { return u.depth == 1; });
+}
@@ -0,0 +1,197 @@
+// ===== src/DBusService.cpp =====
+#include "pch.h"
+#include "DBusService.h"
+#include "SampleHistory.h"
+#include "SystemSnapshot.h"
+#include "Thresholds.h"
+#include <QDBusVariant>
+
+static const QString kPropertiesInterface = QStringLiteral("org.freedesktop.DBus.Properties");
+
+DBusService::DBusService(const SampleHistory* history, QObject* parent)
+    : QDBusVirtualObject(parent), m_history(history) {}
+
+DBusService::~DBusService() { unregister(); }
+
+bool DBusService::registerOn(const QDBusConnection& bus, QString* error) {
+    unregister();
+    m_bus = bus;
+    if (!m_bus.isConnected()) {
+        if (error) *error = QStringLiteral("no session bus: ") + m_bus.lastError().message();
+        return false;
+    }
+    if (!m_bus.registerVirtualObject(QString::fromLatin1(kPath), this)) {
+        if (error) *error = QStringLiteral("%1 is taken").arg(QString::fromLatin1(kPath));
+        return false;
+    }
+    m_registered = true;
+    if (!m_bus.registerService(QString::fromLatin1(kService))) {
+        if (error) *error = QStringLiteral("%1 is owned by another tray").arg(QString::fromLatin1(kService));
+        unregister();
+        return false;
+    }
+    return true;
+}
+
+void DBusService::unregister() {
+    if (!m_registered) return;
+    m_bus.unregisterObject(QString::fromLatin1(kPath));
+    m_bus.unregisterService(QString::fromLatin1(kService));
+    m_registered = false;
+}
+
+static QVariantMap thresholdMap(const ThresholdSet& th) {
+    QVariantMap m;
+    auto put = [&m](const char* key, const std::optional<double>& v) {
+        if (v) m.insert(QLatin1String(key), *v); // unset thresholds are absent
+    };
+    put("WarnMemFreeMiB", th.warn_mem_free.mib);
+    put("WarnSwapFreeMiB", th.warn_swap_free.mib);
+    put("WarnZramUsedMiB", th.warn_zram_used.mib);
+    put("WarnPsi", th.warn_psi);
+    put("SoftMemFreeMiB", th.soft_mem_free.mib);
+    put("SoftSwapFreeMiB", th.soft_swap_free.mib);
+    put("SoftZramUsedMiB", th.soft_zram_used.mib);
+    put("SoftPsi", th.soft_psi);
+    put("HardMemFreeMiB", th.hard_mem_free.mib);
+    put("HardSwapFreeMiB", th.hard_swap_free.mib);
+    put("HardZramUsedMiB", th.hard_zram_used.mib);
+    put("HardPsi", th.hard_psi);
+    put("PsiDuration", th.psi_duration);
+    if (!th.psi_metrics.isEmpty()) m.insert(QStringLiteral("PsiMetrics"), th.psi_metrics);
+    return m;
+}
+
+void DBusService::update(const SnapshotData& d, const ThresholdSet& th, const SeverityEngine& severity, bool active) {
+    const Severity level = severity.level();
+    if (d.sampledAtMs == m_builtAtMs && level == m_level && active == m_active) return;
+
+    if (level != m_level) {
+        // Transitions only, a rebuilt sample at the same level stays quiet
+        QDBusMessage signal = QDBusMessage::createSignal(QString::fromLatin1(kPath), QString::fromLatin1(kInterface),
+                                                         QStringLiteral("SeverityChanged"));
+        signal << static_cast<uint>(level) << static_cast<uint>(m_level)
+               << (level == Severity::Normal ? QString() : SeverityEngine::name(severity.cause()));
+        if (m_registered) m_bus.send(signal);
+        ++m_severitySignals;
+    }
+    m_builtAtMs = d.sampledAtMs;
+    m_level = level;
+    m_active = active;
+
+    // Rebuilt in place; clients holding the previous reply keep their copy
+    m_properties.insert(QStringLiteral("Severity"), static_cast<uint>(level));
+    m_properties.insert(QStringLiteral("SeverityName"), SeverityEngine::name(level));
+    m_properties.insert(QStringLiteral("Cause"), level == Severity::Normal ? QString() : SeverityEngine::name(severity.cause()));
+    m_properties.insert(QStringLiteral("DaemonActive"), active);
+    m_properties.insert(QStringLiteral("SampledAtMs"), static_cast<qlonglong>(d.sampledAtMs));
+    m_properties.insert(QStringLiteral("Memory"), QVariantMap {
+        {QStringLiteral("MemTotalMiB"), d.mem.memTotalMiB},
+        {QStringLiteral("MemAvailableMiB"), d.mem.memAvailableMiB},
+        {QStringLiteral("MemAvailablePercent"), d.mem.memAvailablePercent},
+        {QStringLiteral("SwapTotalMiB"), d.mem.swapTotalMiB},
+        {QStringLiteral("SwapFreeMiB"), d.mem.swapFreeMiB},
+        {QStringLiteral("SwapFreePercent"), d.mem.swapFreePercent},
+    });
+    m_properties.insert(QStringLiteral("Zram"), QVariantMap {
+        {QStringLiteral("Present"), d.zram.present},
+        {QStringLiteral("DiskSizeMiB"), d.zram.diskSizeMiB},
+        {QStringLiteral("OrigDataMiB"), d.zram.origDataMiB},
+        {QStringLiteral("ComprDataMiB"), d.zram.comprDataMiB},
+        {QStringLiteral("MemUsedTotalMiB"), d.zram.memUsedTotalMiB},
+        {QStringLiteral("LogicalUsedPercent"), d.zram.logicalUsedPercent},
+    });
+    m_properties.insert(QStringLiteral("Psi"), QVariantMap {
+        {QStringLiteral("SomeAvg10"), d.psi.some_avg10},
+        {QStringLiteral("FullAvg10"), d.psi.full_avg10},
+    });
+    m_properties.insert(QStringLiteral("Thresholds"), thresholdMap(th));
+    m_getAllArgs = QVariantList {QVariant(m_properties)};
+    ++m_rebuilds;
+}
+
+QDBusMessage DBusService::reply(const QDBusMessage& call) const {
+    if (call.type() != QDBusMessage::MethodCallMessage) return {};
+    if (call.interface() == kPropertiesInterface) return propertyReply(call);
+    if (call.interface() == QLatin1String(kInterface) || call.interface().isEmpty()) {
+        if (call.member() == QLatin1String("GetHistory")) return historyReply(call);
+        return call.createErrorReply(QDBusError::UnknownMethod, QStringLiteral("No method %1").arg(call.member()));
+    }
+    return {};
+}
+
+QDBusMessage DBusService::propertyReply(const QDBusMessage& call) const {
+    const QList<QVariant> args = call.arguments();
+    const QString iface = args.value(0).toString();
+    if (!iface.isEmpty() && iface != QLatin1String(kInterface))
+        return call.createErrorReply(QDBusError::UnknownInterface, QStringLiteral("No interface %1").arg(iface));
+    if (call.member() == QLatin1String("GetAll")) return call.createReply(m_getAllArgs.isEmpty() ? QVariantList {QVariant(QVariantMap())} : m_getAllArgs);
+    if (call.member() == QLatin1String("Get")) {
+        const auto it = m_properties.constFind(args.value(1).toString());
+        if (it == m_properties.cend())
+            return call.createErrorReply(QDBusError::UnknownProperty, QStringLiteral("No property %1").arg(args.value(1).toString()));
+        return call.createReply(QVariant::fromValue(QDBusVariant(*it)));
+    }
+    if (call.member() == QLatin1String("Set"))
+        return call.createErrorReply(QDBusError::PropertyReadOnly, QStringLiteral("Properties are read-only"));
+    return call.createErrorReply(QDBusError::UnknownMethod, QStringLiteral("No method %1").arg(call.member()));
+}
+
+QDBusMessage DBusService::historyReply(const QDBusMessage& call) const {
+    const QList<QVariant> args = call.arguments();
+    bool okSeconds = false;
+    bool okResolution = false;
+    const uint seconds = args.value(0).toUInt(&okSeconds);
+    const uint resolution = args.value(1).toUInt(&okResolution);
+    if (args.size() != 2 || !okSeconds || !okResolution || seconds == 0 || resolution == 0)
+        return call.createErrorReply(QDBusError::InvalidArgs, QStringLiteral("GetHistory(u seconds, u resolution), both above 0"));
+
+    SampleHistory::Buckets b;
+    if (m_history && m_history->size() > 0) {
+        const qint64 latest = m_history->timeMs(m_history->size() - 1);
+        b = m_history->bucketed(latest - qint64(seconds) * 1000 + 1, qint64(resolution) * 1000);
+    }
+    QVariantList out {QVariant::fromValue(b.timeMs)};
+    for (const QList<double>& series : b.values) out << QVariant::fromValue(series);
+    out << b.severity;
+    return call.createReply(out);
+}
+
+QString DBusService::introspect(const QString& path) const {
+    if (path != QLatin1String(kPath)) return {};
+    return QStringLiteral(
+        "<interface name=\"org.archlars.NoHangTray\">\n"
+        "  <property name=\"Severity\" type=\"u\" access=\"read\"/>\n"
+        "  <property name=\"SeverityName\" type=\"s\" access=\"read\"/>\n"
+        "  <property name=\"Cause\" type=\"s\" access=\"read\"/>\n"
+        "  <property name=\"DaemonActive\" type=\"b\" access=\"read\"/>\n"
+        "  <property name=\"SampledAtMs\" type=\"x\" access=\"read\"/>\n"
+        "  <property name=\"Memory\" type=\"a{sv}\" access=\"read\"/>\n"
+        "  <property name=\"Zram\" type=\"a{sv}\" access=\"read\"/>\n"
+        "  <property name=\"Psi\" type=\"a{sv}\" access=\"read\"/>\n"
+        "  <property name=\"Thresholds\" type=\"a{sv}\" access=\"read\"/>\n"
+        "  <method name=\"GetHistory\">\n"
+        "    <arg name=\"seconds\" type=\"u\" direction=\"in\"/>\n"
+        "    <arg name=\"resolution\" type=\"u\" direction=\"in\"/>\n"
+        "    <arg name=\"timeMs\" type=\"ax\" direction=\"out\"/>\n"
+        "    <arg name=\"memAvailableMiB\" type=\"ad\" direction=\"out\"/>\n"
+        "    <arg name=\"swapFreeMiB\" type=\"ad\" direction=\"out\"/>\n"
+        "    <arg name=\"zramUsedMiB\" type=\"ad\" direction=\"out\"/>\n"
+        "    <arg name=\"psiSomeAvg10\" type=\"ad\" direction=\"out\"/>\n"
+        "    <arg name=\"psiFullAvg10\" type=\"ad\" direction=\"out\"/>\n"
+        "    <arg name=\"severity\" type=\"ay\" direction=\"out\"/>\n"
+        "  </method>\n"
+        "  <signal name=\"SeverityChanged\">\n"
+        "    <arg name=\"level\" type=\"u\"/>\n"
+        "    <arg name=\"previous\" type=\"u\"/>\n"
+        "    <arg name=\"cause\" type=\"s\"/>\n"
+        "  </signal>\n"
+        "</interface>\n");
+}
+
+bool DBusService::handleMessage(const QDBusMessage& message, const QDBusConnection& connection) {
+    const QDBusMessage r = reply(message);
+    if (r.type() == QDBusMessage::InvalidMessage) return false; // not ours, let QtDBus answer
+    connection.send(r);
+    return true;
+}
@@ -0,0 +1,72 @@
+// ===== src/DBusService.h =====
+#pragma once
+#include "SeverityEngine.h"
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusVirtualObject>
+#include <QVariantMap>
+
+class SampleHistory;
+struct SnapshotData;
+struct ThresholdSet;
+
+// DBusService exports the tray's state on the session bus as
+// org.archlars.NoHangTray at /org/archlars/NoHangTray, so widgets and
+// scripts need not scrape the tooltip:
+//   properties  Severity, SeverityName, Cause, DaemonActive, SampledAtMs,
+//               Memory, Zram, Psi, Thresholds (the last four a{sv})
+//   method      GetHistory(u seconds, u resolution)
+//               -> (ax timeMs, ad memAvailableMiB, ad swapFreeMiB,
+//                   ad zramUsedMiB, ad psiSomeAvg10, ad psiFullAvg10,
+//                   ay severity), averaged per resolution seconds
+//   signal      SeverityChanged(u level, u previous, s cause)
+// Times are the sample timeline, CLOCK_MONOTONIC in ms.
+//
+// It is a virtual object rather than an adaptor so property reads are
+// answered from a reply built once per sample in update(), not by calling
+// getters and building maps for every client.
+class DBusService : public QDBusVirtualObject {
+    Q_OBJECT
+public:
+    static constexpr const char* kService = "org.archlars.NoHangTray";
+    static constexpr const char* kInterface = "org.archlars.NoHangTray";
+    static constexpr const char* kPath = "/org/archlars/NoHangTray";
+
+    explicit DBusService(const SampleHistory* history, QObject* parent = nullptr);
+    ~DBusService() override;
+
+    // Claim the service name and the object path on bus
+    bool registerOn(const QDBusConnection& bus, QString* error = nullptr);
+    void unregister();
+
+    // Refresh the cached properties and signal a severity change. Does
+    // nothing when neither the sample nor the severity moved.
+    void update(const SnapshotData& d, const ThresholdSet& th, const SeverityEngine& severity, bool active);
+
+    // The reply to one call on our interface or on org.freedesktop.DBus.Properties;
+    // an invalid message for calls that are not ours
+    QDBusMessage reply(const QDBusMessage& call) const;
+
+    const QVariantMap& properties() const { return m_properties; }
+    quint64 rebuilds() const { return m_rebuilds; }
+    quint64 severitySignals() const { return m_severitySignals; }
+
+    QString introspect(const QString& path) const override;
+    bool handleMessage(const QDBusMessage& message, const QDBusConnection& connection) override;
+
+private:
+    QDBusMessage historyReply(const QDBusMessage& call) const;
+    QDBusMessage propertyReply(const QDBusMessage& call) const;
+
+    const SampleHistory* m_history;
+    QDBusConnection m_bus {QString()};
+    bool m_registered {false};
+
+    QVariantMap m_properties;
+    QVariantList m_getAllArgs;         // {m_properties}, shared into every GetAll reply
+    qint64 m_builtAtMs {-1};
+    Severity m_level {Severity::Normal};
+    bool m_active {false};
+    quint64 m_rebuilds {0};
+    quint64 m_severitySignals {0};
+};
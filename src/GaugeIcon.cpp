@@ -0,0 +1,103 @@
+// ===== src/GaugeIcon.cpp =====
+#include "pch.h"
+#include "GaugeIcon.h"
+#include "SystemSnapshot.h"
+#include "Thresholds.h"
+#include <QGuiApplication>
+#include <QPainter>
+#include <QPalette>
+#include <algorithm>
+#include <cmath>
+
+static constexpr double kStick = 0.25; // of a step, see stateOf
+
+static QColor fillColor(const GaugeIcon::State& s) {
+    if (!s.active) return QColor(0x7f, 0x8c, 0x8d);
+    switch (s.severity) {
+    case Severity::Hard: return QColor(0xda, 0x44, 0x53);
+    case Severity::Warn:
+    case Severity::Soft: return QColor(0xf6, 0x74, 0x00);
+    case Severity::Normal: break;
+    }
+    return QColor(0x27, 0xae, 0x60);
+}
+
+GaugeIcon::Theme GaugeIcon::currentTheme() {
+    return QGuiApplication::palette().color(QPalette::Window).lightness() < 128 ? Theme::Dark : Theme::Light;
+}
+
+quint8 GaugeIcon::quantize(double fraction, quint8 previous) {
+    const double steps = std::clamp(fraction, 0.0, 1.0) * kLevels;
+    if (std::abs(steps - previous) < 0.5 + kStick) return previous;
+    return static_cast<quint8>(std::lround(steps));
+}
+
+GaugeIcon::State GaugeIcon::stateOf(const ThresholdSet& th, const SystemSnapshot& snap, Severity severity,
+                                    bool active) const {
+    State s;
+    const MemInfo& mem = snap.mem();
+    const double ram = mem.memTotalMiB > 0 ? 1 - mem.memAvailableMiB / mem.memTotalMiB : 0;
+    const double psiScale = th.hard_psi && *th.hard_psi > 0 ? *th.hard_psi : 100;
+    s.ram = quantize(ram, m_state.ram);
+    s.psi = quantize(SeverityEngine::psiValue(th, snap) / psiScale, m_state.psi);
+    s.severity = severity;
+    s.active = active;
+    return s;
+}
+
+bool GaugeIcon::update(const State& s, Theme theme) {
+    if (m_adopted && s == m_state && theme == m_theme) return false;
+    m_adopted = true;
+    m_state = s;
+    m_theme = theme;
+    return true;
+}
+
+QIcon GaugeIcon::icon() {
+    QIcon icon;
+    for (int size : kSizes) icon.addPixmap(pixmap(m_state, size, m_theme));
+    return icon;
+}
+
+quint64 GaugeIcon::keyOf(const State& s, int size, Theme theme) {
+    return quint64(s.ram) | quint64(s.psi) << 8 | quint64(s.severity) << 16 | quint64(s.active) << 20 |
+           quint64(theme) << 21 | quint64(size) << 32;
+}
+
+QPixmap GaugeIcon::pixmap(const State& s, int size, Theme theme) {
+    const quint64 key = keyOf(s, size, theme);
+    if (const QPixmap* cached = m_pixmaps.object(key)) return *cached;
+    ++m_painted;
+    const QPixmap pm = paint(s, size, theme);
+    m_pixmaps.insert(key, new QPixmap(pm), qsizetype(size) * size * 4);
+    return pm;
+}
+
+QPixmap GaugeIcon::paint(const State& s, int size, Theme theme) {
+    QPixmap pm(size, size);
+    pm.fill(Qt::transparent);
+    QPainter p(&pm);
+
+    // Whole pixels only: at 16 px anti-aliased edges read as blur
+    const int margin = std::max(1, size / 16);
+    const int gap = std::max(1, size / 8);
+    const int barWidth = (size - 2 * margin - gap) / 2;
+    const int height = size - 2 * margin;
+    const QColor outline = theme == Theme::Dark ? QColor(0xee, 0xee, 0xee) : QColor(0x23, 0x26, 0x29);
+    QColor track = outline;
+    track.setAlpha(60);
+    const QColor fill = fillColor(s);
+
+    const quint8 levels[] = {s.ram, s.psi};
+    for (int bar = 0; bar < 2; ++bar) {
+        const QRect r(margin + bar * (barWidth + gap), margin, barWidth, height);
+        p.fillRect(r, track);
+        // Inside the one-pixel border, from the bottom up
+        const int inner = height - 2;
+        const int filled = (inner * levels[bar] + kLevels - 1) / kLevels;
+        p.fillRect(r.left() + 1, r.bottom() - filled, barWidth - 2, filled, fill);
+        p.setPen(outline);
+        p.drawRect(r.adjusted(0, 0, -1, -1));
+    }
+    return pm;
+}
@@ -0,0 +1,63 @@
+// ===== src/GaugeIcon.h =====
+#pragma once
+#include "SeverityEngine.h"
+#include <QCache>
+#include <QIcon>
+#include <QPixmap>
+
+class SystemSnapshot;
+struct ThresholdSet;
+
+// GaugeIcon paints the tray icon as two bars, RAM in use on the left and
+// PSI on the right, filled in the severity's colour, so the pressure can be
+// read at a glance rather than in three steps. Both values are quantized to
+// kLevels steps and the icon is only republished when a step, the severity
+// or the theme changes. Pixmaps are cached by (state, size, theme) in an
+// LRU bounded to kCacheBytes, about 30 states at every size: a steady or
+// oscillating system paints nothing, while the 1296 reachable states
+// (levels, severities, themes) cannot pile up in locked memory.
+class GaugeIcon {
+public:
+    static constexpr int kLevels = 8;
+    static constexpr int kSizes[] = {16, 22, 24, 32, 48, 64};
+    static constexpr qsizetype kCacheBytes = 1024 * 1024; // ARGB32 pixels
+
+    enum class Theme : quint8 { Light, Dark }; // of the panel the icon sits on
+
+    struct State {
+        quint8 ram {0}; // 0..kLevels, share of RAM not available
+        quint8 psi {0}; // 0..kLevels, PSI as a share of hard_psi (or of 100 %)
+        Severity severity {Severity::Normal};
+        bool active {true};
+        bool operator==(const State&) const = default;
+    };
+
+    // Dark when the application palette's window colour is
+    static Theme currentTheme();
+
+    // Quantize a sample. A level sticks until the value is a quarter step
+    // past its edge, so noise around an edge does not flip the icon.
+    State stateOf(const ThresholdSet& th, const SystemSnapshot& snap, Severity severity, bool active) const;
+
+    // Adopt a state; true if the icon differs from the last one adopted
+    bool update(const State& s, Theme theme);
+    const State& state() const { return m_state; }
+
+    QIcon icon(); // the adopted state at every size in kSizes
+    QPixmap pixmap(const State& s, int size, Theme theme);
+    static QPixmap paint(const State& s, int size, Theme theme);
+
+    int cached() const { return static_cast<int>(m_pixmaps.size()); }
+    qsizetype cachedBytes() const { return m_pixmaps.totalCost(); }
+    int painted() const { return m_painted; }
+
+private:
+    static quint64 keyOf(const State& s, int size, Theme theme);
+    static quint8 quantize(double fraction, quint8 previous);
+
+    QCache<quint64, QPixmap> m_pixmaps {kCacheBytes}; // cost in bytes
+    int m_painted {0};
+    State m_state;
+    Theme m_theme {Theme::Light};
+    bool m_adopted {false};
+};
@@ -0,0 +1,363 @@
+// ===== src/HistoryWindow.cpp =====
+#include "pch.h"
+#include "HistoryWindow.h"
+#include "Lttb.h"
+#include "SystemSnapshot.h"
+#include "Thresholds.h"
+#include <QButtonGroup>
+#include <QHBoxLayout>
+#include <QImage>
+#include <QPainter>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <vector>
+
+static constexpr int kMargin = 8;
+static constexpr int kLegendHeight = 18;
+static constexpr int kAxisHeight = 16;
+static constexpr double kPsiScales[] = {10, 25, 50, 100};
+
+// Draws the two panels. Columns are absolute: column A covers the times t
+// with floor(t * columns / range) == A, so the same sample lands in the
+// same column on every tick and the cache can scroll by whole columns.
+class HistoryPlot final : public QWidget {
+public:
+    HistoryPlot(const SampleHistory* history, QWidget* parent) : QWidget(parent), m_history(history) {
+        setMinimumSize(320, 240);
+        m_panels[0].unit = "MiB";
+        m_panels[0].lines = {{SampleHistory::MemAvailableMiB, QColor(0x2e, 0x86, 0xde), "available"},
+                             {SampleHistory::SwapFreeMiB, QColor(0x27, 0xae, 0x60), "swap free"},
+                             {SampleHistory::ZramUsedMiB, QColor(0xe6, 0x7e, 0x22), "zram used"}};
+        m_panels[1].unit = "PSI %";
+        m_panels[1].yMax = kPsiScales[0];
+        m_panels[1].lines = {{SampleHistory::PsiSomeAvg10, QColor(0x8e, 0x44, 0xad), "some avg10"},
+                             {SampleHistory::PsiFullAvg10, QColor(0xc0, 0x39, 0x2b), "full avg10"}};
+    }
+
+    void setThresholds(const ThresholdSet& th, double memScaleMiB) {
+        auto levels = [](const ThresholdValue& w, const ThresholdValue& s, const ThresholdValue& h) {
+            return Levels {w.mib, s.mib, h.mib};
+        };
+        Panel& mib = m_panels[0];
+        mib.lines[0].limits = levels(th.warn_mem_free, th.soft_mem_free, th.hard_mem_free);
+        mib.lines[1].limits = levels(th.warn_swap_free, th.soft_swap_free, th.hard_swap_free);
+        mib.lines[2].limits = levels(th.warn_zram_used, th.soft_zram_used, th.hard_zram_used);
+        // nohang judges one PSI series, the one psi_metrics names
+        const bool some = th.psi_metrics == QStringLiteral("some") || th.psi_metrics.startsWith(QStringLiteral("some_"));
+        m_panels[1].lines[0].limits = some ? Levels {th.warn_psi, th.soft_psi, th.hard_psi} : Levels {};
+        m_panels[1].lines[1].limits = some ? Levels {} : Levels {th.warn_psi, th.soft_psi, th.hard_psi};
+        const double scale = std::max(1.0, memScaleMiB);
+        if (scale != mib.yMax) {
+            mib.yMax = scale;
+            m_drawn = false;
+        }
+    }
+
+    qint64 rangeMs() const { return m_rangeMs; }
+    void setRangeMs(qint64 ms) {
+        if (ms == m_rangeMs) return;
+        m_rangeMs = ms;
+        m_drawn = false;
+        sync();
+    }
+
+    // Bring the cache up to the newest sample
+    void sync() {
+        if (!m_history || m_history->size() == 0 || m_cols <= 0) return;
+        if (m_drawn && m_history->appended() == m_seen) return;
+        m_seen = m_history->appended();
+        const qint64 last = colOf(m_history->timeMs(m_history->size() - 1));
+        const qint64 shift = last - m_lastCol;
+        if (!m_drawn || shift < 0 || shift >= m_cols) {
+            redrawAll(last);
+        } else {
+            m_lastCol = last;
+            for (Panel& p : m_panels) {
+                scrollLeft(p.cache, static_cast<int>(shift));
+                for (Line& l : p.lines) {
+                    std::move(l.kept.begin() + shift, l.kept.end(), l.kept.begin());
+                    std::fill(l.kept.end() - shift, l.kept.end(), kNone);
+                }
+            }
+            // The former last column has grown and was judged without a
+            // next bucket; the one before it was judged against the former
+            // last column's average. Both may pick differently now.
+            const std::vector<Lttb::Point>& kept = m_panels[0].lines[0].kept;
+            int from = 0;
+            int seen = 0;
+            for (int c = m_cols - 1 - static_cast<int>(shift); c >= 0; --c) {
+                if (!isNone(kept[c]) && ++seen == 2) {
+                    from = c;
+                    break;
+                }
+            }
+            if (redrawFrom(from)) redrawAll(last);
+            else ++m_partialRedraws;
+        }
+        update();
+    }
+
+    int columns() const { return m_cols; }
+    int keptPoints(SampleHistory::Series s) const {
+        for (const Panel& p : m_panels)
+            for (const Line& l : p.lines)
+                if (l.series == s)
+                    return static_cast<int>(std::count_if(l.kept.begin(), l.kept.end(),
+                                                          [](const Lttb::Point& pt) { return !isNone(pt); }));
+        return 0;
+    }
+    int fullRedraws() const { return m_fullRedraws; }
+    int partialRedraws() const { return m_partialRedraws; }
+
+protected:
+    void resizeEvent(QResizeEvent*) override {
+        const qreal dpr = devicePixelRatioF();
+        const int w = width() - 2 * kMargin;
+        const int h = height() - 2 * kLegendHeight - kAxisHeight - 3 * kMargin;
+        const int top = kMargin + kLegendHeight;
+        const int h0 = h * 3 / 5;
+        m_panels[0].rect = QRect(kMargin, top, w, h0);
+        m_panels[1].rect = QRect(kMargin, top + h0 + kMargin + kLegendHeight, w, h - h0);
+        m_cols = std::max(0, qRound(w * dpr));
+        for (Panel& p : m_panels) {
+            p.cache = QImage(m_cols, std::max(1, qRound(p.rect.height() * dpr)), QImage::Format_ARGB32_Premultiplied);
+            p.cache.setDevicePixelRatio(dpr);
+            for (Line& l : p.lines) l.kept.assign(static_cast<size_t>(m_cols), kNone);
+        }
+        m_drawn = false;
+        sync();
+    }
+
+    void paintEvent(QPaintEvent*) override {
+        QPainter p(this);
+        p.fillRect(rect(), palette().base());
+        const QFontMetrics fm = p.fontMetrics();
+        static const char* const kLevelNames[] = {"warn", "soft", "hard"};
+        static constexpr Qt::PenStyle kLevelStyles[] = {Qt::DotLine, Qt::DashLine, Qt::SolidLine};
+        for (const Panel& panel : m_panels) {
+            const QRect& r = panel.rect;
+            p.setPen(palette().mid().color());
+            p.drawRect(r.adjusted(0, 0, -1, -1));
+            if (m_drawn) p.drawImage(r.topLeft(), panel.cache);
+
+            // Legend above the panel, scale at its corners
+            int x = r.left();
+            const int legendY = r.top() - kLegendHeight / 2 + fm.ascent() / 2;
+            p.setPen(palette().text().color());
+            p.drawText(x, legendY, QString::fromLatin1(panel.unit));
+            x += fm.horizontalAdvance(QString::fromLatin1(panel.unit)) + kMargin;
+            for (const Line& l : panel.lines) {
+                p.fillRect(x, legendY - fm.ascent() + 2, 10, 10, l.color);
+                x += 14;
+                p.drawText(x, legendY, QString::fromLatin1(l.label));
+                x += fm.horizontalAdvance(QString::fromLatin1(l.label)) + kMargin;
+            }
+            p.setPen(palette().placeholderText().color());
+            const QString top = QString::number(panel.yMax, 'f', 0);
+            p.drawText(r.right() - fm.horizontalAdvance(top) - 2, r.top() + fm.ascent(), top);
+
+            // Threshold overlays, cheap enough to draw every time
+            for (const Line& l : panel.lines) {
+                for (int k = 0; k < 3; ++k) {
+                    if (!l.limits[k] || *l.limits[k] > panel.yMax) continue;
+                    const double y = yOf(panel, *l.limits[k]);
+                    p.setPen(QPen(l.color, 1, kLevelStyles[k]));
+                    p.drawLine(QPointF(r.left(), r.top() + y), QPointF(r.right(), r.top() + y));
+                    p.drawText(QPointF(r.left() + 2, r.top() + y - 2), QString::fromLatin1(kLevelNames[k]));
+                }
+            }
+        }
+        const QRect& bottom = m_panels[1].rect;
+        const int axisY = bottom.bottom() + kAxisHeight;
+        p.setPen(palette().text().color());
+        p.drawText(bottom.left(), axisY, rangeLabel());
+        const QString now = QStringLiteral("now");
+        p.drawText(bottom.right() - fm.horizontalAdvance(now), axisY, now);
+    }
+
+private:
+    using Levels = std::array<std::optional<double>, 3>; // warn, soft, hard
+    struct Line {
+        SampleHistory::Series series;
+        QColor color;
+        const char* label;
+        Levels limits {};
+        std::vector<Lttb::Point> kept {}; // per column, the sample LTTB kept (time, value)
+    };
+    struct Panel {
+        const char* unit {""};
+        double yMax {1};
+        QRect rect;
+        QImage cache;
+        std::vector<Line> lines;
+    };
+
+    static constexpr Lttb::Point kNone {std::numeric_limits<double>::quiet_NaN(), 0};
+    static bool isNone(const Lttb::Point& p) { return std::isnan(p.x); }
+
+    static qint64 floorDiv(qint64 a, qint64 b) { return a / b - (a % b != 0 && (a < 0) != (b < 0)); }
+    qint64 colOf(qint64 t) const { return floorDiv(t * m_cols, m_rangeMs); }
+    qint64 colStart(qint64 col) const { return -floorDiv(-col * m_rangeMs, m_cols); } // first ms in col
+    qint64 firstCol() const { return m_lastCol - m_cols + 1; }
+
+    double xOf(double t) const {
+        return (t * m_cols / double(m_rangeMs) - double(firstCol())) / devicePixelRatioF();
+    }
+    static double yOf(const Panel& p, double v) {
+        const double h = p.rect.height() - 1;
+        return h - std::clamp(v / p.yMax, 0.0, 1.0) * h;
+    }
+
+    QString rangeLabel() const {
+        const qint64 s = m_rangeMs / 1000;
+        return s >= 3600 ? QStringLiteral("-%1 h").arg(s / 3600) : QStringLiteral("-%1 min").arg(s / 60);
+    }
+
+    static void scrollLeft(QImage& img, int px) {
+        const int w = img.width();
+        px = std::min(px, w);
+        for (int y = 0; y < img.height(); ++y) {
+            uchar* line = img.scanLine(y);
+            std::memmove(line, line + px * 4, static_cast<size_t>(w - px) * 4);
+            std::memset(line + (w - px) * 4, 0, static_cast<size_t>(px) * 4); // transparent
+        }
+    }
+
+    void redrawAll(qint64 last) {
+        m_lastCol = last;
+        m_drawn = true;
+        m_panels[1].yMax = kPsiScales[0]; // a full redraw fits the scale to what is shown
+        while (redrawFrom(0)) {
+        }
+        ++m_fullRedraws;
+    }
+
+    // Pick and draw columns [from, m_cols). Returns true if a value outgrew
+    // the PSI scale, which was raised and needs a full redraw.
+    bool redrawFrom(int from) {
+        const SampleHistory& h = *m_history;
+        const qint64 first = firstCol();
+        // Sample ranges per column; bounds[k] is the first sample of column from + k
+        std::vector<int> bounds(static_cast<size_t>(m_cols - from + 1));
+        int i = h.lowerBound(colStart(first + from));
+        for (int k = 0; k < m_cols - from; ++k) {
+            bounds[k] = i;
+            const qint64 end = colStart(first + from + k + 1);
+            while (i < h.size() && h.timeMs(i) < end) ++i;
+        }
+        bounds.back() = i;
+
+        bool rescale = false;
+        std::vector<int> picked;
+        const qreal dpr = devicePixelRatioF();
+        for (Panel& panel : m_panels) {
+            QPainter p(&panel.cache);
+            // Clear one column more than is picked again: the line into the
+            // first picked column starts there
+            const int clearCol = std::max(0, from - 1);
+            const double clearX = clearCol / dpr;
+            const QRectF strip(clearX, 0, panel.cache.width() / dpr - clearX, panel.cache.height() / dpr);
+            p.setCompositionMode(QPainter::CompositionMode_Source);
+            p.fillRect(strip, Qt::transparent);
+            p.setCompositionMode(QPainter::CompositionMode_SourceOver);
+            p.setClipRect(strip);
+            p.setRenderHint(QPainter::Antialiasing);
+
+            for (Line& l : panel.lines) {
+                // The last kept point before from anchors the picks; the
+                // line starts one kept point earlier so the cleared column
+                // gets its segment back
+                std::optional<Lttb::Point> anchor;
+                int startCol = from;
+                for (int c = from - 1, found = 0; c >= 0 && found < 2; --c) {
+                    if (isNone(l.kept[c])) continue;
+                    if (found++ == 0) anchor = l.kept[c];
+                    startCol = c;
+                }
+                std::fill(l.kept.begin() + from, l.kept.end(), kNone);
+                picked.clear();
+                Lttb::selectInBuckets(
+                    bounds, anchor, [&](int j) { return double(h.timeMs(j)); },
+                    [&](int j) { return double(h.value(l.series, j)); }, &picked);
+                for (int j : picked) {
+                    const qint64 c = colOf(h.timeMs(j)) - first;
+                    if (c < from || c >= m_cols) continue;
+                    l.kept[c] = {double(h.timeMs(j)), double(h.value(l.series, j))};
+                    if (l.kept[c].y > panel.yMax && &panel == &m_panels[1]) rescale = true;
+                }
+
+                QPolygonF line;
+                line.reserve(m_cols - from + 1);
+                for (int c = startCol; c < m_cols; ++c)
+                    if (!isNone(l.kept[c])) line << QPointF(xOf(l.kept[c].x), yOf(panel, l.kept[c].y));
+                p.setPen(QPen(l.color, 1.5));
+                if (line.size() == 1) p.drawPoint(line.front());
+                else p.drawPolyline(line);
+            }
+        }
+        if (!rescale) return false;
+        double top = 0;
+        for (const Line& l : m_panels[1].lines)
+            for (const Lttb::Point& pt : l.kept)
+                if (!isNone(pt)) top = std::max(top, pt.y);
+        const double* scale = std::find_if(std::begin(kPsiScales), std::end(kPsiScales),
+                                           [top](double s) { return s >= top; });
+        const double yMax = scale == std::end(kPsiScales) ? kPsiScales[3] : *scale; // clamped above 100
+        if (yMax == m_panels[1].yMax) return false;
+        m_panels[1].yMax = yMax;
+        return true;
+    }
+
+    const SampleHistory* m_history;
+    std::array<Panel, 2> m_panels;
+    qint64 m_rangeMs {HistoryWindow::kRangesSeconds[0] * 1000LL};
+    int m_cols {0};
+    qint64 m_lastCol {0};
+    quint64 m_seen {0};
+    bool m_drawn {false};
+    int m_fullRedraws {0};
+    int m_partialRedraws {0};
+};
+
+HistoryWindow::HistoryWindow(const SampleHistory* history, QWidget* parent) : QWidget(parent) {
+    setAttribute(Qt::WA_DeleteOnClose);
+    setWindowTitle(tr("nohang history"));
+
+    m_plot = new HistoryPlot(history, this);
+    auto* ranges = new QHBoxLayout;
+    auto* group = new QButtonGroup(this);
+    for (int seconds : kRangesSeconds) {
+        auto* b = new QPushButton(seconds >= 3600 ? tr("%1 h").arg(seconds / 3600) : tr("%1 min").arg(seconds / 60), this);
+        b->setCheckable(true);
+        b->setChecked(seconds == kRangesSeconds[0]);
+        group->addButton(b, seconds);
+        ranges->addWidget(b);
+    }
+    ranges->addStretch();
+    connect(group, &QButtonGroup::idClicked, this, &HistoryWindow::setRangeSeconds);
+
+    auto* lay = new QVBoxLayout(this);
+    lay->addLayout(ranges);
+    lay->addWidget(m_plot, 1);
+    resize(900, 520);
+}
+
+HistoryWindow::~HistoryWindow() = default;
+
+void HistoryWindow::refresh(const ThresholdSet& th, const SystemSnapshot& snap) {
+    m_plot->setThresholds(th, std::max({snap.mem().memTotalMiB, snap.mem().swapTotalMiB, snap.zram().diskSizeMiB}));
+    m_plot->sync();
+}
+
+void HistoryWindow::setRangeSeconds(int seconds) { m_plot->setRangeMs(qint64(seconds) * 1000); }
+int HistoryWindow::rangeSeconds() const { return static_cast<int>(m_plot->rangeMs() / 1000); }
+int HistoryWindow::columns() const { return m_plot->columns(); }
+int HistoryWindow::keptPoints(SampleHistory::Series series) const { return m_plot->keptPoints(series); }
+int HistoryWindow::fullRedraws() const { return m_plot->fullRedraws(); }
+int HistoryWindow::partialRedraws() const { return m_plot->partialRedraws(); }
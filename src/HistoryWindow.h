@@ -0,0 +1,43 @@
+// ===== src/HistoryWindow.h =====
+#pragma once
+#include "SampleHistory.h"
+#include <QWidget>
+
+class HistoryPlot;
+class SystemSnapshot;
+struct ThresholdSet;
+
+// HistoryWindow charts the tray's SampleHistory: RAM available, swap free
+// and zram used in MiB above, PSI below, over the last 5 min, 1 h or 24 h,
+// with nohang's warn, soft and hard thresholds drawn across them.
+//
+// Each series is reduced with LTTB to one point per device pixel column,
+// the columns fixed to the clock, so 24 h draws about as fast as 5 min. The
+// lines live in a cached image that scrolls with time; a tick redraws only
+// the new columns and the two before them, whose picks can still change.
+// TrayApp creates the window when it is opened and it deletes itself on
+// close, so a closed window costs nothing.
+class HistoryWindow : public QWidget {
+    Q_OBJECT
+public:
+    static constexpr int kRangesSeconds[] = {5 * 60, 3600, 24 * 3600};
+
+    explicit HistoryWindow(const SampleHistory* history, QWidget* parent = nullptr);
+    ~HistoryWindow() override;
+
+    // Call after each appended sample: the thresholds for the overlays and
+    // the totals for the MiB scale
+    void refresh(const ThresholdSet& th, const SystemSnapshot& snap);
+
+    void setRangeSeconds(int seconds);
+    int rangeSeconds() const;
+
+    // For tests and the benchmark
+    int columns() const;
+    int keptPoints(SampleHistory::Series series) const; // points on that line
+    int fullRedraws() const;
+    int partialRedraws() const;
+
+private:
+    HistoryPlot* m_plot {nullptr};
+};
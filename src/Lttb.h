@@ -0,0 +1,87 @@
+// ===== src/Lttb.h =====
+#pragma once
+#include <cmath>
+#include <optional>
+#include <vector>
+
+// Largest-Triangle-Three-Buckets downsampling (Steinarsson, 2013). One point
+// is kept per bucket: the one spanning the largest triangle with the point
+// kept in the previous bucket and the average of the next bucket, so peaks
+// and dips survive where averaging would flatten them. Points are given by
+// index through x(i) and y(i), so callers need not copy their arrays.
+namespace Lttb {
+
+struct Point {
+    double x;
+    double y;
+};
+
+// Buckets are consecutive index ranges, bucket k being [bounds[k],
+// bounds[k + 1]); empty ones are skipped. prev is the point kept before the
+// first bucket; without one the first bucket keeps its first point. The
+// last bucket, having no next, is judged against its own last point.
+// Appends the kept index of every non-empty bucket to out.
+template <typename X, typename Y>
+void selectInBuckets(const std::vector<int>& bounds, std::optional<Point> prev, X x, Y y, std::vector<int>* out) {
+    const int buckets = static_cast<int>(bounds.size()) - 1;
+    int next = 0; // next non-empty bucket after k, found lazily
+    for (int k = 0; k < buckets; ++k) {
+        const int begin = bounds[k];
+        const int end = bounds[k + 1];
+        if (begin >= end) continue;
+        if (!prev) {
+            out->push_back(begin);
+            prev = Point {double(x(begin)), double(y(begin))};
+            continue;
+        }
+        if (next <= k) {
+            next = k + 1;
+            while (next < buckets && bounds[next] >= bounds[next + 1]) ++next;
+        }
+        Point avg {double(x(end - 1)), double(y(end - 1))};
+        if (next < buckets) {
+            avg = {0, 0};
+            for (int i = bounds[next]; i < bounds[next + 1]; ++i) {
+                avg.x += x(i);
+                avg.y += y(i);
+            }
+            const int count = bounds[next + 1] - bounds[next];
+            avg.x /= count;
+            avg.y /= count;
+        }
+        int best = begin;
+        double bestArea = -1;
+        for (int i = begin; i < end; ++i) {
+            // Twice the triangle's area; the factor does not change the pick
+            const double area = std::abs((prev->x - avg.x) * (double(y(i)) - prev->y) -
+                                         (prev->x - double(x(i))) * (avg.y - prev->y));
+            if (area > bestArea) {
+                bestArea = area;
+                best = i;
+            }
+        }
+        out->push_back(best);
+        prev = Point {double(x(best)), double(y(best))};
+    }
+}
+
+// The classic form: n points down to at most threshold (at least 3), first
+// and last kept, the rest in threshold - 2 buckets of equal count
+template <typename X, typename Y>
+std::vector<int> select(int n, int threshold, X x, Y y) {
+    std::vector<int> out;
+    if (n <= threshold || threshold < 3) {
+        for (int i = 0; i < n; ++i) out.push_back(i);
+        return out;
+    }
+    const int inner = threshold - 2;
+    std::vector<int> bounds {0};
+    for (int k = 0; k <= inner; ++k)
+        bounds.push_back(1 + static_cast<int>(static_cast<long long>(n - 2) * k / inner));
+    bounds.push_back(n);
+    out.reserve(threshold);
+    selectInBuckets(bounds, std::nullopt, x, y, &out);
+    return out;
+}
+
+} // namespace Lttb
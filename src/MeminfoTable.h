@@ -0,0 +1,111 @@
+// ===== src/MeminfoTable.h =====
+#pragma once
+#include "ProcParse.h"
+#include <QtGlobal>
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <string_view>
+
+// Fields of /proc/meminfo (and of the per-node meminfo files) the tray knows
+// about. Values are kept in kB, as the kernel prints them.
+enum class MeminfoField : int {
+    MemTotal = 0, MemFree, MemAvailable, Buffers, Cached, SwapCached,
+    Active, Inactive, ActiveAnon, InactiveAnon, ActiveFile, InactiveFile,
+    Unevictable, Mlocked, SwapTotal, SwapFree, Zswap, Zswapped,
+    Dirty, Writeback, AnonPages, Mapped, Shmem, FilePages,
+    KReclaimable, Slab, SReclaimable, SUnreclaim, PageTables,
+    CommitLimit, CommittedAS, AnonHugePages, ShmemHugePages, FileHugePages,
+    Count
+};
+
+// A set of fields, one bit per MeminfoField
+using MeminfoMask = quint64;
+static_assert(static_cast<int>(MeminfoField::Count) <= 64);
+
+constexpr MeminfoMask meminfoBit(MeminfoField f) { return MeminfoMask {1} << static_cast<int>(f); }
+constexpr MeminfoMask meminfoBits(std::initializer_list<MeminfoField> fields) {
+    MeminfoMask m = 0;
+    for (MeminfoField f : fields) m |= meminfoBit(f);
+    return m;
+}
+
+// Table-driven meminfo parsing. One pass over the text: each key is looked
+// up by binary search in a sorted constexpr table, and only requested
+// fields have their number parsed. Nothing is allocated.
+namespace MeminfoTable {
+
+struct Entry {
+    std::string_view key;
+    MeminfoField field;
+};
+
+// Sorted by key, as bytes
+inline constexpr Entry kEntries[] = {
+    {"Active", MeminfoField::Active},
+    {"Active(anon)", MeminfoField::ActiveAnon},
+    {"Active(file)", MeminfoField::ActiveFile},
+    {"AnonHugePages", MeminfoField::AnonHugePages},
+    {"AnonPages", MeminfoField::AnonPages},
+    {"Buffers", MeminfoField::Buffers},
+    {"Cached", MeminfoField::Cached},
+    {"CommitLimit", MeminfoField::CommitLimit},
+    {"Committed_AS", MeminfoField::CommittedAS},
+    {"Dirty", MeminfoField::Dirty},
+    {"FileHugePages", MeminfoField::FileHugePages},
+    {"FilePages", MeminfoField::FilePages},
+    {"Inactive", MeminfoField::Inactive},
+    {"Inactive(anon)", MeminfoField::InactiveAnon},
+    {"Inactive(file)", MeminfoField::InactiveFile},
+    {"KReclaimable", MeminfoField::KReclaimable},
+    {"Mapped", MeminfoField::Mapped},
+    {"MemAvailable", MeminfoField::MemAvailable},
+    {"MemFree", MeminfoField::MemFree},
+    {"MemTotal", MeminfoField::MemTotal},
+    {"Mlocked", MeminfoField::Mlocked},
+    {"PageTables", MeminfoField::PageTables},
+    {"SReclaimable", MeminfoField::SReclaimable},
+    {"SUnreclaim", MeminfoField::SUnreclaim},
+    {"Shmem", MeminfoField::Shmem},
+    {"ShmemHugePages", MeminfoField::ShmemHugePages},
+    {"Slab", MeminfoField::Slab},
+    {"SwapCached", MeminfoField::SwapCached},
+    {"SwapFree", MeminfoField::SwapFree},
+    {"SwapTotal", MeminfoField::SwapTotal},
+    {"Unevictable", MeminfoField::Unevictable},
+    {"Writeback", MeminfoField::Writeback},
+    {"Zswap", MeminfoField::Zswap},
+    {"Zswapped", MeminfoField::Zswapped},
+};
+
+constexpr bool byKey(const Entry& a, const Entry& b) { return a.key < b.key; }
+static_assert(std::is_sorted(std::begin(kEntries), std::end(kEntries), byKey));
+static_assert(std::size(kEntries) == static_cast<size_t>(MeminfoField::Count), "one entry per field");
+
+inline const Entry* find(QByteArrayView key) {
+    const std::string_view k(key.data(), static_cast<size_t>(key.size()));
+    const Entry* it = std::lower_bound(std::begin(kEntries), std::end(kEntries), Entry {k, MeminfoField::Count}, byKey);
+    return it != std::end(kEntries) && it->key == k ? it : nullptr;
+}
+
+// Parse "Key:   123 kB" lines into outKiB[field] for the fields in wanted
+// and return the ones found. skipFields drops leading columns first, e.g.
+// 2 for the "Node 0 MemFree: ..." lines of a node's meminfo.
+inline MeminfoMask parse(QByteArrayView text, MeminfoMask wanted, double* outKiB, int skipFields = 0) {
+    MeminfoMask found = 0;
+    ProcParse::forEachLine(text, [&](QByteArrayView line) {
+        qsizetype pos = 0;
+        for (int i = 0; i < skipFields; ++i) ProcParse::nextField(line, &pos);
+        const QByteArrayView rest = ProcParse::trimmed(line.sliced(pos));
+        const qsizetype colon = rest.indexOf(':');
+        if (colon <= 0) return;
+        const Entry* e = find(rest.first(colon));
+        if (!e || !(wanted & meminfoBit(e->field))) return;
+        qsizetype at = colon + 1;
+        outKiB[static_cast<int>(e->field)] = ProcParse::toDouble(ProcParse::nextField(rest, &at));
+        found |= meminfoBit(e->field);
+    });
+    return found;
+}
+
+} // namespace MeminfoTable
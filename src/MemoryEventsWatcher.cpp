@@ -0,0 +1,134 @@
+// ===== src/MemoryEventsWatcher.cpp =====
+#include "pch.h"
+#include "MemoryEventsWatcher.h"
+#include "ProcParse.h"
+#include <QDir>
+#include <QFile>
+#include <QSocketNotifier>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+QString MemoryEventRecord::summary() const {
+    QStringList parts;
+    auto add = [&](const char* name, qint64 v) {
+        if (v) parts << QStringLiteral("%1 +%2").arg(QLatin1String(name)).arg(v);
+    };
+    // Worst first
+    add("oom_kill", delta.oomKill);
+    add("oom_group_kill", delta.oomGroupKill);
+    add("oom", delta.oom);
+    add("max", delta.max);
+    add("high", delta.high);
+    add("low", delta.low);
+    return parts.join(QStringLiteral(", "));
+}
+
+MemoryEventCounts MemoryEventsWatcher::parse(QByteArrayView text) {
+    MemoryEventCounts c;
+    ProcParse::forEachLine(text, [&](QByteArrayView line) {
+        qsizetype pos = 0;
+        const QByteArrayView key = ProcParse::nextField(line, &pos);
+        const qint64 v = ProcParse::toInt64(ProcParse::nextField(line, &pos));
+        if (key == "low") c.low = v;
+        else if (key == "high") c.high = v;
+        else if (key == "max") c.max = v;
+        else if (key == "oom") c.oom = v;
+        else if (key == "oom_kill") c.oomKill = v;
+        else if (key == "oom_group_kill") c.oomGroupKill = v;
+    });
+    return c;
+}
+
+MemoryEventsWatcher::MemoryEventsWatcher(const QString& cgroupRoot, const QStringList& cgroups, QObject* parent)
+    : QObject(parent), m_root(cgroupRoot) {
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify < 0) {
+        qWarning().noquote() << "MemoryEventsWatcher: inotify unavailable:" << qt_error_string(errno);
+        return;
+    }
+    for (QString rel : cgroups) {
+        while (rel.startsWith(QLatin1Char('/'))) rel.remove(0, 1);
+        if (!rel.isEmpty() || QFile::exists(m_root + QStringLiteral("/memory.events"))) {
+            addWatch(rel);
+            continue;
+        }
+        // Host root: watch the top-level slices
+        const QStringList children = QDir(m_root).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+        for (const QString& c : children) addWatch(c);
+    }
+    m_notifier = new QSocketNotifier(m_inotify, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &MemoryEventsWatcher::poll);
+}
+
+MemoryEventsWatcher::~MemoryEventsWatcher() {
+    for (const Watch& w : std::as_const(m_watches))
+        if (w.fd >= 0) ::close(w.fd);
+    if (m_inotify >= 0) ::close(m_inotify);
+}
+
+QStringList MemoryEventsWatcher::watched() const {
+    QStringList out;
+    for (const Watch& w : m_watches) out << w.cgroup;
+    return out;
+}
+
+void MemoryEventsWatcher::addWatch(const QString& rel) {
+    const QString dir = rel.isEmpty() ? m_root : m_root + QLatin1Char('/') + rel;
+    const QByteArray path = QFile::encodeName(dir + QStringLiteral("/memory.events"));
+    Watch w;
+    w.cgroup = rel.isEmpty() ? QStringLiteral("/") : rel;
+    w.fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+    if (w.fd < 0) return;
+    w.wd = inotify_add_watch(m_inotify, path.constData(), IN_MODIFY);
+    if (w.wd < 0) {
+        ::close(w.fd);
+        return;
+    }
+    readWatch(w, false); // baseline, counts from before we started are history
+    m_watches.push_back(w);
+}
+
+void MemoryEventsWatcher::readWatch(Watch& w, bool report) {
+    char buf[512];
+    const ssize_t n = ::pread(w.fd, buf, sizeof(buf), 0);
+    if (n <= 0) return;
+    const MemoryEventCounts now = parse(QByteArrayView(buf, n));
+    MemoryEventRecord r;
+    r.cgroup = w.cgroup;
+    r.total = now;
+    // Counters only grow; a smaller value means the cgroup was recreated
+    auto diff = [](qint64 a, qint64 b) { return a >= b ? a - b : a; };
+    r.delta.low = diff(now.low, w.last.low);
+    r.delta.high = diff(now.high, w.last.high);
+    r.delta.max = diff(now.max, w.last.max);
+    r.delta.oom = diff(now.oom, w.last.oom);
+    r.delta.oomKill = diff(now.oomKill, w.last.oomKill);
+    r.delta.oomGroupKill = diff(now.oomGroupKill, w.last.oomGroupKill);
+    w.last = now;
+    if (!report || r.delta.isZero()) return;
+
+    r.at = QDateTime::currentDateTime();
+    m_recent.prepend(r);
+    if (m_recent.size() > kRecent) m_recent.resize(kRecent);
+    emit eventsChanged(r);
+}
+
+void MemoryEventsWatcher::poll() {
+    if (m_inotify < 0) return;
+    // Collect the changed watches first, a burst of writes to one file
+    // arrives as several events but needs one read
+    QVector<int> changed;
+    alignas(inotify_event) char buf[4096];
+    for (;;) {
+        const ssize_t n = ::read(m_inotify, buf, sizeof(buf));
+        if (n <= 0) break;
+        for (ssize_t off = 0; off < n;) {
+            const auto* ev = reinterpret_cast<const inotify_event*>(buf + off);
+            if ((ev->mask & IN_MODIFY) && !changed.contains(ev->wd)) changed.push_back(ev->wd);
+            off += static_cast<ssize_t>(sizeof(inotify_event)) + ev->len;
+        }
+    }
+    for (Watch& w : m_watches)
+        if (changed.contains(w.wd)) readWatch(w, true);
+}
@@ -0,0 +1,80 @@
+// ===== src/MemoryEventsWatcher.h =====
+#pragma once
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QSocketNotifier;
+
+// Counters from a cgroup's memory.events
+struct MemoryEventCounts {
+    qint64 low {0};
+    qint64 high {0};
+    qint64 max {0};
+    qint64 oom {0};
+    qint64 oomKill {0};
+    qint64 oomGroupKill {0};
+
+    bool isZero() const { return !low && !high && !max && !oom && !oomKill && !oomGroupKill; }
+};
+
+// One change seen on a memory.events file
+struct MemoryEventRecord {
+    QString cgroup;              // relative to the cgroup root
+    MemoryEventCounts delta;     // increments since the previous read
+    MemoryEventCounts total;
+    QDateTime at;                // wall clock, for the menu
+
+    QString summary() const;     // e.g. "oom_kill +1, max +3"
+};
+
+// MemoryEventsWatcher learns about reclaim pressure and OOM kills the moment
+// the kernel counts them. Each watched memory.events file gets an inotify
+// IN_MODIFY watch (the kernel signals every counter change that way), and
+// a QSocketNotifier on the inotify fd wakes the event loop only then, so
+// the watcher costs nothing while nothing happens. On wakeup the changed
+// files are re-read through fds kept open, diffed against the last values,
+// and every non-zero difference is reported.
+//
+// "/" stands for the root cgroup. The host's root has no memory.events, so
+// its top-level slices are watched instead; events count hierarchically, so
+// that covers the whole tree.
+class MemoryEventsWatcher : public QObject {
+    Q_OBJECT
+public:
+    explicit MemoryEventsWatcher(const QString& cgroupRoot = QStringLiteral("/sys/fs/cgroup"),
+                                 const QStringList& cgroups = {QStringLiteral("/")},
+                                 QObject* parent = nullptr);
+    ~MemoryEventsWatcher() override;
+
+    QStringList watched() const;                        // relative cgroup paths
+    const QVector<MemoryEventRecord>& recent() const { return m_recent; } // newest first
+
+    static constexpr int kRecent = 10;
+    static MemoryEventCounts parse(QByteArrayView text);
+
+public slots:
+    void poll();                                        // read pending inotify events now
+
+signals:
+    void eventsChanged(const MemoryEventRecord& record);
+
+private:
+    struct Watch {
+        QString cgroup;
+        int wd {-1};
+        int fd {-1};
+        MemoryEventCounts last;
+    };
+
+    void addWatch(const QString& rel);
+    void readWatch(Watch& w, bool report);
+
+    QString m_root;
+    int m_inotify {-1};
+    QSocketNotifier* m_notifier {nullptr};
+    QVector<Watch> m_watches;
+    QVector<MemoryEventRecord> m_recent;
+};
@@ -0,0 +1,67 @@
+// ===== src/MemoryLock.cpp =====
+#include "pch.h"
+#include "MemoryLock.h"
+#include <QFile>
+#include <QTextStream>
+#include <alloca.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+#include <sys/mman.h>
+
+static void prefaultStack(std::size_t bytes) {
+    // Touch the stack once so the pages exist before MCL_CURRENT pins them
+    auto* p = static_cast<volatile char*>(alloca(bytes));
+    for (std::size_t i = 0; i < bytes; i += 4096) p[i] = 0;
+}
+
+static void reserveHeap(std::size_t bytes) {
+    // A pre-faulted reservation on the main heap, not a single arena:
+    // threads that already allocated (the sampler, Qt's own) keep their
+    // arenas, M_ARENA_MAX only caps the ones created later. Without mmap'd
+    // chunks and trimming, freed memory stays in the heap for reuse instead
+    // of being unmapped and faulted in again, but large buffers (history
+    // columns, pixmaps, ProcReader buffers) now come from brk too and can
+    // grow it past this reservation; MCL_FUTURE locks that growth as well.
+    mallopt(M_ARENA_MAX, 1);
+    mallopt(M_MMAP_MAX, 0);
+    mallopt(M_TRIM_THRESHOLD, static_cast<int>(bytes * 2));
+    mallopt(M_TOP_PAD, static_cast<int>(bytes));
+    if (void* p = std::malloc(bytes)) {
+        std::memset(p, 0, bytes);
+        std::free(p);
+    }
+}
+
+bool MemoryLock::lockAll(const Options& opts, QString* error) {
+    reserveHeap(opts.heapArenaBytes);
+    prefaultStack(opts.stackPrefaultBytes);
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        if (error) *error = QString::fromLocal8Bit(std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void MemoryLock::unlockAll() {
+    munlockall();
+}
+
+MemoryLockReport MemoryLock::report(const QString& procRoot) {
+    MemoryLockReport r;
+    QFile f(procRoot + QStringLiteral("/self/status"));
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return r;
+    QTextStream ts(&f);
+    QString line;
+    while (ts.readLineInto(&line)) {
+        // "VmLck:      1234 kB"
+        double* slot = nullptr;
+        if (line.startsWith(QLatin1String("VmLck:"))) slot = &r.lockedMiB;
+        else if (line.startsWith(QLatin1String("VmRSS:"))) slot = &r.residentMiB;
+        if (!slot) continue;
+        const QStringList parts = line.mid(6).simplified().split(QLatin1Char(' '));
+        if (!parts.isEmpty()) *slot = parts[0].toDouble() / 1024.0;
+    }
+    return r;
+}
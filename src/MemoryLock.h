@@ -0,0 +1,28 @@
+// ===== src/MemoryLock.h =====
+#pragma once
+#include <QString>
+#include <cstddef>
+
+// Locked and resident size of the tray process, from /proc/self/status
+struct MemoryLockReport {
+    double lockedMiB {0};   // VmLck
+    double residentMiB {0}; // VmRSS
+};
+
+// MemoryLock keeps the tray out of reclaim while the system is thrashing.
+// It pre-faults a heap reservation, pins every current and future mapping
+// with mlockall and reports how much memory that costs.
+class MemoryLock {
+public:
+    struct Options {
+        std::size_t heapArenaBytes {16u * 1024u * 1024u}; // pre-faulted, not a cap
+        std::size_t stackPrefaultBytes {256u * 1024u};    // touched once on the calling thread
+    };
+
+    // Returns false, with a reason in *error, if the kernel refuses the lock,
+    // usually because RLIMIT_MEMLOCK is too small and CAP_IPC_LOCK is missing.
+    static bool lockAll(const Options& opts, QString* error = nullptr);
+    static void unlockAll();
+
+    static MemoryLockReport report(const QString& procRoot = QStringLiteral("/proc"));
+};
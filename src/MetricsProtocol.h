@@ -0,0 +1,64 @@
+// ===== src/MetricsProtocol.h =====
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Wire format of the metrics socket, shared by MetricsServer and the
+// reference client. Plain C++ so clients need nothing but this header.
+//
+// The socket is SOCK_SEQPACKET: every send is one record, so a message is
+// always read whole. Clients send one request byte:
+//   'G' get the latest message once
+//   'S' subscribe: the latest message now, then one whenever values change
+//   'U' unsubscribe
+// Messages are a fixed 80 byte layout in host byte order; both ends run on
+// the same machine. Values are quantized (whole MiB, PSI in hundredths) so
+// noise below that does not count as a change.
+namespace MetricsProtocol {
+
+constexpr std::uint32_t kMagic = 0x3154484eu; // "NHT1" read as bytes on little endian
+constexpr std::uint16_t kVersion = 1;
+
+enum Request : char { Get = 'G', Subscribe = 'S', Unsubscribe = 'U' };
+
+enum Flag : std::uint16_t {
+    DaemonActive = 1 << 0,  // nohang is running
+    HasZram = 1 << 1,
+    HasZswap = 1 << 2,
+    HasLimit = 1 << 3,      // totals are capped by a limit cgroup
+    SpilledToDisk = 1 << 4, // disk swap in use behind zram
+    HasNuma = 1 << 5,       // worstNodePermille is meaningful
+};
+
+struct Message {
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t size;               // sizeof(Message), lets a client reject older layouts
+    std::uint64_t seq;                // counts changes since the tray started
+    std::int64_t sampledAtMs;         // monotonic clock of the sample
+    // Everything from here on is compared to decide whether to send
+    std::uint8_t severity;            // 0 normal, 1 warn, 2 soft, 3 hard
+    std::uint8_t cause;               // SeverityMetric of the worst input
+    std::uint16_t flags;              // Flag bits
+    std::uint32_t memTotalMiB;        // effective, see SystemSnapshot::mem()
+    std::uint32_t memAvailableMiB;
+    std::uint32_t swapTotalMiB;
+    std::uint32_t swapFreeMiB;
+    std::uint32_t zramUsedMiB;        // logical, uncompressed
+    std::uint32_t zswapPoolMiB;
+    std::uint32_t spilledMiB;
+    std::uint16_t psiSomeAvg10;       // percent x 100
+    std::uint16_t psiFullAvg10;
+    std::uint16_t worstNodePermille;  // available share of the most constrained NUMA node
+    std::uint16_t reserved;
+    std::uint32_t swapInKiBPerSec;
+    std::uint32_t refaultKiBPerSec;
+    std::uint32_t majorFaultsPerSec;
+    std::uint32_t oomKills;           // since boot
+};
+
+constexpr std::size_t kValuesOffset = offsetof(Message, severity);
+static_assert(sizeof(Message) == 80, "wire layout is fixed");
+static_assert(kValuesOffset == 24);
+
+} // namespace MetricsProtocol
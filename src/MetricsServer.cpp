@@ -0,0 +1,207 @@
+// ===== src/MetricsServer.cpp =====
+#include "pch.h"
+#include "MetricsServer.h"
+#include "SystemSnapshot.h"
+#include "UnixSocket.h"
+#include <QFile>
+#include <QSocketNotifier>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using MetricsProtocol::Message;
+
+MetricsServer::MetricsServer(QObject* parent) : QObject(parent) {}
+
+MetricsServer::~MetricsServer() { close(); }
+
+static bool fillAddress(const QByteArray& path, sockaddr_un* addr) {
+    std::memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (path.isEmpty() || static_cast<size_t>(path.size()) >= sizeof(addr->sun_path)) return false;
+    std::memcpy(addr->sun_path, path.constData(), static_cast<size_t>(path.size()));
+    return true;
+}
+
+bool MetricsServer::listen(const QString& path, QString* error) {
+    close();
+    auto fail = [&](const QString& what) {
+        if (error) *error = what + QStringLiteral(": ") + qt_error_string(errno);
+        close();
+        return false;
+    };
+    const QByteArray native = QFile::encodeName(path);
+    sockaddr_un addr;
+    if (!fillAddress(native, &addr)) {
+        errno = ENAMETOOLONG;
+        return fail(path);
+    }
+
+    // Someone still answering means another tray owns the path
+    if (!UnixSocket::removeStale(native)) return fail(path);
+
+    m_listenFd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_listenFd < 0) return fail(QStringLiteral("socket"));
+    if (::bind(m_listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) return fail(path);
+    if (::listen(m_listenFd, 16) < 0) return fail(QStringLiteral("listen"));
+    m_path = path;
+    m_acceptNotifier = new QSocketNotifier(m_listenFd, QSocketNotifier::Read, this);
+    connect(m_acceptNotifier, &QSocketNotifier::activated, this, &MetricsServer::onAccept);
+    return true;
+}
+
+void MetricsServer::close() {
+    for (Client& c : m_clients) {
+        delete c.notifier;
+        ::close(c.fd);
+    }
+    m_clients.clear();
+    delete m_acceptNotifier;
+    m_acceptNotifier = nullptr;
+    if (m_listenFd >= 0) {
+        ::close(m_listenFd);
+        m_listenFd = -1;
+        ::unlink(QFile::encodeName(m_path).constData());
+    }
+    m_path.clear();
+}
+
+int MetricsServer::subscriberCount() const {
+    return static_cast<int>(std::count_if(m_clients.cbegin(), m_clients.cend(),
+                                          [](const Client& c) { return c.subscribed; }));
+}
+
+template <typename T>
+static T clampTo(double v) {
+    // Round and saturate, a fixed-width field must not wrap
+    if (!(v > 0)) return 0;
+    const double r = std::round(v);
+    return r >= static_cast<double>(std::numeric_limits<T>::max()) ? std::numeric_limits<T>::max() : static_cast<T>(r);
+}
+
+Message MetricsServer::encode(const SnapshotData& d, Severity level, SeverityMetric cause, bool active) {
+    Message m {};
+    m.magic = MetricsProtocol::kMagic;
+    m.version = MetricsProtocol::kVersion;
+    m.size = sizeof(Message);
+    m.sampledAtMs = d.sampledAtMs;
+    m.severity = static_cast<std::uint8_t>(level);
+    m.cause = static_cast<std::uint8_t>(cause);
+    std::uint16_t flags = 0;
+    if (active) flags |= MetricsProtocol::DaemonActive;
+    if (d.zram.present) flags |= MetricsProtocol::HasZram;
+    if (d.zswap.present && d.zswap.enabled) flags |= MetricsProtocol::HasZswap;
+    if (d.limit.present) flags |= MetricsProtocol::HasLimit;
+    if (d.swaps.spilled()) flags |= MetricsProtocol::SpilledToDisk;
+    if (d.numa.present && d.numa.shown > 0) flags |= MetricsProtocol::HasNuma;
+    m.flags = flags;
+    m.memTotalMiB = clampTo<std::uint32_t>(d.mem.memTotalMiB);
+    m.memAvailableMiB = clampTo<std::uint32_t>(d.mem.memAvailableMiB);
+    m.swapTotalMiB = clampTo<std::uint32_t>(d.mem.swapTotalMiB);
+    m.swapFreeMiB = clampTo<std::uint32_t>(d.mem.swapFreeMiB);
+    m.zramUsedMiB = clampTo<std::uint32_t>(d.zram.origDataMiB);
+    m.zswapPoolMiB = clampTo<std::uint32_t>(d.zswap.poolMiB);
+    m.spilledMiB = clampTo<std::uint32_t>(d.swaps.spilledMiB);
+    m.psiSomeAvg10 = clampTo<std::uint16_t>(d.psi.some_avg10 * 100);
+    m.psiFullAvg10 = clampTo<std::uint16_t>(d.psi.full_avg10 * 100);
+    if (d.numa.present && d.numa.shown > 0) m.worstNodePermille = clampTo<std::uint16_t>(d.numa.nodes[0].availablePercent * 10);
+    m.swapInKiBPerSec = clampTo<std::uint32_t>(d.vmstat.swapInMiBPerSec * 1024);
+    m.refaultKiBPerSec = clampTo<std::uint32_t>(d.vmstat.refaultMiBPerSec() * 1024);
+    m.majorFaultsPerSec = clampTo<std::uint32_t>(d.vmstat.majorFaultsPerSec);
+    m.oomKills = clampTo<std::uint32_t>(static_cast<double>(d.vmstat.oomKills));
+    return m;
+}
+
+bool MetricsServer::publish(Message msg) {
+    const auto* values = reinterpret_cast<const char*>(&msg) + MetricsProtocol::kValuesOffset;
+    const auto* lastValues = reinterpret_cast<const char*>(&m_last) + MetricsProtocol::kValuesOffset;
+    if (m_haveLast && std::memcmp(values, lastValues, sizeof(Message) - MetricsProtocol::kValuesOffset) == 0)
+        return false;
+    msg.seq = ++m_seq;
+    m_last = msg;
+    m_haveLast = true;
+
+    // One encoded buffer for everyone; collect the failures and drop them
+    // afterwards so the vector is not modified mid-loop
+    std::vector<int> gone;
+    for (Client& c : m_clients)
+        if (c.subscribed && !sendTo(c)) gone.push_back(c.fd);
+    for (int fd : gone) dropClient(fd);
+    return true;
+}
+
+bool MetricsServer::sendTo(Client& c) {
+    const ssize_t n = ::send(c.fd, &m_last, sizeof(Message), MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (n == static_cast<ssize_t>(sizeof(Message))) {
+        c.drops = 0;
+        ++m_sends;
+        return true;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        // The client is not reading; it gets a newer message later
+        ++m_drops;
+        return ++c.drops < kMaxDrops;
+    }
+    return false;
+}
+
+void MetricsServer::onAccept() {
+    for (;;) {
+        const int fd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        if (m_clients.size() >= static_cast<size_t>(kMaxClients)) {
+            ::close(fd);
+            continue;
+        }
+        Client c;
+        c.fd = fd;
+        c.notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(c.notifier, &QSocketNotifier::activated, this, [this, fd] { onClientReadable(fd); });
+        m_clients.push_back(c);
+    }
+}
+
+void MetricsServer::onClientReadable(int fd) {
+    const auto it = std::find_if(m_clients.begin(), m_clients.end(), [fd](const Client& c) { return c.fd == fd; });
+    if (it == m_clients.end()) return;
+    char req[16];
+    for (;;) {
+        const ssize_t n = ::recv(fd, req, sizeof(req), MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            dropClient(fd); // hung up
+            return;
+        }
+        if (n < 0) return;
+        switch (req[0]) {
+        case MetricsProtocol::Subscribe:
+            it->subscribed = true;
+            [[fallthrough]];
+        case MetricsProtocol::Get:
+            if (m_haveLast && !sendTo(*it)) {
+                dropClient(fd);
+                return;
+            }
+            break;
+        case MetricsProtocol::Unsubscribe:
+            it->subscribed = false;
+            break;
+        default:
+            break; // unknown requests are ignored, newer clients may probe
+        }
+    }
+}
+
+void MetricsServer::dropClient(int fd) {
+    const auto it = std::find_if(m_clients.begin(), m_clients.end(), [fd](const Client& c) { return c.fd == fd; });
+    if (it == m_clients.end()) return;
+    // May run inside the notifier's own activated signal
+    it->notifier->setEnabled(false);
+    it->notifier->deleteLater();
+    ::close(it->fd);
+    m_clients.erase(it);
+}
@@ -0,0 +1,65 @@
+// ===== src/MetricsServer.h =====
+#pragma once
+#include "MetricsProtocol.h"
+#include "SeverityEngine.h"
+#include <QObject>
+#include <QString>
+#include <vector>
+
+class QSocketNotifier;
+struct SnapshotData;
+
+// MetricsServer lets other tools read the tray's latest sample instead of
+// polling /proc themselves. It listens on a SOCK_SEQPACKET Unix socket and
+// speaks the fixed-layout MetricsProtocol. publish() encodes a message once
+// and, only when its values differ from the last one, sends that same
+// buffer to every subscriber with non-blocking sends. A subscriber whose
+// queue stays full is dropped rather than allowed to stall the tray.
+class MetricsServer : public QObject {
+    Q_OBJECT
+public:
+    explicit MetricsServer(QObject* parent = nullptr);
+    ~MetricsServer() override;
+
+    // Bind and listen; a stale socket file left by a dead tray is replaced
+    bool listen(const QString& path, QString* error = nullptr);
+    void close();
+    bool isListening() const { return m_listenFd >= 0; }
+    QString path() const { return m_path; }
+
+    static MetricsProtocol::Message encode(const SnapshotData& d, Severity level, SeverityMetric cause, bool active);
+
+    // Fan msg out to the subscribers if its values changed, returns whether it did
+    bool publish(MetricsProtocol::Message msg);
+
+    int clientCount() const { return static_cast<int>(m_clients.size()); }
+    int subscriberCount() const;
+    quint64 sends() const { return m_sends; }        // successful sends, all clients
+    quint64 drops() const { return m_drops; }        // messages skipped for full queues
+
+    static constexpr int kMaxClients = 256;
+    static constexpr int kMaxDrops = 16;             // consecutive, then the client is closed
+
+private:
+    struct Client {
+        int fd {-1};
+        QSocketNotifier* notifier {nullptr};
+        bool subscribed {false};
+        int drops {0};
+    };
+
+    void onAccept();
+    void onClientReadable(int fd);
+    bool sendTo(Client& c);                          // false when the client has to go
+    void dropClient(int fd);
+
+    QString m_path;
+    int m_listenFd {-1};
+    QSocketNotifier* m_acceptNotifier {nullptr};
+    std::vector<Client> m_clients;
+    MetricsProtocol::Message m_last {};
+    bool m_haveLast {false};
+    quint64 m_seq {0};
+    quint64 m_sends {0};
+    quint64 m_drops {0};
+};
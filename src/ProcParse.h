@@ -0,0 +1,72 @@
+// ===== src/ProcParse.h =====
+#pragma once
+#include <QByteArrayView>
+#include <charconv>
+#include <cstdint>
+
+// Allocation-free helpers for the line and column formats used by /proc,
+// /sys and cgroupfs. Everything works on views into a ProcReader buffer.
+namespace ProcParse {
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+inline QByteArrayView trimmed(QByteArrayView v) {
+    qsizetype b = 0, e = v.size();
+    while (b < e && isSpace(v[b])) ++b;
+    while (e > b && isSpace(v[e - 1])) --e;
+    return v.sliced(b, e - b);
+}
+
+// Calls fn(line) for each line without the trailing newline
+template <typename Fn>
+void forEachLine(QByteArrayView v, Fn&& fn) {
+    qsizetype start = 0;
+    while (start < v.size()) {
+        qsizetype nl = v.indexOf('\n', start);
+        if (nl < 0) nl = v.size();
+        fn(v.sliced(start, nl - start));
+        start = nl + 1;
+    }
+}
+
+// Next whitespace separated field starting at *pos, advancing *pos past it
+inline QByteArrayView nextField(QByteArrayView v, qsizetype* pos) {
+    qsizetype i = *pos;
+    while (i < v.size() && isSpace(v[i])) ++i;
+    const qsizetype b = i;
+    while (i < v.size() && !isSpace(v[i])) ++i;
+    *pos = i;
+    return v.sliced(b, i - b);
+}
+
+inline double toDouble(QByteArrayView v, double fallback = 0) {
+    v = trimmed(v);
+    double out = fallback;
+    const auto r = std::from_chars(v.data(), v.data() + v.size(), out);
+    return r.ec == std::errc() ? out : fallback;
+}
+
+inline std::int64_t toInt64(QByteArrayView v, std::int64_t fallback = 0) {
+    v = trimmed(v);
+    std::int64_t out = fallback;
+    const auto r = std::from_chars(v.data(), v.data() + v.size(), out);
+    return r.ec == std::errc() ? out : fallback;
+}
+
+// cgroup v2 limit files hold a number or "max"; missing stands for both
+// "max" and unparsable input
+inline std::int64_t cgroupValue(QByteArrayView v, std::int64_t missing = -1) {
+    v = trimmed(v);
+    if (v == "max") return missing;
+    return toInt64(v, missing);
+}
+
+// "key=value" lookup inside a line such as "some avg10=0.12 avg60=..."
+inline double keyedValue(QByteArrayView line, QByteArrayView key, double fallback = 0) {
+    const qsizetype k = line.indexOf(key);
+    if (k < 0) return fallback;
+    qsizetype pos = k + key.size();
+    return toDouble(nextField(line, &pos), fallback);
+}
+
+} // namespace ProcParse
@@ -0,0 +1,261 @@
+// ===== src/ProcReader.cpp =====
+#include "pch.h"
+#include "ProcReader.h"
+#include <QFile>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static constexpr unsigned kRingEntries = 64;
+
+ProcReader::~ProcReader() {
+    for (Slot& s : m_slots)
+        if (s.fd >= 0) ::close(s.fd);
+}
+
+int ProcReader::add(const QString& path, qsizetype bufferSize) {
+    Slot s;
+    s.path = path;
+    s.name = QFile::encodeName(path);
+    s.buf.resize(std::max<qsizetype>(bufferSize, 1)); // an empty buffer would never grow
+    if (!m_free.empty()) {
+        const int id = m_free.back();
+        m_free.pop_back();
+        m_slots[id] = std::move(s);
+        return id;
+    }
+    m_slots.push_back(std::move(s));
+    return static_cast<int>(m_slots.size()) - 1;
+}
+
+void ProcReader::remove(int slot) {
+    Slot& s = m_slots[slot];
+    if (!s.live) return;
+    if (s.fd >= 0) ::close(s.fd);
+    s = Slot();
+    s.live = false;
+    m_free.push_back(slot);
+}
+
+QByteArrayView ProcReader::data(int slot) const {
+    const Slot& s = m_slots[slot];
+    if (s.len <= 0) return {};
+    return QByteArrayView(s.buf.constData(), s.len);
+}
+
+void ProcReader::readAll() {
+    m_openIds.clear();
+    for (int i = 0; i < static_cast<int>(m_slots.size()); ++i) {
+        Slot& s = m_slots[i];
+        if (!s.live) continue;
+        if (s.fd < 0) {
+            ++m_syscalls;
+            s.fd = ::open(s.name.constData(), O_RDONLY | O_CLOEXEC);
+        }
+        if (s.fd < 0) {
+            s.len = -1;
+            continue;
+        }
+        m_openIds.push_back(i);
+    }
+    if (!m_openIds.empty()) readOpen(m_openIds);
+}
+
+void ProcReader::preadSlot(Slot& s) {
+    ++m_syscalls;
+    const ssize_t n = ::pread(s.fd, s.buf.data(), static_cast<size_t>(s.buf.size()), 0);
+    completeSlot(s, n < 0 ? -errno : static_cast<long>(n));
+}
+
+void ProcReader::completeSlot(Slot& s, long res) {
+    if (res < 0) {
+        // The device or file went away, reopen on the next batch
+        ::close(s.fd);
+        s.fd = -1;
+        s.len = -1;
+        return;
+    }
+    if (res == s.buf.size()) {
+        // Possibly truncated, grow and re-read synchronously; this happens
+        // once per file since the buffer is kept
+        s.buf.resize(s.buf.size() * 2);
+        preadSlot(s);
+        return;
+    }
+    s.len = res;
+}
+
+namespace {
+
+class PreadReader final : public ProcReader {
+public:
+    Backend backend() const override { return Backend::Pread; }
+
+private:
+    void readOpen(const std::vector<int>& ids) override {
+        for (int id : ids) preadSlot(m_slots[id]);
+    }
+};
+
+// Raw io_uring, no liburing dependency: one ring, IORING_OP_READ at offset 0
+// for each file, a single io_uring_enter that submits and waits for all.
+class UringReader final : public ProcReader {
+public:
+    static std::unique_ptr<ProcReader> tryCreate() {
+        std::unique_ptr<UringReader> r(new UringReader);
+        if (!r->setup()) return nullptr;
+        return r;
+    }
+
+    ~UringReader() override {
+        if (m_sqes) munmap(m_sqes, m_sqesSize);
+        if (m_cqRing && m_cqRing != m_sqRing) munmap(m_cqRing, m_cqRingSize);
+        if (m_sqRing) munmap(m_sqRing, m_sqRingSize);
+        if (m_ringFd >= 0) ::close(m_ringFd);
+    }
+
+    Backend backend() const override { return m_broken ? Backend::Pread : Backend::IoUring; }
+
+private:
+    UringReader() = default;
+
+    bool setup() {
+        io_uring_params p{};
+        m_ringFd = static_cast<int>(syscall(__NR_io_uring_setup, kRingEntries, &p));
+        if (m_ringFd < 0) return false;
+
+        m_sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        m_cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+
+        m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        m_ringFd, IORING_OFF_SQ_RING);
+        if (m_sqRing == MAP_FAILED) { m_sqRing = nullptr; return false; }
+        if (single) {
+            m_cqRing = m_sqRing;
+        } else {
+            m_cqRing = mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            m_ringFd, IORING_OFF_CQ_RING);
+            if (m_cqRing == MAP_FAILED) { m_cqRing = nullptr; return false; }
+        }
+        m_sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          m_ringFd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return false;
+        m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+        auto* sq = static_cast<char*>(m_sqRing);
+        auto* cq = static_cast<char*>(m_cqRing);
+        m_sqTail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        m_sqMask = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        m_sqArray = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        m_sqEntries = p.sq_entries;
+        m_cqHead = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        m_cqTail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        m_cqMask = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        return true;
+    }
+
+    void readOpen(const std::vector<int>& ids) override {
+        if (m_broken) {
+            for (int id : ids) preadSlot(m_slots[id]);
+            return;
+        }
+        for (size_t first = 0; first < ids.size(); first += m_sqEntries)
+            submitChunk(ids, first, std::min<size_t>(ids.size(), first + m_sqEntries));
+    }
+
+    void submitChunk(const std::vector<int>& ids, size_t first, size_t last) {
+        unsigned tail = std::atomic_ref<unsigned>(*m_sqTail).load(std::memory_order_relaxed);
+        for (size_t i = first; i < last; ++i) {
+            Slot& s = m_slots[ids[i]];
+            const unsigned idx = tail & m_sqMask;
+            io_uring_sqe* sqe = &m_sqes[idx];
+            std::memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = s.fd;
+            sqe->addr = reinterpret_cast<quint64>(s.buf.data());
+            sqe->len = static_cast<unsigned>(s.buf.size());
+            sqe->off = 0;
+            sqe->user_data = static_cast<quint64>(ids[i]);
+            m_sqArray[idx] = idx;
+            ++tail;
+        }
+        std::atomic_ref<unsigned>(*m_sqTail).store(tail, std::memory_order_release);
+
+        const unsigned want = static_cast<unsigned>(last - first);
+        unsigned reaped = 0;
+        unsigned toSubmit = want;
+        while (reaped < want) {
+            ++m_syscalls;
+            const long rc = syscall(__NR_io_uring_enter, m_ringFd, toSubmit, want - reaped,
+                                    IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (rc < 0 && errno == EINTR) continue;
+            if (rc < 0) {
+                // Ring unusable, finish this and every later batch with pread
+                m_broken = true;
+                for (size_t i = first; i < last; ++i) preadSlot(m_slots[ids[i]]);
+                return;
+            }
+            toSubmit -= std::min<unsigned>(toSubmit, static_cast<unsigned>(rc));
+            reaped += reap();
+        }
+    }
+
+    unsigned reap() {
+        unsigned head = std::atomic_ref<unsigned>(*m_cqHead).load(std::memory_order_relaxed);
+        const unsigned tail = std::atomic_ref<unsigned>(*m_cqTail).load(std::memory_order_acquire);
+        unsigned n = 0;
+        for (; head != tail; ++head, ++n) {
+            const io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+            Slot& s = m_slots[static_cast<int>(cqe.user_data)];
+            if (cqe.res == -EINVAL || cqe.res == -EOPNOTSUPP) {
+                // Kernel predates IORING_OP_READ
+                m_broken = true;
+                preadSlot(s);
+            } else {
+                completeSlot(s, cqe.res);
+            }
+        }
+        std::atomic_ref<unsigned>(*m_cqHead).store(head, std::memory_order_release);
+        return n;
+    }
+
+    int m_ringFd {-1};
+    void* m_sqRing {nullptr};
+    void* m_cqRing {nullptr};
+    size_t m_sqRingSize {0};
+    size_t m_cqRingSize {0};
+    io_uring_sqe* m_sqes {nullptr};
+    size_t m_sqesSize {0};
+    unsigned* m_sqTail {nullptr};
+    unsigned m_sqMask {0};
+    unsigned* m_sqArray {nullptr};
+    unsigned m_sqEntries {0};
+    unsigned* m_cqHead {nullptr};
+    unsigned* m_cqTail {nullptr};
+    unsigned m_cqMask {0};
+    io_uring_cqe* m_cqes {nullptr};
+    bool m_broken {false};
+};
+
+} // namespace
+
+std::unique_ptr<ProcReader> ProcReader::create(Backend preferred) {
+    if (preferred == Backend::Auto) {
+        const QByteArray env = qgetenv("NOHANG_TRAY_IO_BACKEND");
+        preferred = (env == "pread") ? Backend::Pread : Backend::IoUring;
+    }
+    if (preferred == Backend::IoUring) {
+        if (auto r = UringReader::tryCreate()) return r;
+    }
+    return std::make_unique<PreadReader>();
+}
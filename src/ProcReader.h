@@ -0,0 +1,69 @@
+// ===== src/ProcReader.h =====
+#pragma once
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <memory>
+#include <vector>
+
+// ProcReader keeps small /proc and /sys files open and re-reads all of them
+// in one batch per tick. Files that do not exist yet are retried on every
+// batch, files that vanish are closed and reopened once they come back.
+//
+// Two backends share this interface: plain pread(2) per file, and a single
+// io_uring submission reaped in one go. The backend is picked at runtime,
+// io_uring falls back to pread when the kernel or a seccomp filter refuses it.
+// A third, Replay, serves recorded file contents instead (see TraceReplay).
+//
+// Slots can be dropped again, which closes the fd; add() reuses free slots,
+// so a caller tracking a changing set of files (CgroupSampler) keeps one
+// reader and one io_uring ring for its lifetime.
+class ProcReader {
+public:
+    enum class Backend { Auto, Pread, IoUring, Replay };
+
+    // Auto honours NOHANG_TRAY_IO_BACKEND=pread|io_uring, else tries io_uring
+    static std::unique_ptr<ProcReader> create(Backend preferred = Backend::Auto);
+    virtual ~ProcReader();
+    ProcReader(const ProcReader&) = delete;
+    ProcReader& operator=(const ProcReader&) = delete;
+
+    virtual Backend backend() const = 0;
+
+    static constexpr qsizetype kInitialBuffer = 8192;
+
+    // Register once, returns the slot id. Pass a smaller buffer for files
+    // holding a single value; it still grows if a read fills it.
+    int add(const QString& path, qsizetype bufferSize = kInitialBuffer);
+    void remove(int slot);               // close the fd, the id may be handed out again
+    virtual void readAll();              // one batch over every registered file
+
+    bool ok(int slot) const { return m_slots[slot].len >= 0; }
+    QByteArrayView data(int slot) const;
+    const QString& path(int slot) const { return m_slots[slot].path; }
+    quint64 syscalls() const { return m_syscalls; }
+
+protected:
+    ProcReader() = default;
+
+    struct Slot {
+        QString path;
+        QByteArray name;                 // path in the local 8-bit encoding, for open(2)
+        bool live {true};                // false once removed, skipped by readAll()
+        int fd {-1};
+        QByteArray buf;
+        qsizetype len {-1};              // bytes of the last read, -1 if missing or failed
+    };
+
+    // Read every slot in ids, all of which have an open fd, setting len
+    virtual void readOpen(const std::vector<int>& ids) = 0;
+    void preadSlot(Slot& s);             // pread fallback, shared by every backend
+    void completeSlot(Slot& s, long res); // record a result, grow and re-read if truncated
+
+    std::vector<Slot> m_slots;
+    quint64 m_syscalls {0};
+
+private:
+    std::vector<int> m_openIds;          // reused across batches
+    std::vector<int> m_free;             // removed slots, reused by add()
+};
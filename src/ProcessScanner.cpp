@@ -0,0 +1,380 @@
+// ===== src/ProcessScanner.cpp =====
+#include "pch.h"
+#include "ProcessScanner.h"
+#include "ProcParse.h"
+#include <QFile>
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <QFileInfo>
+#include <QHash>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+static constexpr int kMaxWorkers = 4;
+static constexpr qsizetype kPidsPerWorker = 64;
+
+qint64 ProcessScanner::nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+qint64 ProcessScanner::threadCpuUs() {
+    timespec ts {};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+ProcessScanner::ProcessScanner(const QString& procRoot, int workers)
+    : m_procRoot(procRoot),
+      m_workers(workers > 0 ? workers
+                            : std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, kMaxWorkers)) {}
+
+QVector<int> ProcessScanner::listPids() const {
+    QVector<int> pids;
+    DIR* d = opendir(QFile::encodeName(m_procRoot).constData());
+    if (!d) return pids;
+    while (dirent* e = readdir(d)) {
+        const char* n = e->d_name;
+        if (*n < '1' || *n > '9') continue;
+        const auto v = ProcParse::toInt64(QByteArrayView(n), -1);
+        if (v > 0) pids.push_back(static_cast<int>(v));
+    }
+    closedir(d);
+    std::sort(pids.begin(), pids.end());
+    return pids;
+}
+
+// Read a small file relative to the pid directory, returns bytes read or -1
+static qsizetype readAt(int dirfd, const char* name, char* buf, qsizetype size) {
+    const int fd = openat(dirfd, name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    const ssize_t n = ::read(fd, buf, static_cast<size_t>(size));
+    ::close(fd);
+    return n;
+}
+
+static int openPidDir(const QString& procRoot, int pid) {
+    const QByteArray dir = QFile::encodeName(procRoot) + '/' + QByteArray::number(pid);
+    return ::open(dir.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+}
+
+static bool parseStat(QByteArrayView v, ProcessInfo* p, bool withName) {
+    // "pid (comm) S ppid ... starttime ...", comm may hold spaces and parens
+    const qsizetype open = v.indexOf('(');
+    const qsizetype close = v.lastIndexOf(')');
+    if (open < 0 || close < open) return false;
+    if (withName) p->name = QString::fromUtf8(v.sliced(open + 1, close - open - 1));
+    qsizetype pos = close + 1;
+    for (int field = 3; field <= 22; ++field) {
+        const QByteArrayView f = ProcParse::nextField(v, &pos);
+        if (f.isEmpty()) return false;
+        if (field == 3) p->state = f[0];
+        else if (field == 4) p->ppid = static_cast<int>(ProcParse::toInt64(f));
+        else if (field == 22) p->startTime = static_cast<quint64>(ProcParse::toInt64(f));
+    }
+    return true;
+}
+
+static void parseStatus(QByteArrayView v, ProcessInfo* p, bool withUid) {
+    ProcParse::forEachLine(v, [&](QByteArrayView line) {
+        qsizetype pos = line.indexOf(':') + 1;
+        if (pos <= 0) return;
+        if (withUid && line.startsWith("Uid:")) p->uid = static_cast<uint>(ProcParse::toInt64(ProcParse::nextField(line, &pos)));
+        else if (line.startsWith("VmRSS:")) p->rssKiB = ProcParse::toInt64(ProcParse::nextField(line, &pos));
+        else if (line.startsWith("VmSwap:")) p->swapKiB = ProcParse::toInt64(ProcParse::nextField(line, &pos));
+    });
+}
+
+static void parseCgroup(QByteArrayView v, ProcessInfo* p) {
+    ProcParse::forEachLine(v, [&](QByteArrayView line) {
+        if (line.startsWith("0::")) p->cgroup = QString::fromUtf8(ProcParse::trimmed(line.sliced(3)));
+    });
+}
+
+static void parseCmdline(QByteArrayView v, ProcessInfo* p) {
+    QByteArray s = v.toByteArray();
+    s.replace('\0', ' ');
+    p->cmdline = QString::fromUtf8(ProcParse::trimmed(s));
+}
+
+// stat, rss/swap from status and the oom files: everything that moves while a
+// process lives. withStatic also fills name and uid.
+static bool readFields(int dirfd, ProcessInfo* p, char* buf, qsizetype size, bool withStatic) {
+    const qsizetype n = readAt(dirfd, "stat", buf, size);
+    if (n <= 0 || !parseStat(QByteArrayView(buf, n), p, withStatic)) return false;
+    if (const qsizetype m = readAt(dirfd, "status", buf, size); m > 0)
+        parseStatus(QByteArrayView(buf, m), p, withStatic);
+    if (const qsizetype m = readAt(dirfd, "oom_score", buf, size); m > 0)
+        p->oomScore = static_cast<int>(ProcParse::toInt64(QByteArrayView(buf, m)));
+    if (const qsizetype m = readAt(dirfd, "oom_score_adj", buf, size); m > 0)
+        p->oomScoreAdj = static_cast<int>(ProcParse::toInt64(QByteArrayView(buf, m)));
+    return true;
+}
+
+// cmdline, cgroup and exe, only read once per process
+static void readStatic(int dirfd, ProcessInfo* p, char* buf, qsizetype size) {
+    if (const qsizetype n = readAt(dirfd, "cmdline", buf, size); n > 0) parseCmdline(QByteArrayView(buf, n), p);
+    if (const qsizetype n = readAt(dirfd, "cgroup", buf, size); n > 0) parseCgroup(QByteArrayView(buf, n), p);
+    if (const ssize_t n = readlinkat(dirfd, "exe", buf, static_cast<size_t>(size)); n > 0)
+        p->exe = QFile::decodeName(QByteArray(buf, n));
+}
+
+bool ProcessScanner::readProcess(int pid, ProcessInfo* out) const {
+    const int dirfd = openPidDir(m_procRoot, pid);
+    if (dirfd < 0) return false;
+
+    char buf[4096];
+    ProcessInfo p;
+    p.pid = pid;
+    const bool ok = readFields(dirfd, &p, buf, sizeof(buf), true);
+    if (ok) readStatic(dirfd, &p, buf, sizeof(buf));
+    ::close(dirfd);
+    if (ok) *out = std::move(p);
+    return ok;
+}
+
+bool ProcessScanner::readPss(int pid, PssInfo* out) const {
+    const int dirfd = openPidDir(m_procRoot, pid);
+    if (dirfd < 0) return false;
+    char buf[4096];
+    const qsizetype n = readAt(dirfd, "smaps_rollup", buf, sizeof(buf));
+    ::close(dirfd);
+    if (n <= 0) return false; // gone, or another user's process without privileges
+
+    PssInfo pss;
+    ProcParse::forEachLine(QByteArrayView(buf, n), [&](QByteArrayView line) {
+        qsizetype pos = line.indexOf(':') + 1;
+        if (pos <= 0) return;
+        const QByteArrayView key = line.first(pos - 1);
+        if (key == "Pss") pss.pssKiB = ProcParse::toInt64(ProcParse::nextField(line, &pos));
+        else if (key == "Pss_Anon") pss.pssAnonKiB = ProcParse::toInt64(ProcParse::nextField(line, &pos));
+        else if (key == "Pss_Shmem") pss.pssShmemKiB = ProcParse::toInt64(ProcParse::nextField(line, &pos));
+        else if (key == "SwapPss") pss.swapPssKiB = ProcParse::toInt64(ProcParse::nextField(line, &pos));
+    });
+    *out = pss;
+    return true;
+}
+
+void ProcessScanner::readPssRoundRobin(const QVector<int>& pids, QVector<ProcessInfo>& rows,
+                                       std::vector<Refresh>& outcome, std::chrono::microseconds budget) {
+    const qsizetype n = pids.size();
+    if (n == 0 || budget.count() <= 0) return;
+    // Resume after the pid read last time, wrapping around
+    qsizetype first = std::upper_bound(pids.cbegin(), pids.cend(), m_pssCursor) - pids.cbegin();
+    if (first == n) first = 0;
+
+    const qint64 start = threadCpuUs();
+    const qint64 now = nowMs();
+    for (qsizetype k = 0; k < n; ++k) {
+        const qsizetype i = (first + k) % n;
+        if (outcome[i] == Refresh::Gone) continue;
+        PssInfo pss;
+        if (readPss(pids[i], &pss)) {
+            pss.sampledAtMs = now;
+            rows[i].pss = pss;
+            // A fresh timestamp is news for the view even if the sizes held
+            if (outcome[i] == Refresh::Same) outcome[i] = Refresh::Changed;
+        }
+        m_pssCursor = pids[i];
+        if (threadCpuUs() - start >= budget.count()) break;
+    }
+}
+
+static QString appLeaf(const QString& cgroup) {
+    // systemd puts each desktop app in an app-*.scope and each service in
+    // a .service; session scopes hold unrelated processes and do not count
+    const QString leaf = cgroup.section(QLatin1Char('/'), -1);
+    if (leaf.startsWith(QLatin1String("session-"))) return {};
+    if (leaf.endsWith(QLatin1String(".scope")) || leaf.endsWith(QLatin1String(".service"))) return leaf;
+    return {};
+}
+
+QVector<AppUsage> ProcessScanner::groupByApp(const QVector<ProcessInfo>& rows) {
+    QVector<AppUsage> apps;
+    QHash<QString, qsizetype> index;
+    for (const ProcessInfo& p : rows) {
+        QString key;
+        QString label = appLeaf(p.cgroup);
+        if (!label.isEmpty()) {
+            key = p.cgroup;
+        } else if (!p.exe.isEmpty()) {
+            key = p.exe;
+            label = QFileInfo(p.exe).fileName();
+        } else {
+            key = label = p.name;
+        }
+
+        auto it = index.constFind(key);
+        if (it == index.cend()) {
+            it = index.insert(key, apps.size());
+            AppUsage a;
+            a.key = key;
+            a.label = label;
+            apps.push_back(a);
+        }
+        AppUsage& a = apps[*it];
+        ++a.processes;
+        a.rssKiB += p.rssKiB;
+        a.swapKiB += p.swapKiB;
+        if (!p.pss.valid()) {
+            ++a.pssMissing;
+            continue;
+        }
+        a.pss.pssKiB += p.pss.pssKiB;
+        a.pss.pssAnonKiB += p.pss.pssAnonKiB;
+        a.pss.pssShmemKiB += p.pss.pssShmemKiB;
+        a.pss.swapPssKiB += p.pss.swapPssKiB;
+        if (!a.pss.valid() || p.pss.sampledAtMs < a.pss.sampledAtMs) a.pss.sampledAtMs = p.pss.sampledAtMs;
+    }
+
+    // PSS where there is any, RSS otherwise; ties by key keep the order stable
+    auto weight = [](const AppUsage& a) { return a.pss.valid() ? a.pss.pssKiB + a.pss.swapPssKiB : a.rssKiB + a.swapKiB; };
+    std::sort(apps.begin(), apps.end(), [&](const AppUsage& a, const AppUsage& b) {
+        const qint64 wa = weight(a), wb = weight(b);
+        return wa != wb ? wa > wb : a.key < b.key;
+    });
+    return apps;
+}
+
+bool ProcessScanner::readSummary(int pid, ProcessInfo* out) const {
+    const int dirfd = openPidDir(m_procRoot, pid);
+    if (dirfd < 0) return false;
+
+    // Callers may reuse *out between pids: clear what a file might not set,
+    // but keep the name's storage
+    char buf[4096];
+    out->pid = pid;
+    out->ppid = 0;
+    out->uid = 0;
+    out->rssKiB = out->swapKiB = 0;
+    out->oomScore = out->oomScoreAdj = 0;
+    const bool ok = readFields(dirfd, out, buf, sizeof(buf), true);
+    ::close(dirfd);
+    return ok;
+}
+
+ProcessScanner::Refresh ProcessScanner::refreshProcess(ProcessInfo* p) const {
+    const int dirfd = openPidDir(m_procRoot, p->pid);
+    if (dirfd < 0) return Refresh::Gone;
+
+    char buf[4096];
+    ProcessInfo next = *p;
+    Refresh result = Refresh::Gone;
+    if (readFields(dirfd, &next, buf, sizeof(buf), false)) {
+        if (next.startTime != p->startTime) {
+            // Same pid, different process: start over with a full read
+            next = ProcessInfo{};
+            next.pid = p->pid;
+            if (readFields(dirfd, &next, buf, sizeof(buf), true)) {
+                readStatic(dirfd, &next, buf, sizeof(buf));
+                result = Refresh::Reused;
+            }
+        } else {
+            const bool same = next.state == p->state && next.ppid == p->ppid && next.rssKiB == p->rssKiB &&
+                              next.swapKiB == p->swapKiB && next.oomScore == p->oomScore &&
+                              next.oomScoreAdj == p->oomScoreAdj;
+            result = same ? Refresh::Same : Refresh::Changed;
+        }
+    }
+    ::close(dirfd);
+    if (result != Refresh::Gone && result != Refresh::Same) *p = std::move(next);
+    return result;
+}
+
+// Runs fn(begin, end) over contiguous index ranges, one range per worker
+template <typename Fn>
+void ProcessScanner::forEachRange(qsizetype count, Fn&& fn) const {
+    const int workers = std::max(1, std::min<int>(m_workers, static_cast<int>(count / kPidsPerWorker) + 1));
+    auto work = [&](int w) { fn(w, count * w / workers, count * (w + 1) / workers); };
+    std::vector<std::thread> pool;
+    for (int w = 1; w < workers; ++w) pool.emplace_back(work, w);
+    work(0);
+    for (auto& t : pool) t.join();
+}
+
+QVector<ProcessInfo> ProcessScanner::scan() const {
+    const QVector<int> pids = listPids();
+
+    // One result vector per range, concatenated in order so the output stays
+    // sorted without another pass
+    std::vector<QVector<ProcessInfo>> parts(std::max(m_workers, 1));
+    forEachRange(pids.size(), [&](int w, qsizetype begin, qsizetype end) {
+        QVector<ProcessInfo>& out = parts[w];
+        out.reserve(end - begin);
+        ProcessInfo p;
+        for (qsizetype i = begin; i < end; ++i)
+            if (readProcess(pids[i], &p)) out.push_back(p);
+    });
+
+    QVector<ProcessInfo> all;
+    all.reserve(pids.size());
+    for (auto& part : parts) all.append(std::move(part));
+    return all;
+}
+
+ProcessDelta ProcessScanner::update(std::chrono::microseconds pssBudget) {
+    const QVector<int> pids = listPids();
+
+    // Start each live pid from its cached row when there is one; the merge
+    // works because both lists are sorted by pid
+    QVector<ProcessInfo> next(pids.size());
+    std::vector<Refresh> outcome(pids.size(), Refresh::Gone);
+    std::vector<char> known(pids.size(), 0);
+    for (qsizetype i = 0, j = 0; i < pids.size(); ++i) {
+        while (j < m_rows.size() && m_rows[j].pid < pids[i]) ++j;
+        if (j < m_rows.size() && m_rows[j].pid == pids[i]) {
+            next[i] = m_rows[j];
+            known[i] = 1;
+        } else {
+            next[i].pid = pids[i];
+        }
+    }
+
+    std::vector<qint64> fullReads(std::max(m_workers, 1), 0);
+    forEachRange(pids.size(), [&](int w, qsizetype begin, qsizetype end) {
+        for (qsizetype i = begin; i < end; ++i) {
+            if (known[i]) {
+                outcome[i] = refreshProcess(&next[i]);
+                if (outcome[i] == Refresh::Reused) ++fullReads[w];
+            } else if (readProcess(pids[i], &next[i])) {
+                outcome[i] = Refresh::Reused; // new to us, same handling as a reused pid
+                ++fullReads[w];
+            }
+        }
+    });
+    for (qint64 n : fullReads) m_staticReads += n;
+    readPssRoundRobin(pids, next, outcome, pssBudget);
+
+    ProcessDelta delta;
+    QVector<ProcessInfo> rows;
+    rows.reserve(pids.size());
+    qsizetype j = 0;
+    for (qsizetype i = 0; i < pids.size(); ++i) {
+        // Cached rows with a smaller pid are gone
+        for (; j < m_rows.size() && m_rows[j].pid < pids[i]; ++j) delta.removed.push_back(m_rows[j].pid);
+        const bool cached = j < m_rows.size() && m_rows[j].pid == pids[i];
+        if (cached) ++j;
+        switch (outcome[i]) {
+        case Refresh::Gone:
+            if (cached) delta.removed.push_back(pids[i]);
+            continue;
+        case Refresh::Reused:
+            if (cached) delta.removed.push_back(pids[i]);
+            delta.added.push_back(next[i]);
+            break;
+        case Refresh::Changed:
+            delta.changed.push_back(next[i]);
+            break;
+        case Refresh::Same:
+            break;
+        }
+        rows.push_back(std::move(next[i]));
+    }
+    for (; j < m_rows.size(); ++j) delta.removed.push_back(m_rows[j].pid);
+
+    m_rows = std::move(rows);
+    return delta;
+}
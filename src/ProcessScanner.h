@@ -0,0 +1,110 @@
+// ===== src/ProcessScanner.h =====
+#pragma once
+#include <QString>
+#include <QVector>
+#include <chrono>
+
+// Proportional set size from /proc/[pid]/smaps_rollup. Shared pages are
+// divided among the processes mapping them, so PSS sums across processes
+// without the double counting of VmRSS.
+struct PssInfo {
+    qint64 pssKiB {0};
+    qint64 pssAnonKiB {0};
+    qint64 pssShmemKiB {0};
+    qint64 swapPssKiB {0};
+    qint64 sampledAtMs {0};  // ProcessScanner::nowMs() of the read, 0 = never read
+
+    bool valid() const { return sampledAtMs > 0; }
+};
+
+// One row of the process table, read straight from /proc/[pid]
+struct ProcessInfo {
+    int pid {0};
+    int ppid {0};
+    QString name;           // comm, from stat
+    QString cmdline;        // NUL separators replaced by spaces, empty for kernel threads
+    QString cgroup;         // cgroup v2 path from the "0::" line
+    QString exe;            // /proc/[pid]/exe target, empty if not readable
+    char state {'?'};
+    uint uid {0};           // real uid, from status
+    qint64 rssKiB {0};      // VmRSS
+    qint64 swapKiB {0};     // VmSwap
+    int oomScore {0};
+    int oomScoreAdj {0};
+    quint64 startTime {0};  // clock ticks after boot, tells a reused pid apart
+    PssInfo pss;            // only filled by update() with a PSS budget
+};
+
+// Memory of one application: processes sharing an app cgroup (a systemd
+// .scope or .service), otherwise the same executable
+struct AppUsage {
+    QString key;            // cgroup path, exe path or comm
+    QString label;          // short name for display
+    int processes {0};
+    qint64 rssKiB {0};
+    qint64 swapKiB {0};
+    PssInfo pss;            // sums; sampledAtMs is the oldest read that went in
+    int pssMissing {0};     // processes without a PSS read yet
+};
+
+// Row-level difference between two ProcessScanner::update() calls.
+// A reused pid shows up in both removed and added.
+struct ProcessDelta {
+    QVector<int> removed;           // sorted pids that exited
+    QVector<ProcessInfo> added;     // sorted by pid
+    QVector<ProcessInfo> changed;   // sorted by pid, only volatile fields differ
+
+    bool isEmpty() const { return removed.isEmpty() && added.isEmpty() && changed.isEmpty(); }
+};
+
+// ProcessScanner lists processes natively instead of spawning
+// `nohang --tasks`. The PID list is split into contiguous ranges that a
+// small pool of worker threads reads in parallel. Like SystemSnapshot it
+// accepts a fake proc root for tests and benchmarks.
+//
+// scan() is a stateless full read. update() keeps a pid-keyed cache of the
+// previous result: name, cmdline, uid and cgroup are read once per process
+// and reused while the start time in stat still matches, so a refresh only
+// re-reads the volatile fields and reports what changed.
+//
+// smaps_rollup is expensive (the kernel walks every VMA), so PSS is opt-in:
+// update() reads it round-robin, resuming after the last pid it read, until
+// the thread CPU budget for the call is spent. Rows not reached keep their
+// previous PssInfo and its timestamp.
+class ProcessScanner {
+public:
+    explicit ProcessScanner(const QString& procRoot = QStringLiteral("/proc"), int workers = 0);
+
+    QVector<ProcessInfo> scan() const;           // sorted by pid
+    QVector<int> listPids() const;                // numeric entries of the proc root, sorted
+    bool readProcess(int pid, ProcessInfo* out) const; // false if the pid vanished
+    bool readSummary(int pid, ProcessInfo* out) const; // as readProcess, minus cmdline and cgroup
+
+    ProcessDelta update(std::chrono::microseconds pssBudget = {}); // not thread safe, one caller at a time
+    const QVector<ProcessInfo>& cached() const { return m_rows; }
+    qint64 staticReads() const { return m_staticReads; } // full per-process reads so far
+
+    int workers() const { return m_workers; }
+    const QString& procRoot() const { return m_procRoot; }
+
+    bool readPss(int pid, PssInfo* out) const;    // smaps_rollup, sampledAtMs left to the caller
+    static QVector<AppUsage> groupByApp(const QVector<ProcessInfo>& rows); // largest first
+
+    static qint64 nowMs();                        // steady clock, same base as SystemSnapshot
+    static qint64 threadCpuUs();                  // CPU time of the calling thread
+
+private:
+    enum class Refresh : char { Gone, Same, Changed, Reused };
+    Refresh refreshProcess(ProcessInfo* p) const;
+    void readPssRoundRobin(const QVector<int>& pids, QVector<ProcessInfo>& rows, std::vector<Refresh>& outcome,
+                           std::chrono::microseconds budget);
+
+    template <typename Fn>
+    void forEachRange(qsizetype count, Fn&& fn) const;
+
+    QString m_procRoot;
+    int m_workers;
+    QVector<ProcessInfo> m_rows;                  // update() cache, sorted by pid
+    qint64 m_staticReads {0};
+    int m_pssCursor {0};                          // last pid whose smaps_rollup was read
+};
@@ -1,39 +1,300 @@
 // ===== src/ProcessTableAction.cpp =====
 #include "pch.h"
 #include "ProcessTableAction.h"
+#include "ProcessScanner.h"
+#include "ProcessTableModel.h"
 #include <QAction>
+#include <QCheckBox>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QElapsedTimer>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPointer>
 #include <QProcess>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QSortFilterProxyModel>
+#include <QStringDecoder>
+#include <QTextCursor>
 #include <QTextEdit>
-#include <QDialog>
+#include <QTabWidget>
+#include <QTableView>
+#include <QThreadPool>
+#include <QTimer>
 #include <QVBoxLayout>
+#include <memory>
+
+static constexpr int kElapsedTickMs = 200;
+static constexpr int kTableRefreshMs = 2000;
+
+namespace {
+
+// Dialog that runs `nohang --tasks` asynchronously and appends output as it
+// arrives, so the GUI thread never waits on a slow listing under pressure.
+class TasksDialog final : public QDialog {
+public:
+    TasksDialog(const QStringList& args, QWidget* parent = nullptr) : QDialog(parent) {
+        setAttribute(Qt::WA_DeleteOnClose);
+        setWindowTitle(QStringLiteral("nohang --tasks"));
+
+        m_edit = new QTextEdit(this);
+        m_edit->setObjectName(QStringLiteral("tasksOutput"));
+        m_edit->setReadOnly(true);
+        m_edit->setLineWrapMode(QTextEdit::NoWrap);
+        m_status = new QLabel(this);
+        m_status->setObjectName(QStringLiteral("tasksStatus"));
+        auto* buttons = new QDialogButtonBox(QDialogButtonBox::Cancel, this);
+        m_cancel = buttons->button(QDialogButtonBox::Cancel);
+        m_cancel->setObjectName(QStringLiteral("tasksCancel"));
+
+        auto* lay = new QVBoxLayout(this);
+        lay->addWidget(m_edit);
+        lay->addWidget(m_status);
+        lay->addWidget(buttons);
+        resize(800, 500);
+
+        m_proc = new QProcess(this);
+        m_ticker = new QTimer(this);
+        m_ticker->setInterval(kElapsedTickMs);
+
+        connect(m_proc, &QProcess::readyReadStandardOutput, this, [this] { appendOutput(); });
+        connect(m_proc, &QProcess::finished, this, [this](int code, QProcess::ExitStatus st) {
+            appendOutput();
+            finish(m_cancelled ? tr("cancelled after %1 s").arg(elapsed())
+                   : st == QProcess::NormalExit ? tr("finished in %1 s, exit code %2").arg(elapsed()).arg(code)
+                                                : tr("crashed after %1 s").arg(elapsed()));
+        });
+        connect(m_proc, &QProcess::errorOccurred, this, [this](QProcess::ProcessError e) {
+            if (e == QProcess::FailedToStart) finish(tr("failed to start nohang: %1").arg(m_proc->errorString()));
+        });
+        connect(m_ticker, &QTimer::timeout, this, [this] {
+            m_status->setText(tr("running, %1 s").arg(elapsed()));
+        });
+        connect(buttons, &QDialogButtonBox::rejected, this, [this] {
+            if (m_proc->state() == QProcess::NotRunning) {
+                close();
+                return;
+            }
+            m_cancelled = true;
+            m_proc->kill();
+        });
+
+        m_clock.start();
+        m_status->setText(tr("running, %1 s").arg(elapsed()));
+        m_ticker->start();
+        m_proc->start(QStringLiteral("nohang"), args);
+    }
+
+    ~TasksDialog() override {
+        // Stop listening first, the handlers touch widgets about to go. A
+        // nohang still running is not waited for: killed while stuck in
+        // D-state under thrashing it can take many seconds to exit. The
+        // QProcess outlives the dialog and deletes itself once reaped.
+        m_proc->disconnect(this);
+        if (m_proc->state() != QProcess::NotRunning) {
+            m_proc->setParent(nullptr);
+            connect(m_proc, &QProcess::finished, m_proc, &QObject::deleteLater);
+            m_proc->kill();
+        }
+    }
+
+private:
+    QString elapsed() const { return QString::number(m_clock.elapsed() / 1000.0, 'f', 1); }
+
+    void appendOutput() {
+        const QByteArray chunk = m_proc->readAllStandardOutput();
+        if (chunk.isEmpty()) return;
+        // Keep the view pinned to the end only if the user has not scrolled up
+        QScrollBar* bar = m_edit->verticalScrollBar();
+        const bool atEnd = bar->value() == bar->maximum();
+        QTextCursor c(m_edit->document());
+        c.movePosition(QTextCursor::End);
+        c.insertText(m_decoder.decode(chunk)); // stateful, multi-byte sequences may straddle chunks
+        if (atEnd) bar->setValue(bar->maximum());
+    }
+
+    void finish(const QString& text) {
+        m_ticker->stop();
+        m_status->setText(text);
+        m_cancel->setText(tr("Close"));
+    }
+
+    QTextEdit* m_edit {nullptr};
+    QLabel* m_status {nullptr};
+    QPushButton* m_cancel {nullptr};
+    QProcess* m_proc {nullptr};
+    QTimer* m_ticker {nullptr};
+    QElapsedTimer m_clock;
+    QStringDecoder m_decoder {QStringDecoder::Utf8};
+    bool m_cancelled {false};
+};
+
+// Native process table: scans /proc on the global thread pool and shows the
+// result in a sortable, filterable QTableView. QTableView only creates and
+// paints what is visible, so thousands of rows cost no more than a screenful.
+// While open it refreshes incrementally: the scanner reuses its per-pid cache
+// and the model applies row deltas, so selection and scroll position survive.
+// With PSS enabled each refresh also reads smaps_rollup for as many pids as
+// the budget allows, and an Applications tab sums them per app.
+class ProcessTableDialog final : public QDialog {
+public:
+    ProcessTableDialog(const QString& procRoot, std::chrono::microseconds pssBudget, ProcessTableAction* owner,
+                       QWidget* parent = nullptr)
+        : QDialog(parent), m_scanner(std::make_shared<ProcessScanner>(procRoot)), m_pssBudget(pssBudget) {
+        setAttribute(Qt::WA_DeleteOnClose);
+        setWindowTitle(tr("nohang tasks"));
+
+        m_model = new ProcessTableModel(this);
+        m_proxy = new QSortFilterProxyModel(this);
+        m_proxy->setSourceModel(m_model);
+        m_proxy->setSortRole(ProcessTableModel::SortRole);
+        m_proxy->setFilterKeyColumn(ProcessTableModel::Name);
+        m_proxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
+
+        m_filter = new QLineEdit(this);
+        m_filter->setObjectName(QStringLiteral("tableFilter"));
+        m_filter->setPlaceholderText(tr("Filter by name"));
+        m_filter->setClearButtonEnabled(true);
+        connect(m_filter, &QLineEdit::textChanged, m_proxy, &QSortFilterProxyModel::setFilterFixedString);
+
+        m_view = new QTableView(this);
+        m_view->setObjectName(QStringLiteral("tableView"));
+        m_view->setModel(m_proxy);
+        m_view->setSortingEnabled(true);
+        m_view->sortByColumn(ProcessTableModel::RssMiB, Qt::DescendingOrder);
+        m_view->setSelectionBehavior(QAbstractItemView::SelectRows);
+        m_view->verticalHeader()->hide();
+        // Fixed row heights keep scrolling O(visible rows)
+        m_view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+        m_view->horizontalHeader()->setStretchLastSection(true);
+
+        m_apps = new AppTableModel(this);
+        auto* appProxy = new QSortFilterProxyModel(this);
+        appProxy->setSourceModel(m_apps);
+        appProxy->setSortRole(AppTableModel::SortRole);
+        auto* appView = new QTableView(this);
+        appView->setObjectName(QStringLiteral("appView"));
+        appView->setModel(appProxy);
+        appView->setSortingEnabled(true);
+        appView->sortByColumn(AppTableModel::PssMiB, Qt::DescendingOrder);
+        appView->verticalHeader()->hide();
+        appView->horizontalHeader()->setStretchLastSection(true);
+
+        auto* tabs = new QTabWidget(this);
+        auto* procPage = new QWidget(tabs);
+        auto* procLay = new QVBoxLayout(procPage);
+        procLay->setContentsMargins(0, 0, 0, 0);
+        procLay->addWidget(m_filter);
+        procLay->addWidget(m_view);
+        tabs->addTab(procPage, tr("Processes"));
+        tabs->addTab(appView, tr("Applications"));
+
+        // smaps_rollup is costly, so PSS stays off until asked for
+        m_pss = new QCheckBox(tr("PSS"), this);
+        m_pss->setObjectName(QStringLiteral("tablePss"));
+        m_pss->setToolTip(tr("Read /proc/[pid]/smaps_rollup, %1 ms of CPU per refresh")
+                              .arg(std::chrono::duration_cast<std::chrono::milliseconds>(m_pssBudget).count()));
+        m_pss->setEnabled(m_pssBudget.count() > 0);
+        connect(m_pss, &QCheckBox::toggled, this, [this] { rescan(); });
+
+        m_status = new QLabel(this);
+        m_status->setObjectName(QStringLiteral("tableStatus"));
+        auto* refresh = new QPushButton(tr("Refresh"), this);
+        refresh->setObjectName(QStringLiteral("tableRefresh"));
+        connect(refresh, &QPushButton::clicked, this, [this] { rescan(); });
+        auto* raw = new QPushButton(tr("nohang --tasks…"), this);
+        connect(raw, &QPushButton::clicked, owner, [owner] {
+            QMetaObject::invokeMethod(owner, "runTasks");
+        });
+
+        auto* bottom = new QHBoxLayout;
+        bottom->addWidget(m_status, 1);
+        bottom->addWidget(m_pss);
+        bottom->addWidget(raw);
+        bottom->addWidget(refresh);
+        auto* lay = new QVBoxLayout(this);
+        lay->addWidget(tabs);
+        lay->addLayout(bottom);
+        resize(800, 500);
+
+        auto* timer = new QTimer(this);
+        timer->setInterval(kTableRefreshMs);
+        connect(timer, &QTimer::timeout, this, [this] { rescan(); });
+        timer->start();
+        rescan();
+    }
+
+private:
+    void rescan() {
+        if (m_scanning) return;
+        m_scanning = true;
+        m_status->setText(tr("scanning…"));
+        QPointer<ProcessTableDialog> self(this);
+        // The task holds its own reference, the dialog may close mid-scan
+        std::shared_ptr<ProcessScanner> scanner = m_scanner;
+        const std::chrono::microseconds pssBudget = m_pss->isChecked() ? m_pssBudget : std::chrono::microseconds{};
+        QThreadPool::globalInstance()->start([self, scanner, pssBudget] {
+            QElapsedTimer t;
+            t.start();
+            ProcessDelta delta = scanner->update(pssBudget);
+            QVector<AppUsage> apps = ProcessScanner::groupByApp(scanner->cached());
+            const qint64 ms = t.elapsed();
+            // The dialog may be gone by now, QPointer is checked on the GUI thread
+            QMetaObject::invokeMethod(qApp, [self, delta = std::move(delta), apps = std::move(apps), ms]() mutable {
+                if (self) self->showDelta(delta, std::move(apps), ms);
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    void showDelta(const ProcessDelta& delta, QVector<AppUsage> apps, qint64 ms) {
+        m_scanning = false;
+        m_model->applyDelta(delta);
+        m_apps->setApps(std::move(apps));
+        m_status->setText(tr("%1 processes, scanned in %2 ms (+%3 -%4 ~%5)")
+                              .arg(m_model->rowCount())
+                              .arg(ms)
+                              .arg(delta.added.size())
+                              .arg(delta.removed.size())
+                              .arg(delta.changed.size()));
+    }
+
+    std::shared_ptr<ProcessScanner> m_scanner;
+    std::chrono::microseconds m_pssBudget;
+    ProcessTableModel* m_model {nullptr};
+    AppTableModel* m_apps {nullptr};
+    QCheckBox* m_pss {nullptr};
+    QSortFilterProxyModel* m_proxy {nullptr};
+    QLineEdit* m_filter {nullptr};
+    QTableView* m_view {nullptr};
+    QLabel* m_status {nullptr};
+    bool m_scanning {false};
+};
+
+} // namespace
 
 ProcessTableAction::ProcessTableAction(QObject* parent) : QObject(parent) {}
 
 QAction* ProcessTableAction::makeAction(QWidget* parentWidget, const QString& configPath) {
     m_cfgPath = configPath;
     auto act = new QAction(tr("Show nohang tasks"), parentWidget);
-    connect(act, &QAction::triggered, this, &ProcessTableAction::runTasks);
+    connect(act, &QAction::triggered, this, &ProcessTableAction::showTable);
     return act;
 }
 
+void ProcessTableAction::showTable() {
+    auto* dlg = new ProcessTableDialog(m_procRoot, m_pssBudget, this);
+    dlg->show();
+}
+
 void ProcessTableAction::runTasks() {
     // This is a simple viewer, no privilege escalation. Users can adjust later.
-    QProcess p;
     QStringList args{QStringLiteral("--tasks")};
     if (!m_cfgPath.isEmpty()) {
         args << QStringLiteral("-c") << m_cfgPath;
     }
-    p.start(QStringLiteral("nohang"), args);
-    p.waitForFinished(3000);
-
-    auto dlg = new QDialog();
-    dlg->setAttribute(Qt::WA_DeleteOnClose);
-    dlg->setWindowTitle(QStringLiteral("nohang --tasks"));
-    auto* edit = new QTextEdit(dlg);
-    edit->setReadOnly(true);
-    edit->setPlainText(QString::fromUtf8(p.readAllStandardOutput()));
-    auto* lay = new QVBoxLayout(dlg);
-    lay->addWidget(edit);
-    dlg->resize(800, 500);
+    auto* dlg = new TasksDialog(args);
     dlg->show();
 }
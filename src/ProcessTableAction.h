@@ -1,21 +1,34 @@
 // ===== src/ProcessTableAction.h =====
 #pragma once
 #include <QObject>
+#include <QString>
+#include <chrono>
 
 class QAction;
 class QWidget;
 
-// Optional helper that adds an action to open `nohang --tasks` output.
-// In the skeleton we expose a factory method, the TrayApp can add it to the SNI menu later.
+// Optional helper that adds an action to show the process table.
+// The table is read natively from /proc by ProcessScanner on a worker
+// thread and shown in a sortable, filterable view. The raw
+// `nohang --tasks` output stays one click away: that dialog opens at once
+// and streams output while nohang runs, with an elapsed-time indicator and
+// a cancel button.
 class ProcessTableAction : public QObject {
     Q_OBJECT
 public:
     explicit ProcessTableAction(QObject* parent = nullptr);
     QAction* makeAction(QWidget* parentWidget, const QString& configPath);
 
+    void setProcRoot(const QString& procRoot) { m_procRoot = procRoot; }
+    // CPU time per table refresh for smaps_rollup reads; zero disables PSS
+    void setPssBudget(std::chrono::milliseconds budget) { m_pssBudget = budget; }
+
 private slots:
+    void showTable();
     void runTasks();
 
 private:
     QString m_cfgPath;
+    QString m_procRoot {QStringLiteral("/proc")};
+    std::chrono::milliseconds m_pssBudget {20};
 };
@@ -0,0 +1,211 @@
+// ===== src/ProcessTableModel.cpp =====
+#include "pch.h"
+#include "ProcessTableModel.h"
+#include <algorithm>
+#include <pwd.h>
+
+ProcessTableModel::ProcessTableModel(QObject* parent) : QAbstractTableModel(parent) {}
+
+void ProcessTableModel::setProcesses(QVector<ProcessInfo> rows) {
+    beginResetModel();
+    m_rows = std::move(rows);
+    endResetModel();
+}
+
+qsizetype ProcessTableModel::rowOf(int pid) const {
+    const auto it = std::lower_bound(m_rows.cbegin(), m_rows.cend(), pid,
+                                     [](const ProcessInfo& p, int v) { return p.pid < v; });
+    return it - m_rows.cbegin();
+}
+
+void ProcessTableModel::applyDelta(const ProcessDelta& delta) {
+    // Removals first so a reused pid is taken out before its new row goes in.
+    // Neighbouring pids are grouped into one begin/end pair each.
+    for (qsizetype i = 0; i < delta.removed.size();) {
+        const qsizetype first = rowOf(delta.removed[i]);
+        qsizetype last = first;
+        for (; i < delta.removed.size() && last < m_rows.size() && m_rows[last].pid == delta.removed[i]; ++i) ++last;
+        if (last == first) {
+            ++i; // not in the model, nothing to remove
+            continue;
+        }
+        beginRemoveRows({}, static_cast<int>(first), static_cast<int>(last - 1));
+        m_rows.remove(first, last - first);
+        endRemoveRows();
+    }
+
+    for (qsizetype i = 0; i < delta.added.size();) {
+        const qsizetype at = rowOf(delta.added[i].pid);
+        // Everything that sorts before the row now at `at` goes in as one run
+        qsizetype end = i + 1;
+        while (end < delta.added.size() && (at >= m_rows.size() || delta.added[end].pid < m_rows[at].pid)) ++end;
+        beginInsertRows({}, static_cast<int>(at), static_cast<int>(at + end - i - 1));
+        m_rows.insert(at, end - i, ProcessInfo{});
+        std::copy(delta.added.cbegin() + i, delta.added.cbegin() + end, m_rows.begin() + at);
+        endInsertRows();
+        i = end;
+    }
+
+    for (const ProcessInfo& p : delta.changed) {
+        const qsizetype row = rowOf(p.pid);
+        if (row >= m_rows.size() || m_rows[row].pid != p.pid) continue;
+        m_rows[row] = p;
+        emit dataChanged(index(static_cast<int>(row), 0), index(static_cast<int>(row), ColumnCount - 1));
+    }
+}
+
+int ProcessTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+int ProcessTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+static QString mib(qint64 kib) { return QString::number(kib / 1024.0, 'f', 1); }
+
+static QString age(const PssInfo& pss) {
+    return QString::number((ProcessScanner::nowMs() - pss.sampledAtMs) / 1000.0, 'f', 0);
+}
+
+static QString userName(uint uid) {
+    // Resolved lazily, only for rows the view paints
+    if (const passwd* pw = getpwuid(uid)) return QString::fromLocal8Bit(pw->pw_name);
+    return QString::number(uid);
+}
+
+QVariant ProcessTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_rows.size()) return {};
+    const ProcessInfo& p = m_rows[index.row()];
+
+    if (role == SortRole) {
+        switch (index.column()) {
+        case Pid: return p.pid;
+        case Name: return p.name;
+        case User: return p.uid;
+        case State: return QString(QLatin1Char(p.state));
+        case RssMiB: return p.rssKiB;
+        case SwapMiB: return p.swapKiB;
+        case OomScore: return p.oomScore;
+        case OomScoreAdj: return p.oomScoreAdj;
+        case PssMiB: return p.pss.valid() ? p.pss.pssKiB : -1;
+        case SwapPssMiB: return p.pss.valid() ? p.pss.swapPssKiB : -1;
+        case Command: return p.cmdline;
+        }
+        return {};
+    }
+    if (role == Qt::TextAlignmentRole) {
+        const bool text = index.column() == Name || index.column() == User || index.column() == Command;
+        return QVariant::fromValue(Qt::Alignment(text ? Qt::AlignLeft : Qt::AlignRight) | Qt::AlignVCenter);
+    }
+    if (role == Qt::ToolTipRole) {
+        if ((index.column() == PssMiB || index.column() == SwapPssMiB) && p.pss.valid())
+            return tr("anon %1 MiB, shmem %2 MiB, read %3 s ago")
+                .arg(mib(p.pss.pssAnonKiB), mib(p.pss.pssShmemKiB), age(p.pss));
+        return p.cgroup.isEmpty() ? QVariant() : QVariant(p.cgroup);
+    }
+    if (role != Qt::DisplayRole) return {};
+
+    switch (index.column()) {
+    case Pid: return p.pid;
+    case Name: return p.name;
+    case User: return userName(p.uid);
+    case State: return QString(QLatin1Char(p.state));
+    case RssMiB: return mib(p.rssKiB);
+    case SwapMiB: return mib(p.swapKiB);
+    case OomScore: return p.oomScore;
+    case OomScoreAdj: return p.oomScoreAdj;
+    case PssMiB: return p.pss.valid() ? mib(p.pss.pssKiB) : QString();
+    case SwapPssMiB: return p.pss.valid() ? mib(p.pss.swapPssKiB) : QString();
+    case Command: return p.cmdline.isEmpty() ? QLatin1Char('[') + p.name + QLatin1Char(']') : p.cmdline;
+    }
+    return {};
+}
+
+QVariant ProcessTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return {};
+    switch (section) {
+    case Pid: return tr("PID");
+    case Name: return tr("Name");
+    case User: return tr("User");
+    case State: return tr("State");
+    case RssMiB: return tr("RSS MiB");
+    case SwapMiB: return tr("Swap MiB");
+    case OomScore: return tr("oom_score");
+    case OomScoreAdj: return tr("oom_score_adj");
+    case PssMiB: return tr("PSS MiB");
+    case SwapPssMiB: return tr("SwapPss MiB");
+    case Command: return tr("Command");
+    }
+    return {};
+}
+
+AppTableModel::AppTableModel(QObject* parent) : QAbstractTableModel(parent) {}
+
+void AppTableModel::setApps(QVector<AppUsage> apps) {
+    beginResetModel();
+    m_apps = std::move(apps);
+    endResetModel();
+}
+
+int AppTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_apps.size());
+}
+
+int AppTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant AppTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_apps.size()) return {};
+    const AppUsage& a = m_apps[index.row()];
+    const bool pss = a.pss.valid();
+
+    if (role == SortRole) {
+        switch (index.column()) {
+        case App: return a.label;
+        case Processes: return a.processes;
+        case PssMiB: return pss ? a.pss.pssKiB : -1;
+        case PssAnonMiB: return pss ? a.pss.pssAnonKiB : -1;
+        case PssShmemMiB: return pss ? a.pss.pssShmemKiB : -1;
+        case SwapPssMiB: return pss ? a.pss.swapPssKiB : -1;
+        case RssMiB: return a.rssKiB;
+        case AgeSeconds: return pss ? ProcessScanner::nowMs() - a.pss.sampledAtMs : -1;
+        }
+        return {};
+    }
+    if (role == Qt::TextAlignmentRole)
+        return QVariant::fromValue(Qt::Alignment(index.column() == App ? Qt::AlignLeft : Qt::AlignRight) | Qt::AlignVCenter);
+    if (role == Qt::ToolTipRole) {
+        if (a.pssMissing > 0) return tr("%1 (PSS missing for %2 of %3 processes)").arg(a.key).arg(a.pssMissing).arg(a.processes);
+        return a.key;
+    }
+    if (role != Qt::DisplayRole) return {};
+
+    switch (index.column()) {
+    case App: return a.label;
+    case Processes: return a.processes;
+    case PssMiB: return pss ? mib(a.pss.pssKiB) : QString();
+    case PssAnonMiB: return pss ? mib(a.pss.pssAnonKiB) : QString();
+    case PssShmemMiB: return pss ? mib(a.pss.pssShmemKiB) : QString();
+    case SwapPssMiB: return pss ? mib(a.pss.swapPssKiB) : QString();
+    case RssMiB: return mib(a.rssKiB);
+    case AgeSeconds: return pss ? age(a.pss) : QString();
+    }
+    return {};
+}
+
+QVariant AppTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return {};
+    switch (section) {
+    case App: return tr("Application");
+    case Processes: return tr("Processes");
+    case PssMiB: return tr("PSS MiB");
+    case PssAnonMiB: return tr("Anon MiB");
+    case PssShmemMiB: return tr("Shmem MiB");
+    case SwapPssMiB: return tr("SwapPss MiB");
+    case RssMiB: return tr("RSS MiB");
+    case AgeSeconds: return tr("Oldest read, s");
+    }
+    return {};
+}
@@ -0,0 +1,53 @@
+// ===== src/ProcessTableModel.h =====
+#pragma once
+#include "ProcessScanner.h"
+#include <QAbstractTableModel>
+
+// Table model over a ProcessScanner result. Display data is formatted on
+// demand, so the view only pays for the rows it actually paints. Rows are
+// kept sorted by pid so applyDelta() can locate them by binary search and
+// emit row-level signals instead of resetting the view.
+class ProcessTableModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column { Pid = 0, Name, User, State, RssMiB, SwapMiB, OomScore, OomScoreAdj, PssMiB, SwapPssMiB, Command, ColumnCount };
+    static constexpr int SortRole = Qt::UserRole; // raw numbers for sorting
+
+    explicit ProcessTableModel(QObject* parent = nullptr);
+
+    void setProcesses(QVector<ProcessInfo> rows);  // rows sorted by pid
+    void applyDelta(const ProcessDelta& delta);
+    const QVector<ProcessInfo>& processes() const { return m_rows; }
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+    int columnCount(const QModelIndex& parent = {}) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    qsizetype rowOf(int pid) const;               // lower bound by pid
+
+    QVector<ProcessInfo> m_rows;
+};
+
+// Per-application totals from ProcessScanner::groupByApp(). The list is
+// short, so it is simply replaced on every refresh.
+class AppTableModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column { App = 0, Processes, PssMiB, PssAnonMiB, PssShmemMiB, SwapPssMiB, RssMiB, AgeSeconds, ColumnCount };
+    static constexpr int SortRole = ProcessTableModel::SortRole;
+
+    explicit AppTableModel(QObject* parent = nullptr);
+
+    void setApps(QVector<AppUsage> apps);
+    const QVector<AppUsage>& apps() const { return m_apps; }
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+    int columnCount(const QModelIndex& parent = {}) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    QVector<AppUsage> m_apps;
+};
@@ -0,0 +1,413 @@
+// ===== src/PrometheusExporter.cpp =====
+#include "pch.h"
+#include "PrometheusExporter.h"
+#include "SystemSnapshot.h"
+#include "Thresholds.h"
+#include "UnixSocket.h"
+#include <QFile>
+#include <QSocketNotifier>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <utility>
+
+static constexpr double kMiB = 1024.0 * 1024.0;
+
+PrometheusExporter::PrometheusExporter(QObject* parent) : QObject(parent) {}
+
+PrometheusExporter::~PrometheusExporter() { close(); }
+
+namespace {
+
+// One socket address of any family the exporter listens on
+struct Address {
+    sockaddr_storage storage {};
+    socklen_t length {0};
+    QByteArray unixPath;
+};
+
+bool parseAddress(const QString& spec, Address* out) {
+    if (spec.startsWith(QLatin1Char('/'))) {
+        const QByteArray path = QFile::encodeName(spec);
+        auto* un = reinterpret_cast<sockaddr_un*>(&out->storage);
+        if (static_cast<size_t>(path.size()) >= sizeof(un->sun_path)) return false;
+        un->sun_family = AF_UNIX;
+        std::memcpy(un->sun_path, path.constData(), static_cast<size_t>(path.size()));
+        out->length = sizeof(sockaddr_un);
+        out->unixPath = path;
+        return true;
+    }
+    // "port", "host:port" or "[v6]:port"
+    QString host = QStringLiteral("127.0.0.1");
+    QString port = spec;
+    const qsizetype colon = spec.lastIndexOf(QLatin1Char(':'));
+    if (colon >= 0) {
+        host = spec.left(colon);
+        port = spec.mid(colon + 1);
+        if (host.startsWith(QLatin1Char('[')) && host.endsWith(QLatin1Char(']'))) host = host.mid(1, host.size() - 2);
+    }
+    bool ok = false;
+    const uint p = port.toUInt(&ok);
+    if (!ok || p > 65535) return false;
+    const QByteArray h = host.toLatin1();
+    auto* v4 = reinterpret_cast<sockaddr_in*>(&out->storage);
+    if (::inet_pton(AF_INET, h.constData(), &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(static_cast<quint16>(p));
+        out->length = sizeof(sockaddr_in);
+        return true;
+    }
+    auto* v6 = reinterpret_cast<sockaddr_in6*>(&out->storage);
+    if (::inet_pton(AF_INET6, h.constData(), &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons(static_cast<quint16>(p));
+        out->length = sizeof(sockaddr_in6);
+        return true;
+    }
+    return false;
+}
+
+// Appends the text format to a buffer without temporary strings
+struct Writer {
+    QByteArray& out;
+
+    void family(const char* name, const char* type, const char* help) {
+        out.append("# HELP ").append(name).append(' ').append(help).append('\n');
+        out.append("# TYPE ").append(name).append(' ').append(type).append('\n');
+    }
+    void sample(const char* name, double v) { sample(name, {}, v); }
+    void sample(const char* name, std::initializer_list<std::pair<const char*, QByteArrayView>> labels, double v) {
+        out.append(name);
+        if (labels.size() > 0) {
+            char sep = '{';
+            for (const auto& [key, value] : labels) {
+                out.append(sep).append(key).append("=\"").append(value).append('"');
+                sep = ',';
+            }
+            out.append('}');
+        }
+        out.append(' ');
+        if (!std::isfinite(v)) {
+            out.append("NaN\n"); // e.g. a ratio of a zero total
+            return;
+        }
+        char buf[32];
+        const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+        out.append(buf, r.ptr - buf).append('\n');
+    }
+};
+
+constexpr const char* kLevelLabels[] = {"normal", "warn", "soft", "hard"};
+
+QByteArrayView metricLabel(SeverityMetric m) {
+    switch (m) {
+    case SeverityMetric::Mem: return "mem";
+    case SeverityMetric::Node: return "numa_node";
+    case SeverityMetric::Swap: return "swap";
+    case SeverityMetric::SwapSpill: return "swap_spill";
+    case SeverityMetric::Zram: return "zram";
+    case SeverityMetric::Zswap: return "zswap";
+    case SeverityMetric::Psi: return "psi";
+    case SeverityMetric::SwapIn: return "swap_in";
+    case SeverityMetric::Refault: return "refault";
+    case SeverityMetric::Events: return "memory_events";
+    case SeverityMetric::Count: break;
+    }
+    return {};
+}
+
+quint64 totalTransitions(const SeverityEngine& s) {
+    quint64 n = 0;
+    for (int l = 0; l < 4; ++l) n += s.transitions(static_cast<Severity>(l));
+    return n;
+}
+
+} // namespace
+
+bool PrometheusExporter::listen(const QString& address, QString* error) {
+    close();
+    auto fail = [&](const QString& what) {
+        if (error) *error = what + QStringLiteral(": ") + qt_error_string(errno);
+        close();
+        return false;
+    };
+    Address addr;
+    if (!parseAddress(address, &addr)) {
+        errno = EINVAL;
+        return fail(address);
+    }
+    const int family = addr.storage.ss_family;
+    // Replace a stale socket, never a live server or another file
+    if (family == AF_UNIX && !UnixSocket::removeStale(addr.unixPath)) return fail(address);
+
+    m_listenFd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_listenFd < 0) return fail(QStringLiteral("socket"));
+    if (family != AF_UNIX) {
+        const int one = 1;
+        ::setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    }
+    if (::bind(m_listenFd, reinterpret_cast<sockaddr*>(&addr.storage), addr.length) < 0) return fail(address);
+    if (::listen(m_listenFd, 16) < 0) return fail(QStringLiteral("listen"));
+    m_unixPath = family == AF_UNIX ? address : QString();
+    m_acceptNotifier = new QSocketNotifier(m_listenFd, QSocketNotifier::Read, this);
+    connect(m_acceptNotifier, &QSocketNotifier::activated, this, &PrometheusExporter::onAccept);
+    return true;
+}
+
+void PrometheusExporter::close() {
+    for (Client& c : m_clients) {
+        delete c.readNotifier;
+        delete c.writeNotifier;
+        ::close(c.fd);
+    }
+    m_clients.clear();
+    delete m_acceptNotifier;
+    m_acceptNotifier = nullptr;
+    if (m_listenFd >= 0) {
+        ::close(m_listenFd);
+        m_listenFd = -1;
+        if (!m_unixPath.isEmpty()) ::unlink(QFile::encodeName(m_unixPath).constData());
+    }
+    m_unixPath.clear();
+}
+
+int PrometheusExporter::port() const {
+    sockaddr_storage ss {};
+    socklen_t len = sizeof(ss);
+    if (m_listenFd < 0 || ::getsockname(m_listenFd, reinterpret_cast<sockaddr*>(&ss), &len) < 0) return 0;
+    if (ss.ss_family == AF_INET) return ntohs(reinterpret_cast<sockaddr_in*>(&ss)->sin_port);
+    if (ss.ss_family == AF_INET6) return ntohs(reinterpret_cast<sockaddr_in6*>(&ss)->sin6_port);
+    return 0;
+}
+
+void PrometheusExporter::update(const SnapshotData& d, const ThresholdSet& th, const SeverityEngine& severity, bool active) {
+    // The render timer fires whether or not the sampler produced anything new
+    const quint64 transitions = totalTransitions(severity);
+    if (d.sampledAtMs == m_renderedAtMs && severity.level() == m_renderedLevel &&
+        transitions == m_renderedTransitions && active == m_renderedActive)
+        return;
+    m_renderedAtMs = d.sampledAtMs;
+    m_renderedLevel = severity.level();
+    m_renderedTransitions = transitions;
+    m_renderedActive = active;
+    render(d, th, severity, active);
+}
+
+void PrometheusExporter::render(const SnapshotData& d, const ThresholdSet& th, const SeverityEngine& severity, bool active) {
+    // resize keeps the capacity, so after the first render this allocates
+    // nothing unless a scrape in flight still shares the old page
+    m_page.resize(0);
+    Writer w {m_page};
+
+    w.family("nohang_tray_daemon_active", "gauge", "1 while the nohang service is running.");
+    w.sample("nohang_tray_daemon_active", active ? 1 : 0);
+    w.family("nohang_tray_severity", "gauge", "Overall tray level: 0 normal, 1 warn, 2 soft, 3 hard.");
+    w.sample("nohang_tray_severity", static_cast<int>(severity.level()));
+    w.family("nohang_tray_metric_severity", "gauge", "Level of each input the severity engine tracks.");
+    for (int m = 0; m < static_cast<int>(SeverityMetric::Count); ++m)
+        w.sample("nohang_tray_metric_severity", {{"metric", metricLabel(static_cast<SeverityMetric>(m))}},
+                 static_cast<int>(severity.level(static_cast<SeverityMetric>(m))));
+    w.family("nohang_tray_severity_transitions_total", "counter", "Changes of the overall level, by level entered.");
+    for (int l = 0; l < 4; ++l)
+        w.sample("nohang_tray_severity_transitions_total", {{"to", kLevelLabels[l]}},
+                 static_cast<double>(severity.transitions(static_cast<Severity>(l))));
+
+    // Effective totals, capped by the limit cgroup when there is one
+    const MemInfo& mem = d.mem;
+    w.family("nohang_tray_memory_total_bytes", "gauge", "RAM total nohang judges against.");
+    w.sample("nohang_tray_memory_total_bytes", mem.memTotalMiB * kMiB);
+    w.family("nohang_tray_memory_available_bytes", "gauge", "RAM available, MemAvailable or the cgroup headroom.");
+    w.sample("nohang_tray_memory_available_bytes", mem.memAvailableMiB * kMiB);
+    w.family("nohang_tray_memory_available_ratio", "gauge", "RAM available as a share of the total.");
+    w.sample("nohang_tray_memory_available_ratio", mem.memAvailablePercent / 100);
+    w.family("nohang_tray_swap_total_bytes", "gauge", "Swap total nohang judges against.");
+    w.sample("nohang_tray_swap_total_bytes", mem.swapTotalMiB * kMiB);
+    w.family("nohang_tray_swap_free_bytes", "gauge", "Swap free.");
+    w.sample("nohang_tray_swap_free_bytes", mem.swapFreeMiB * kMiB);
+    w.family("nohang_tray_swap_free_ratio", "gauge", "Swap free as a share of the total.");
+    w.sample("nohang_tray_swap_free_ratio", mem.swapFreePercent / 100);
+
+    const MemInfo& host = d.hostMem;
+    w.family("nohang_tray_meminfo_bytes", "gauge", "Host /proc/meminfo fields the tray reads.");
+    for (const MeminfoTable::Entry& e : MeminfoTable::kEntries)
+        if (host.has(e.field))
+            w.sample("nohang_tray_meminfo_bytes", {{"field", QByteArrayView(e.key.data(), e.key.size())}},
+                     host.kib(e.field) * 1024);
+
+    const ZramInfo& z = d.zram;
+    w.family("nohang_tray_zram_present", "gauge", "1 when a zram device is set up.");
+    w.sample("nohang_tray_zram_present", z.present ? 1 : 0);
+    if (z.present) {
+        w.family("nohang_tray_zram_disksize_bytes", "gauge", "zram logical capacity.");
+        w.sample("nohang_tray_zram_disksize_bytes", z.diskSizeMiB * kMiB);
+        w.family("nohang_tray_zram_orig_data_bytes", "gauge", "Uncompressed size of the data stored in zram.");
+        w.sample("nohang_tray_zram_orig_data_bytes", z.origDataMiB * kMiB);
+        w.family("nohang_tray_zram_compr_data_bytes", "gauge", "Compressed size of the data stored in zram.");
+        w.sample("nohang_tray_zram_compr_data_bytes", z.comprDataMiB * kMiB);
+        w.family("nohang_tray_zram_mem_used_total_bytes", "gauge", "RAM zram uses, including its own overhead.");
+        w.sample("nohang_tray_zram_mem_used_total_bytes", z.memUsedTotalMiB * kMiB);
+        w.family("nohang_tray_zram_logical_used_ratio", "gauge", "Uncompressed data as a share of the capacity.");
+        w.sample("nohang_tray_zram_logical_used_ratio", z.logicalUsedPercent / 100);
+    }
+
+    w.family("nohang_tray_pressure_memory_avg10_ratio", "gauge", "Memory PSI over the last 10 s.");
+    w.sample("nohang_tray_pressure_memory_avg10_ratio", {{"kind", "some"}}, d.psi.some_avg10 / 100);
+    w.sample("nohang_tray_pressure_memory_avg10_ratio", {{"kind", "full"}}, d.psi.full_avg10 / 100);
+
+    // Only what the configuration sets; an absent series means no threshold
+    const struct {
+        const char* level;
+        const ThresholdValue* mem;
+        const ThresholdValue* swap;
+        const ThresholdValue* zram;
+        const std::optional<double>* psi;
+    } levels[] = {
+        {"warn", &th.warn_mem_free, &th.warn_swap_free, &th.warn_zram_used, &th.warn_psi},
+        {"soft", &th.soft_mem_free, &th.soft_swap_free, &th.soft_zram_used, &th.soft_psi},
+        {"hard", &th.hard_mem_free, &th.hard_swap_free, &th.hard_zram_used, &th.hard_psi},
+    };
+    w.family("nohang_tray_threshold_bytes", "gauge", "nohang thresholds computed against the current totals.");
+    for (const auto& l : levels) {
+        if (l.mem->mib) w.sample("nohang_tray_threshold_bytes", {{"resource", "mem_free"}, {"level", l.level}}, *l.mem->mib * kMiB);
+        if (l.swap->mib) w.sample("nohang_tray_threshold_bytes", {{"resource", "swap_free"}, {"level", l.level}}, *l.swap->mib * kMiB);
+        if (l.zram->mib) w.sample("nohang_tray_threshold_bytes", {{"resource", "zram_used"}, {"level", l.level}}, *l.zram->mib * kMiB);
+    }
+    w.family("nohang_tray_threshold_psi_ratio", "gauge", "nohang PSI thresholds, compared with psi_metrics.");
+    for (const auto& l : levels)
+        if (*l.psi) w.sample("nohang_tray_threshold_psi_ratio", {{"level", l.level}}, **l.psi / 100);
+    if (th.psi_duration) {
+        w.family("nohang_tray_threshold_psi_duration_seconds", "gauge", "nohang psi_excess_duration.");
+        w.sample("nohang_tray_threshold_psi_duration_seconds", *th.psi_duration);
+    }
+    ++m_renders;
+}
+
+PrometheusExporter::Client* PrometheusExporter::find(int fd) {
+    const auto it = std::find_if(m_clients.begin(), m_clients.end(), [fd](const Client& c) { return c.fd == fd; });
+    return it == m_clients.end() ? nullptr : &*it;
+}
+
+void PrometheusExporter::onAccept() {
+    for (;;) {
+        const int fd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        // A scraper that connects and never asks must not lock others out
+        if (m_clients.size() >= static_cast<size_t>(kMaxClients)) dropClient(m_clients.front().fd);
+        Client c;
+        c.fd = fd;
+        c.readNotifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(c.readNotifier, &QSocketNotifier::activated, this, [this, fd] { onReadable(fd); });
+        m_clients.push_back(std::move(c));
+    }
+}
+
+void PrometheusExporter::onReadable(int fd) {
+    Client* c = find(fd);
+    if (!c) return;
+    char buf[1024];
+    for (;;) {
+        const ssize_t n = ::recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            dropClient(fd);
+            return;
+        }
+        if (n < 0) return; // wait for the rest of the headers
+        c->request.append(buf, n);
+        if (c->request.contains("\r\n\r\n") || c->request.contains("\n\n")) {
+            respond(*c);
+            return;
+        }
+        if (c->request.size() > kMaxRequestBytes) {
+            dropClient(fd);
+            return;
+        }
+    }
+}
+
+void PrometheusExporter::respond(Client& c) {
+    c.readNotifier->setEnabled(false);
+    const QByteArrayView line = QByteArrayView(c.request).first(c.request.indexOf('\n'));
+    const bool get = line.startsWith("GET ") || line.startsWith("HEAD ");
+    QByteArrayView target = line.sliced(line.indexOf(' ') + 1);
+    target = target.first(std::max<qsizetype>(0, target.indexOf(' ')));
+    if (const qsizetype q = target.indexOf('?'); q >= 0) target = target.first(q);
+
+    const char* status = "200 OK";
+    const char* type = "text/plain; version=0.0.4; charset=utf-8";
+    if (!get) {
+        status = "405 Method Not Allowed";
+        c.body = "only GET\n";
+    } else if (target == "/metrics") {
+        c.body = m_page; // implicitly shared, no copy
+        ++m_scrapes;
+    } else if (target == "/") {
+        type = "text/html; charset=utf-8";
+        c.body = "<html><body><a href=\"/metrics\">metrics</a></body></html>\n";
+    } else {
+        status = "404 Not Found";
+        c.body = "not found\n";
+    }
+    c.head = QByteArray("HTTP/1.1 ") + status + "\r\nContent-Type: " + type +
+             "\r\nContent-Length: " + QByteArray::number(c.body.size()) + "\r\nConnection: close\r\n\r\n";
+    if (line.startsWith("HEAD ")) c.body.clear();
+    c.request.clear();
+    c.sent = 0;
+    if (flush(c)) {
+        dropClient(c.fd);
+        return;
+    }
+    // The rest goes out as the client reads
+    if (!c.writeNotifier) {
+        const int fd = c.fd;
+        c.writeNotifier = new QSocketNotifier(fd, QSocketNotifier::Write, this);
+        connect(c.writeNotifier, &QSocketNotifier::activated, this, [this, fd] { onWritable(fd); });
+    }
+}
+
+void PrometheusExporter::onWritable(int fd) {
+    Client* c = find(fd);
+    if (c && flush(*c)) dropClient(fd);
+}
+
+bool PrometheusExporter::flush(Client& c) {
+    const qsizetype total = c.head.size() + c.body.size();
+    while (c.sent < total) {
+        // Headers and body in one segment list, neither is copied together
+        iovec iov[2];
+        int count = 0;
+        if (c.sent < c.head.size())
+            iov[count++] = {c.head.data() + c.sent, static_cast<size_t>(c.head.size() - c.sent)};
+        const qsizetype bodyAt = std::max<qsizetype>(0, c.sent - c.head.size());
+        if (bodyAt < c.body.size())
+            iov[count++] = {const_cast<char*>(c.body.constData()) + bodyAt, static_cast<size_t>(c.body.size() - bodyAt)};
+        msghdr msg {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        const ssize_t n = ::sendmsg(c.fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) return errno != EAGAIN && errno != EWOULDBLOCK; // gone counts as done
+        c.sent += n;
+    }
+    return true;
+}
+
+void PrometheusExporter::dropClient(int fd) {
+    const auto it = std::find_if(m_clients.begin(), m_clients.end(), [fd](const Client& c) { return c.fd == fd; });
+    if (it == m_clients.end()) return;
+    // May run inside one of the client's own notifier signals
+    for (QSocketNotifier* n : {it->readNotifier, it->writeNotifier}) {
+        if (!n) continue;
+        n->setEnabled(false);
+        n->deleteLater();
+    }
+    ::close(it->fd);
+    m_clients.erase(it);
+}
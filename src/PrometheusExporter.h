@@ -0,0 +1,79 @@
+// ===== src/PrometheusExporter.h =====
+#pragma once
+#include "SeverityEngine.h"
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <vector>
+
+class QSocketNotifier;
+struct SnapshotData;
+struct ThresholdSet;
+
+// PrometheusExporter serves GET /metrics in the Prometheus text format:
+// every MemInfo, ZramInfo and PsiInfo value, nohang's thresholds as
+// computed against the live totals, and the tray's severity with its
+// transition counters. node_exporter has the raw numbers but not what
+// nohang makes of them.
+//
+// update() renders the page into one reused buffer, and only when the
+// sample or the severity changed; a scrape just sends that buffer. The
+// HTTP side is a minimal non-blocking handler on the GUI thread's event
+// loop: one request per connection, no keep-alive, nothing that waits.
+class PrometheusExporter : public QObject {
+    Q_OBJECT
+public:
+    explicit PrometheusExporter(QObject* parent = nullptr);
+    ~PrometheusExporter() override;
+
+    // "[host:]port" for TCP, host defaulting to 127.0.0.1 ("[::1]:port"
+    // for IPv6), or an absolute path for a Unix stream socket. Port 0
+    // picks a free one, see port().
+    bool listen(const QString& address, QString* error = nullptr);
+    void close();
+    bool isListening() const { return m_listenFd >= 0; }
+    int port() const;                                // TCP port bound, 0 for a Unix socket
+
+    void update(const SnapshotData& d, const ThresholdSet& th, const SeverityEngine& severity, bool active);
+    const QByteArray& page() const { return m_page; }
+
+    int clientCount() const { return static_cast<int>(m_clients.size()); }
+    quint64 renders() const { return m_renders; }
+    quint64 scrapes() const { return m_scrapes; }
+
+    static constexpr int kMaxClients = 16;           // the oldest is closed to make room
+    static constexpr int kMaxRequestBytes = 8192;
+
+private:
+    struct Client {
+        int fd {-1};
+        QSocketNotifier* readNotifier {nullptr};
+        QSocketNotifier* writeNotifier {nullptr};
+        QByteArray request;
+        QByteArray head;                             // status line and headers
+        QByteArray body;                             // shares m_page until it is re-rendered
+        qsizetype sent {0};                          // of head + body
+    };
+
+    void render(const SnapshotData& d, const ThresholdSet& th, const SeverityEngine& severity, bool active);
+    void onAccept();
+    void onReadable(int fd);
+    void onWritable(int fd);
+    void respond(Client& c);
+    bool flush(Client& c);                           // true once everything was sent
+    void dropClient(int fd);
+    Client* find(int fd);
+
+    QString m_unixPath;
+    int m_listenFd {-1};
+    QSocketNotifier* m_acceptNotifier {nullptr};
+    std::vector<Client> m_clients;
+
+    QByteArray m_page;
+    qint64 m_renderedAtMs {-1};
+    Severity m_renderedLevel {Severity::Normal};
+    quint64 m_renderedTransitions {0};
+    bool m_renderedActive {false};
+    quint64 m_renders {0};
+    quint64 m_scrapes {0};
+};
@@ -0,0 +1,89 @@
+// ===== src/SampleHistory.cpp =====
+#include "pch.h"
+#include "SampleHistory.h"
+#include "SystemSnapshot.h"
+#include <algorithm>
+
+SampleHistory::SampleHistory(int capacity, qint64 intervalMs)
+    : m_capacity(std::max(1, capacity)), m_intervalMs(std::max<qint64>(1, intervalMs)) {}
+
+SampleHistory::Values SampleHistory::valuesOf(const SnapshotData& d) {
+    return {static_cast<float>(d.mem.memAvailableMiB), static_cast<float>(d.mem.swapFreeMiB),
+            static_cast<float>(d.zram.origDataMiB), static_cast<float>(d.psi.some_avg10),
+            static_cast<float>(d.psi.full_avg10)};
+}
+
+bool SampleHistory::append(const SnapshotData& d, Severity level) {
+    return append(d.sampledAtMs, valuesOf(d), level);
+}
+
+bool SampleHistory::append(qint64 atMs, const Values& values, Severity level) {
+    // A render tick that lands a few ms early must not skip a second
+    if (m_size > 0 && atMs - timeMs(m_size - 1) < m_intervalMs * 9 / 10) return false;
+    if (m_size < m_capacity) {
+        // Still growing, the ring has not wrapped yet and m_head is 0
+        m_time.push_back(atMs);
+        for (int s = 0; s < SeriesCount; ++s) m_values[s].push_back(values[s]);
+        m_severity.push_back(static_cast<quint8>(level));
+        ++m_size;
+    } else {
+        // Full: overwrite the oldest
+        m_time[m_head] = atMs;
+        for (int s = 0; s < SeriesCount; ++s) m_values[s][m_head] = values[s];
+        m_severity[m_head] = static_cast<quint8>(level);
+        m_head = (m_head + 1) % m_capacity;
+    }
+    ++m_appended;
+    return true;
+}
+
+void SampleHistory::clear() {
+    // Keep the arrays, a replay refills them right away
+    m_head = 0;
+    m_size = 0;
+    m_time.clear();
+    for (auto& v : m_values) v.clear();
+    m_severity.clear();
+}
+
+int SampleHistory::lowerBound(qint64 atMs) const {
+    int lo = 0;
+    int hi = m_size;
+    while (lo < hi) {
+        const int mid = lo + (hi - lo) / 2;
+        if (timeMs(mid) < atMs) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+SampleHistory::Buckets SampleHistory::bucketed(qint64 sinceMs, qint64 resolutionMs) const {
+    Buckets out;
+    resolutionMs = std::max(resolutionMs, m_intervalMs);
+    const int first = lowerBound(sinceMs);
+    std::array<double, SeriesCount> sum {};
+    int count = 0;
+    quint8 worst = 0;
+    qint64 bucket = 0;
+    auto flush = [&] {
+        if (count == 0) return;
+        out.timeMs.append(bucket);
+        for (int s = 0; s < SeriesCount; ++s) out.values[s].append(sum[s] / count);
+        out.severity.append(static_cast<char>(worst));
+        sum = {};
+        count = 0;
+        worst = 0;
+    };
+    for (int i = first; i < m_size; ++i) {
+        const qint64 t = timeMs(i);
+        const qint64 b = sinceMs + (t - sinceMs) / resolutionMs * resolutionMs;
+        if (count > 0 && b != bucket) flush();
+        bucket = b;
+        const int p = at(i);
+        for (int s = 0; s < SeriesCount; ++s) sum[s] += m_values[s][p];
+        worst = std::max(worst, m_severity[p]);
+        ++count;
+    }
+    flush();
+    return out;
+}
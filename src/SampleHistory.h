@@ -0,0 +1,66 @@
+// ===== src/SampleHistory.h =====
+#pragma once
+#include "SeverityEngine.h"
+#include <QVector>
+#include <QtGlobal>
+#include <array>
+#include <vector>
+
+struct SnapshotData;
+
+// The last day of samples at 1 s resolution, for the D-Bus history call
+// and anything else that needs more than the latest value. Columnar: one
+// contiguous array per series, so a consumer scanning one series touches
+// nothing else. A ring once full; it grows with uptime until then, so a
+// tray that has run for a minute holds a minute.
+// Not thread safe; the GUI thread appends and reads.
+class SampleHistory {
+public:
+    enum Series { MemAvailableMiB = 0, SwapFreeMiB, ZramUsedMiB, PsiSomeAvg10, PsiFullAvg10, SeriesCount };
+    using Values = std::array<float, SeriesCount>;
+
+    static constexpr int kDefaultCapacity = 24 * 3600;
+    static constexpr qint64 kDefaultIntervalMs = 1000;
+
+    explicit SampleHistory(int capacity = kDefaultCapacity, qint64 intervalMs = kDefaultIntervalMs);
+
+    // Append one sample unless the last one is less than an interval old
+    // (with a little slack for timer jitter). Returns whether it did.
+    bool append(const SnapshotData& d, Severity level);
+    bool append(qint64 atMs, const Values& values, Severity level);
+    void clear();
+
+    int size() const { return m_size; }
+    int capacity() const { return m_capacity; }
+    qint64 intervalMs() const { return m_intervalMs; }
+    quint64 appended() const { return m_appended; } // ever, tells readers what is new
+
+    // Index 0 is the oldest sample still held
+    qint64 timeMs(int i) const { return m_time[at(i)]; }
+    float value(Series s, int i) const { return m_values[s][at(i)]; }
+    Severity severity(int i) const { return static_cast<Severity>(m_severity[at(i)]); }
+    int lowerBound(qint64 atMs) const; // first index at or after atMs, size() if none
+
+    static Values valuesOf(const SnapshotData& d);
+
+    // Samples from sinceMs on, averaged into buckets of resolutionMs; each
+    // bucket carries the worst severity seen in it
+    struct Buckets {
+        QList<qlonglong> timeMs;                      // start of each bucket
+        std::array<QList<double>, SeriesCount> values;
+        QByteArray severity;
+    };
+    Buckets bucketed(qint64 sinceMs, qint64 resolutionMs) const;
+
+private:
+    int at(int i) const { return (m_head + i) % m_capacity; }
+
+    int m_capacity;
+    qint64 m_intervalMs;
+    int m_head {0};                    // physical index of the oldest sample
+    int m_size {0};
+    quint64 m_appended {0};
+    std::vector<qint64> m_time;
+    std::array<std::vector<float>, SeriesCount> m_values;
+    std::vector<quint8> m_severity;
+};
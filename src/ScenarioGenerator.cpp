@@ -0,0 +1,116 @@
+// ===== src/ScenarioGenerator.cpp =====
+#include "pch.h"
+#include "ScenarioGenerator.h"
+#include <QDir>
+#include <QFile>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+ScenarioGenerator::ScenarioGenerator(const QString& root)
+    : m_root(root.isEmpty() ? m_tmp.path() : root) {
+    if (root.isEmpty() && !m_tmp.isValid()) return;
+    const QDir dir(m_root);
+    if (!dir.mkpath(QStringLiteral("proc/pressure")) || !dir.mkpath(QStringLiteral("sys/block/zram0"))) return;
+    static const char* const kPaths[FileCount] = {"/proc/meminfo", "/proc/swaps", "/proc/pressure/memory",
+                                                  "/sys/block/zram0/disksize", "/sys/block/zram0/mm_stat"};
+    for (int i = 0; i < FileCount; ++i) {
+        const QByteArray path = QFile::encodeName(m_root) + kPaths[i];
+        m_fds[i] = ::open(path.constData(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (m_fds[i] < 0) return;
+    }
+    m_valid = true;
+    write(stateAt(Scenario::LinearLeak, 0));
+}
+
+ScenarioGenerator::~ScenarioGenerator() {
+    for (int fd : m_fds)
+        if (fd >= 0) ::close(fd);
+}
+
+const char* ScenarioGenerator::name(Scenario s) {
+    switch (s) {
+    case Scenario::LinearLeak: return "linear leak";
+    case Scenario::ForkBomb: return "fork bomb";
+    case Scenario::ZramFill: return "zram fill";
+    case Scenario::PsiSpike: return "PSI spike";
+    }
+    return "";
+}
+
+int ScenarioGenerator::steps(Scenario s) {
+    switch (s) {
+    case Scenario::LinearLeak: return 257;
+    case Scenario::ZramFill: return 129;
+    case Scenario::ForkBomb:
+    case Scenario::PsiSpike: break;
+    }
+    return 40;
+}
+
+ScenarioGenerator::State ScenarioGenerator::stateAt(Scenario s, int step) {
+    State st {8192, kSwapTotalMiB, 0, 0.5, 0.1};
+    // Sudden scenarios hold the baseline for a few steps first
+    static constexpr int kOnset = 10;
+    switch (s) {
+    case Scenario::LinearLeak:
+        st.memAvailableMiB = std::max(0.0, 8192.0 - 32.0 * step);
+        break;
+    case Scenario::ForkBomb:
+        if (step < kOnset) break;
+        st.memAvailableMiB = 256;
+        st.psiSomeAvg10 = std::min(90.0, 20.0 + 5.0 * (step - kOnset));
+        st.psiFullAvg10 = st.psiSomeAvg10 / 2;
+        break;
+    case Scenario::ZramFill:
+        st.zramOrigMiB = std::min(kZramDiskMiB, 64.0 * step);
+        st.swapFreeMiB = kSwapTotalMiB - st.zramOrigMiB;
+        break;
+    case Scenario::PsiSpike:
+        if (step < kOnset) break;
+        st.psiSomeAvg10 = 80.0 * std::pow(0.9, step - kOnset);
+        st.psiFullAvg10 = st.psiSomeAvg10 * 0.6;
+        break;
+    }
+    return st;
+}
+
+void ScenarioGenerator::write(const State& s) {
+    if (!m_valid) return;
+    auto kib = [](double mib) { return static_cast<long long>(std::llround(mib * 1024)); };
+    auto bytes = [](double mib) { return static_cast<long long>(std::llround(mib * 1024 * 1024)); };
+    char buf[512];
+    auto put = [&](File f, int n) {
+        // Fixed widths keep the size constant, so no truncate is needed
+        const size_t len = static_cast<size_t>(std::clamp<int>(n, 0, sizeof(buf) - 1));
+        if (::pwrite(m_fds[f], buf, len, 0) != static_cast<ssize_t>(len)) m_valid = false;
+    };
+
+    put(Meminfo, std::snprintf(buf, sizeof(buf),
+        "MemTotal:       %10lld kB\n"
+        "MemFree:        %10lld kB\n"
+        "MemAvailable:   %10lld kB\n"
+        "Buffers:        %10lld kB\n"
+        "Cached:         %10lld kB\n"
+        "SwapCached:     %10lld kB\n"
+        "SwapTotal:      %10lld kB\n"
+        "SwapFree:       %10lld kB\n",
+        kib(kMemTotalMiB), kib(s.memAvailableMiB / 2), kib(s.memAvailableMiB), kib(64),
+        kib(s.memAvailableMiB / 2), 0LL, kib(kSwapTotalMiB), kib(s.swapFreeMiB)));
+    put(Swaps, std::snprintf(buf, sizeof(buf),
+        "Filename\t\t\t\tType\t\tSize\t\tUsed\t\tPriority\n"
+        "/dev/zram0                              partition\t%10lld\t%10lld\t100\n",
+        kib(kSwapTotalMiB), kib(kSwapTotalMiB - s.swapFreeMiB)));
+    put(Pressure, std::snprintf(buf, sizeof(buf),
+        "some avg10=%06.2f avg60=%06.2f avg300=%06.2f total=%012lld\n"
+        "full avg10=%06.2f avg60=%06.2f avg300=%06.2f total=%012lld\n",
+        s.psiSomeAvg10, s.psiSomeAvg10 / 2, s.psiSomeAvg10 / 4, 0LL,
+        s.psiFullAvg10, s.psiFullAvg10 / 2, s.psiFullAvg10 / 4, 0LL));
+    put(ZramDisk, std::snprintf(buf, sizeof(buf), "%12lld\n", bytes(kZramDiskMiB)));
+    // mm_stat: orig_data_size compr_data_size mem_used_total mem_limit mem_used_max same_pages pages_compacted
+    put(ZramMm, std::snprintf(buf, sizeof(buf), "%12lld %12lld %12lld %12lld %12lld %8d %8d\n",
+        bytes(s.zramOrigMiB), bytes(s.zramOrigMiB / 3), bytes(s.zramOrigMiB / 3), 0LL,
+        bytes(s.zramOrigMiB / 3), 0, 0));
+}
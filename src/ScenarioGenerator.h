@@ -0,0 +1,63 @@
+// ===== src/ScenarioGenerator.h =====
+#pragma once
+#include <QString>
+#include <QTemporaryDir>
+
+// ScenarioGenerator fakes the files SystemSnapshot reads, /proc/meminfo,
+// /proc/swaps, /proc/pressure/memory and zram0's disksize and mm_stat,
+// under a root of its own, and rewrites them step by step to play out a
+// memory crisis:
+//   LinearLeak  MemAvailable falls 32 MiB per step until it is gone
+//   ForkBomb    steady, then most of RAM is taken in a single step and
+//               stall climbs
+//   ZramFill    zram takes 64 MiB per step and swap drains with it
+//   PsiSpike    only PSI moves: a jump to 80 % some, then decay
+// Point a SystemSnapshot at procRoot() and sysRoot() to sample it.
+//
+// Files are rewritten in place with one pwrite of a fixed width record, so
+// a reader holding them open (ProcReader keeps its fds) sees every step and
+// never a short file.
+class ScenarioGenerator {
+public:
+    enum class Scenario { LinearLeak, ForkBomb, ZramFill, PsiSpike };
+    static constexpr Scenario kScenarios[] = {Scenario::LinearLeak, Scenario::ForkBomb,
+                                              Scenario::ZramFill, Scenario::PsiSpike};
+
+    struct State {
+        double memAvailableMiB {0};
+        double swapFreeMiB {0};
+        double zramOrigMiB {0};
+        double psiSomeAvg10 {0};
+        double psiFullAvg10 {0};
+    };
+
+    static constexpr double kMemTotalMiB = 16384;
+    static constexpr double kSwapTotalMiB = 8192;  // all of it zram0
+    static constexpr double kZramDiskMiB = 8192;
+
+    // An empty root writes into a fresh temporary directory
+    explicit ScenarioGenerator(const QString& root = QString());
+    ~ScenarioGenerator();
+    ScenarioGenerator(const ScenarioGenerator&) = delete;
+    ScenarioGenerator& operator=(const ScenarioGenerator&) = delete;
+
+    bool isValid() const { return m_valid; }     // false once a write fails
+    QString root() const { return m_root; }
+    QString procRoot() const { return m_root + QStringLiteral("/proc"); }
+    QString sysRoot() const { return m_root + QStringLiteral("/sys"); }
+
+    static const char* name(Scenario s);
+    static int steps(Scenario s);                    // the crisis is fully developed by then
+    static State stateAt(Scenario s, int step);      // step 0 is the healthy baseline
+
+    void write(const State& s);
+    void write(Scenario s, int step) { write(stateAt(s, step)); }
+
+private:
+    enum File { Meminfo, Swaps, Pressure, ZramDisk, ZramMm, FileCount };
+
+    QTemporaryDir m_tmp;
+    QString m_root;
+    int m_fds[FileCount] {-1, -1, -1, -1, -1};
+    bool m_valid {false};
+};
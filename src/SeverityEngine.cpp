@@ -0,0 +1,199 @@
+// ===== src/SeverityEngine.cpp =====
+#include "pch.h"
+#include "SeverityEngine.h"
+
+static std::optional<double> bandOf(const std::optional<double>& threshold, double fraction) {
+    return threshold ? std::optional<double>(*threshold * fraction) : std::nullopt;
+}
+
+double SeverityEngine::psiValue(const ThresholdSet& th, const SystemSnapshot& snap) {
+    if (th.psi_metrics == QStringLiteral("some") || th.psi_metrics.startsWith(QStringLiteral("some_")))
+        return snap.psi().some_avg10;
+    return snap.psi().full_avg10;
+}
+
+Severity SeverityEngine::evaluate(const Input& in, MetricState& st, double now) const {
+    Severity out = Severity::Normal;
+    for (int i = 0; i < 3; ++i) {
+        const Severity lvl = static_cast<Severity>(i + 1);
+        const auto& thr = in.thresholds[i];
+        if (!thr) {
+            st.exceedingSince[i].reset();
+            continue;
+        }
+        const bool held = st.level >= lvl;
+        // Entering needs the plain threshold, leaving needs the band as well
+        const double edge = held ? (in.floor ? *thr + in.band : *thr - in.band) : *thr;
+        const bool exceeding = in.floor ? in.value < edge : in.value > edge;
+        if (!exceeding) {
+            st.exceedingSince[i].reset();
+            continue;
+        }
+        if (!st.exceedingSince[i]) st.exceedingSince[i] = now;
+        if (held || now - *st.exceedingSince[i] >= in.holdSeconds) out = lvl;
+    }
+    st.level = out;
+    return out;
+}
+
+std::optional<SeverityTransition> SeverityEngine::update(const ThresholdSet& th,
+                                                         const SystemSnapshot& snap,
+                                                         double nowSeconds) {
+    std::array<Input, static_cast<int>(SeverityMetric::Count)> in;
+
+    Input& mem = in[static_cast<int>(SeverityMetric::Mem)];
+    mem.value = snap.mem().memAvailableMiB;
+    mem.thresholds = {th.warn_mem_free.mib, th.soft_mem_free.mib, th.hard_mem_free.mib};
+    mem.floor = true;
+
+    // The worst NUMA node, held to the same RAM thresholds as a share of
+    // its own size: a node can run dry while the global figure looks fine
+    const NumaInfo& numa = snap.numa();
+    Input& node = in[static_cast<int>(SeverityMetric::Node)];
+    node.floor = true;
+    if (numa.present && numa.shown > 0) {
+        node.value = numa.nodes[0].availablePercent;
+        auto percentOf = [&](const ThresholdValue& tv) -> std::optional<double> {
+            if (tv.percent) return tv.percent;
+            if (tv.mib && snap.mem().memTotalMiB > 0) return *tv.mib * 100.0 / snap.mem().memTotalMiB;
+            return std::nullopt;
+        };
+        node.thresholds = {percentOf(th.warn_mem_free), percentOf(th.soft_mem_free), percentOf(th.hard_mem_free)};
+    }
+
+    Input& swap = in[static_cast<int>(SeverityMetric::Swap)];
+    swap.value = snap.mem().swapFreeMiB;
+    swap.thresholds = {th.warn_swap_free.mib, th.soft_swap_free.mib, th.hard_swap_free.mib};
+    swap.floor = true;
+
+    Input& zram = in[static_cast<int>(SeverityMetric::Zram)];
+    zram.value = snap.zram().origDataMiB;
+    zram.thresholds = {th.warn_zram_used.mib, th.soft_zram_used.mib, th.hard_zram_used.mib};
+
+    Input& spill = in[static_cast<int>(SeverityMetric::SwapSpill)];
+    spill.value = snap.swaps().spilledMiB;
+    spill.thresholds = m_opts.swapSpillMiB;
+
+    Input& zswap = in[static_cast<int>(SeverityMetric::Zswap)];
+    zswap.value = snap.zswap().poolUsedPercent;
+    if (snap.zswap().enabled) zswap.thresholds = m_opts.zswapPoolPercent;
+
+    Input& psi = in[static_cast<int>(SeverityMetric::Psi)];
+    psi.value = psiValue(th, snap);
+    psi.thresholds = {th.warn_psi, th.soft_psi, th.hard_psi};
+    psi.band = m_opts.psiBand;
+    psi.holdSeconds = th.psi_duration.value_or(0);
+
+    // Paging storms usually show here well before MemAvailable runs out
+    const VmstatInfo& vm = snap.vmstat();
+    Input& swapIn = in[static_cast<int>(SeverityMetric::SwapIn)];
+    swapIn.value = vm.swapInMiBPerSec;
+    Input& refault = in[static_cast<int>(SeverityMetric::Refault)];
+    refault.value = vm.refaultMiBPerSec();
+    if (vm.present) {
+        swapIn.thresholds = m_opts.swapInMiBPerSec;
+        refault.thresholds = m_opts.refaultMiBPerSec;
+    }
+    for (Input* rate : {&swapIn, &refault}) rate->holdSeconds = m_opts.rateHoldSeconds;
+
+    Severity worst = Severity::Normal;
+    SeverityMetric cause = SeverityMetric::Mem;
+    for (int m = 0; m < static_cast<int>(SeverityMetric::Count); ++m) {
+        if (m == static_cast<int>(SeverityMetric::Events)) {
+            MetricState& ev = m_metrics[m];
+            ev.level = nowSeconds < m_escalatedUntil ? m_escalated : Severity::Normal;
+            if (ev.level > worst) {
+                worst = ev.level;
+                cause = SeverityMetric::Events;
+            }
+            continue;
+        }
+        Input& i = in[m];
+        if (m != static_cast<int>(SeverityMetric::Psi)) {
+            // Bands scale with each threshold, taken from the lowest one so
+            // warn/soft/hard bands never overlap a neighbouring level
+            std::optional<double> smallest;
+            for (const auto& t : i.thresholds)
+                if (t && (!smallest || *t < *smallest)) smallest = t;
+            const bool rate = m == static_cast<int>(SeverityMetric::SwapIn) || m == static_cast<int>(SeverityMetric::Refault);
+            i.band = bandOf(smallest, rate ? m_opts.rateBandFraction : m_opts.memBandFraction).value_or(0);
+        }
+        const Severity lvl = evaluate(i, m_metrics[m], nowSeconds);
+        if (lvl > worst) {
+            worst = lvl;
+            cause = static_cast<SeverityMetric>(m);
+        }
+    }
+
+    if (worst == m_level) return std::nullopt;
+    SeverityTransition t{m_level, worst, cause, nowSeconds};
+    m_level = worst;
+    ++m_transitions[static_cast<int>(worst)];
+    return t;
+}
+
+std::optional<SeverityTransition> SeverityEngine::escalate(Severity to, double nowSeconds, double holdSeconds) {
+    // A weaker event does not cut a stronger escalation short
+    const bool active = nowSeconds < m_escalatedUntil;
+    if (!active || to >= m_escalated) {
+        m_escalated = active ? std::max(m_escalated, to) : to;
+        m_escalatedUntil = std::max(active ? m_escalatedUntil : 0.0, nowSeconds + holdSeconds);
+    }
+    MetricState& ev = m_metrics[static_cast<int>(SeverityMetric::Events)];
+    ev.level = m_escalated;
+    if (m_escalated <= m_level) return std::nullopt;
+    SeverityTransition t{m_level, m_escalated, SeverityMetric::Events, nowSeconds};
+    m_level = m_escalated;
+    ++m_transitions[static_cast<int>(m_escalated)];
+    return t;
+}
+
+SeverityMetric SeverityEngine::cause() const {
+    for (int m = 0; m < static_cast<int>(SeverityMetric::Count); ++m)
+        if (m_level != Severity::Normal && m_metrics[m].level == m_level) return static_cast<SeverityMetric>(m);
+    return SeverityMetric::Mem;
+}
+
+void SeverityEngine::reset() {
+    m_metrics = {};
+    m_level = Severity::Normal;
+    m_escalated = Severity::Normal;
+    m_escalatedUntil = 0;
+}
+
+QString SeverityEngine::iconName(Severity s) {
+    switch (s) {
+    case Severity::Hard: return QStringLiteral("security-high");
+    case Severity::Warn:
+    case Severity::Soft: return QStringLiteral("security-medium");
+    case Severity::Normal: break;
+    }
+    return QStringLiteral("security-low");
+}
+
+QString SeverityEngine::name(Severity s) {
+    switch (s) {
+    case Severity::Warn: return QStringLiteral("warn");
+    case Severity::Soft: return QStringLiteral("soft");
+    case Severity::Hard: return QStringLiteral("hard");
+    case Severity::Normal: break;
+    }
+    return QStringLiteral("normal");
+}
+
+QString SeverityEngine::name(SeverityMetric m) {
+    switch (m) {
+    case SeverityMetric::Mem: return QStringLiteral("RAM");
+    case SeverityMetric::Node: return QStringLiteral("NUMA node");
+    case SeverityMetric::Swap: return QStringLiteral("Swap");
+    case SeverityMetric::SwapSpill: return QStringLiteral("Disk swap");
+    case SeverityMetric::Zram: return QStringLiteral("ZRAM");
+    case SeverityMetric::Zswap: return QStringLiteral("zswap");
+    case SeverityMetric::Psi: return QStringLiteral("PSI");
+    case SeverityMetric::SwapIn: return QStringLiteral("Swap-in");
+    case SeverityMetric::Refault: return QStringLiteral("Refaults");
+    case SeverityMetric::Events: return QStringLiteral("memory.events");
+    case SeverityMetric::Count: break;
+    }
+    return QString();
+}
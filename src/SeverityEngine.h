@@ -0,0 +1,97 @@
+// ===== src/SeverityEngine.h =====
+#pragma once
+#include "Thresholds.h"
+#include <QString>
+#include <array>
+#include <optional>
+
+enum class Severity { Normal = 0, Warn, Soft, Hard };
+
+// Inputs the engine tracks independently, each with its own hold state.
+// Node is the most constrained NUMA node against the RAM thresholds,
+// SwapSpill the disk swap used behind zram, Zswap the pool fill against
+// max_pool_percent, SwapIn and Refault are /proc/vmstat rates. Events is
+// not sampled: it carries escalations from cgroup memory.events.
+enum class SeverityMetric { Mem = 0, Node, Swap, SwapSpill, Zram, Zswap, Psi, SwapIn, Refault, Events, Count };
+
+struct SeverityTransition {
+    Severity from {Severity::Normal};
+    Severity to {Severity::Normal};
+    SeverityMetric cause {SeverityMetric::Mem}; // worst metric after the change
+    double atSeconds {0};                       // sample timeline
+};
+
+// SeverityEngine turns a stream of samples into severity transitions.
+// Unlike the stateless TrayApp::iconNameFor it
+// 1) keeps a level per metric and only leaves it once the value has
+//    recovered past the threshold by a hysteresis band, so a value hovering
+//    around a threshold does not flap, and
+// 2) mirrors nohang's psi_excess_duration: PSI must stay above a threshold
+//    for that many seconds of sample time before the level is entered.
+// nohang has no spill, zswap or paging thresholds, so those use the tray's
+// own (Options). Rates get a hold time so one burst is not a storm.
+class SeverityEngine {
+public:
+    using Levels = std::array<std::optional<double>, 3>; // warn, soft, hard
+
+    struct Options {
+        double memBandFraction {0.05}; // RAM, swap and zram bands, fraction of the threshold
+        double psiBand {2.0};          // PSI band in absolute percentage points
+        Levels swapSpillMiB {64.0, std::nullopt, std::nullopt};     // disk swap used behind zram
+        Levels zswapPoolPercent {90.0, std::nullopt, std::nullopt}; // full pools write back to disk
+        Levels swapInMiBPerSec {20.0, 80.0, std::nullopt};
+        Levels refaultMiBPerSec {40.0, 160.0, std::nullopt};
+        double rateBandFraction {0.25}; // paging rates are noisy, recover further
+        double rateHoldSeconds {5.0};   // sustained this long before a level is entered
+    };
+
+    SeverityEngine() = default;
+    explicit SeverityEngine(const Options& opts) : m_opts(opts) {}
+
+    // Feed one sample, returns a transition only when the overall level changes
+    std::optional<SeverityTransition> update(const ThresholdSet& th,
+                                             const SystemSnapshot& snap,
+                                             double nowSeconds);
+
+    // Raise the level to at least `to` for holdSeconds of sample time, for
+    // kernel events such as an OOM kill that no sampled value shows. Returns
+    // a transition if the overall level goes up right away.
+    std::optional<SeverityTransition> escalate(Severity to, double nowSeconds, double holdSeconds);
+
+    Severity level() const { return m_level; }
+    Severity level(SeverityMetric m) const { return m_metrics[static_cast<int>(m)].level; }
+    SeverityMetric cause() const;                 // first metric at the overall level
+    // Overall level changes into `to` since construction, reset() keeps them
+    quint64 transitions(Severity to) const { return m_transitions[static_cast<int>(to)]; }
+    void reset();
+
+    static QString iconName(Severity s);
+    static QString name(Severity s);
+    static QString name(SeverityMetric m);
+    const Options& options() const { return m_opts; }
+
+    // PSI value selected by psi_metrics, "some"/"some_avg10" or full otherwise
+    static double psiValue(const ThresholdSet& th, const SystemSnapshot& snap);
+
+private:
+    struct Input {
+        double value {0};
+        Levels thresholds;
+        bool floor {false};   // true: bad when below, false: bad when above
+        double band {0};      // absolute recovery margin
+        double holdSeconds {0};
+    };
+    struct MetricState {
+        Severity level {Severity::Normal};
+        std::array<std::optional<double>, 3> exceedingSince;
+    };
+
+    Severity evaluate(const Input& in, MetricState& st, double now) const;
+
+    Options m_opts;
+    std::array<MetricState, static_cast<int>(SeverityMetric::Count)> m_metrics {};
+    Severity m_level {Severity::Normal};
+    Severity m_escalated {Severity::Normal};
+    double m_escalatedUntil {0};
+    std::array<quint64, 4> m_transitions {};
+};
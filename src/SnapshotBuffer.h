@@ -0,0 +1,54 @@
+// ===== src/SnapshotBuffer.h =====
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-writer, multi-reader seqlock for plain-value structs.
+// The writer never waits, readers never block the writer and retry only if
+// they raced a store. The payload lives in atomic words so a torn read is
+// well defined (and discarded), and no fences are needed, which keeps TSAN
+// able to reason about it.
+template <typename T>
+class SnapshotBuffer {
+    static_assert(std::is_trivially_copyable_v<T>, "SnapshotBuffer needs a plain-value type");
+    static constexpr std::size_t kWords = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+public:
+    // Writer side, one thread only
+    void store(const T& v) {
+        std::array<std::uint64_t, kWords> raw{};
+        std::memcpy(raw.data(), &v, sizeof(T));
+        const std::uint64_t seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);
+        // Release on each word orders the odd sequence before it, so a reader
+        // that sees any new word also sees the sequence move
+        for (std::size_t i = 0; i < kWords; ++i)
+            m_words[i].store(raw[i], std::memory_order_release);
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // Reader side, any thread, lock-free
+    T load() const {
+        std::array<std::uint64_t, kWords> raw{};
+        for (;;) {
+            const std::uint64_t before = m_seq.load(std::memory_order_acquire);
+            if (before & 1u) continue; // store in progress
+            for (std::size_t i = 0; i < kWords; ++i)
+                raw[i] = m_words[i].load(std::memory_order_acquire);
+            if (m_seq.load(std::memory_order_relaxed) == before) break;
+        }
+        T out;
+        std::memcpy(&out, raw.data(), sizeof(T));
+        return out;
+    }
+
+    // Number of completed stores, lets readers skip work when nothing changed
+    std::uint64_t version() const { return m_seq.load(std::memory_order_acquire) / 2; }
+
+private:
+    std::atomic<std::uint64_t> m_seq {0};
+    std::array<std::atomic<std::uint64_t>, kWords> m_words {};
+};
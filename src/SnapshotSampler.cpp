@@ -0,0 +1,52 @@
+// ===== src/SnapshotSampler.cpp =====
+#include "pch.h"
+#include "SnapshotSampler.h"
+#include <pthread.h>
+#include <sched.h>
+
+SnapshotSampler::SnapshotSampler(std::unique_ptr<SystemSnapshot> source,
+                                 std::chrono::milliseconds interval)
+    : m_source(std::move(source)), m_interval(interval) {}
+
+SnapshotSampler::~SnapshotSampler() {
+    stop();
+}
+
+void SnapshotSampler::start(bool highPriority) {
+    if (m_thread.joinable()) return;
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = false;
+    }
+    m_thread = std::thread(&SnapshotSampler::run, this, highPriority);
+}
+
+void SnapshotSampler::stop() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void SnapshotSampler::run(bool highPriority) {
+    if (highPriority) {
+        sched_param sp{};
+        sp.sched_priority = sched_get_priority_min(SCHED_FIFO);
+        pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+    }
+
+    auto next = std::chrono::steady_clock::now();
+    for (;;) {
+        m_source->refresh();
+        m_latest.store(m_source->data());
+
+        // Absolute deadlines, so a slow refresh does not drift the schedule
+        next += m_interval;
+        const auto now = std::chrono::steady_clock::now();
+        if (next < now) next = now;
+        std::unique_lock lock(m_mutex);
+        if (m_wake.wait_until(lock, next, [this] { return m_stop; })) return;
+    }
+}
@@ -0,0 +1,41 @@
+// ===== src/SnapshotSampler.h =====
+#pragma once
+#include "SnapshotBuffer.h"
+#include "SystemSnapshot.h"
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// SnapshotSampler refreshes its own SystemSnapshot on a dedicated thread at a
+// fixed interval and publishes each plain-value result through a seqlock, so
+// any thread can read the latest complete sample without taking a lock.
+// It never touches widgets, so it keeps running while the GUI is stalled.
+class SnapshotSampler {
+public:
+    SnapshotSampler(std::unique_ptr<SystemSnapshot> source,
+                    std::chrono::milliseconds interval);
+    ~SnapshotSampler();
+
+    // highPriority asks for SCHED_FIFO, silently staying at the default
+    // policy when the process lacks CAP_SYS_NICE.
+    void start(bool highPriority = false);
+    void stop();
+
+    SnapshotData latest() const { return m_latest.load(); }
+    quint64 sampleCount() const { return m_latest.version(); }
+
+private:
+    void run(bool highPriority);
+
+    std::unique_ptr<SystemSnapshot> m_source;
+    const std::chrono::milliseconds m_interval;
+
+    SnapshotBuffer<SnapshotData> m_latest;
+
+    std::mutex m_mutex;                 // guards m_stop only
+    std::condition_variable m_wake;
+    bool m_stop {false};
+    std::thread m_thread;
+};
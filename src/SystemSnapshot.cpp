@@ -1,133 +1,496 @@
 // ===== src/SystemSnapshot.cpp =====
 #include "pch.h"
 #include "SystemSnapshot.h"
+#include "CgroupSampler.h"
+#include "ProcParse.h"
+#include <QDir>
 #include <QFile>
-#include <QTextStream>
-#include <QRegularExpression>
+#include <QFileInfo>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <unistd.h>
 
-SystemSnapshot::SystemSnapshot(QObject* parent) : QObject(parent) {}
+SystemSnapshot::SystemSnapshot(QObject* parent)
+    : QObject(parent), m_reader(ProcReader::create()) {
+    registerFiles();
+}
 
 SystemSnapshot::SystemSnapshot(const QString& procRoot, const QString& sysRoot, QObject* parent)
-    : QObject(parent), m_procRoot(procRoot), m_sysRoot(sysRoot) {}
+    : SystemSnapshot(procRoot, sysRoot, ProcReader::create(), parent) {}
+
+SystemSnapshot::SystemSnapshot(const QString& procRoot, const QString& sysRoot,
+                               std::unique_ptr<ProcReader> reader, QObject* parent)
+    : QObject(parent), m_procRoot(procRoot), m_sysRoot(sysRoot), m_reader(std::move(reader)) {
+    registerFiles();
+}
+
+SystemSnapshot::~SystemSnapshot() = default;
+
+void SystemSnapshot::registerFiles() {
+    m_meminfoSlot  = m_reader->add(m_procRoot + QStringLiteral("/meminfo"));
+    m_swapsSlot    = m_reader->add(m_procRoot + QStringLiteral("/swaps"));
+    m_zramDiskSlot = m_reader->add(m_sysRoot + QStringLiteral("/block/zram0/disksize"));
+    m_zramMmSlot   = m_reader->add(m_sysRoot + QStringLiteral("/block/zram0/mm_stat"));
+    m_zswapEnabledSlot    = m_reader->add(m_sysRoot + QStringLiteral("/module/zswap/parameters/enabled"));
+    m_zswapMaxPoolSlot    = m_reader->add(m_sysRoot + QStringLiteral("/module/zswap/parameters/max_pool_percent"));
+    m_zswapCompressorSlot = m_reader->add(m_sysRoot + QStringLiteral("/module/zswap/parameters/compressor"));
+    m_psiSlot      = m_reader->add(m_procRoot + QStringLiteral("/pressure/memory"));
+    m_vmstatSlot   = m_reader->add(m_procRoot + QStringLiteral("/vmstat"));
+}
+
+void SystemSnapshot::enableCgroups(const QString& cgroupRoot, const QString& subtree) {
+    m_cgroupSampler = std::make_unique<CgroupSampler>(cgroupRoot, subtree);
+}
+
+void SystemSnapshot::enableNuma() {
+    if (!m_nodeSlots.empty()) return;
+    const QDir dir(m_sysRoot + QStringLiteral("/devices/system/node"));
+    const QStringList entries = dir.entryList({QStringLiteral("node*")}, QDir::Dirs | QDir::NoDotAndDotDot);
+    std::vector<NodeSlots> nodes;
+    for (const QString& e : entries) {
+        bool ok = false;
+        const int id = e.mid(4).toInt(&ok);
+        if (ok) nodes.push_back({id, -1, -1});
+    }
+    if (nodes.size() < 2) return; // the global view already is the node view
+    std::sort(nodes.begin(), nodes.end(), [](const NodeSlots& a, const NodeSlots& b) { return a.id < b.id; });
+    for (NodeSlots& n : nodes) {
+        const QString base = dir.filePath(QStringLiteral("node%1/").arg(n.id));
+        n.meminfo = m_reader->add(base + QStringLiteral("meminfo"));
+        n.numastat = m_reader->add(base + QStringLiteral("numastat"));
+    }
+    m_nodeSlots = std::move(nodes);
+}
+
+void SystemSnapshot::setLimitCgroup(const QString& cgroupRoot, const QString& path) {
+    // Slots stay registered with the reader when the cgroup changes; this is
+    // set once at startup
+    m_limitLevels.clear();
+    m_limitPath.clear();
+    m_limit = {};
+    QString rel = path;
+    if (rel == QLatin1String("self")) {
+        rel.clear();
+        QFile f(m_procRoot + QStringLiteral("/self/cgroup"));
+        if (f.open(QIODevice::ReadOnly)) {
+            const QByteArray all = f.readAll();
+            ProcParse::forEachLine(all, [&](QByteArrayView line) {
+                if (line.startsWith("0::")) rel = QString::fromUtf8(ProcParse::trimmed(line.sliced(3)));
+            });
+        }
+        if (rel.isEmpty()) return;
+    }
+    if (rel.isEmpty() || !QFileInfo(cgroupRoot + QLatin1Char('/') + rel).isDir()) return;
+
+    // One level per path component, the root included: inside a cgroup
+    // namespace the container's own limit sits on the mounted root
+    m_limitPath = QFile::encodeName(rel.startsWith(QLatin1Char('/')) ? rel : QLatin1Char('/') + rel);
+    const QStringList parts = rel.split(QLatin1Char('/'), Qt::SkipEmptyParts);
+    QString dir = cgroupRoot;
+    for (qsizetype i = 0; i <= parts.size(); ++i) {
+        if (i > 0) dir += QLatin1Char('/') + parts[i - 1];
+        auto slot = [&](const char* name) {
+            const QString file = dir + QLatin1Char('/') + QLatin1String(name);
+            return QFile::exists(file) ? m_reader->add(file) : -1;
+        };
+        LimitLevel level;
+        level.max = slot("memory.max");
+        level.current = slot("memory.current");
+        level.swapMax = slot("memory.swap.max");
+        level.swapCurrent = slot("memory.swap.current");
+        m_limitLevels.push_back(level);
+    }
+}
 
 void SystemSnapshot::refresh() {
+    refreshAt(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void SystemSnapshot::refreshAt(qint64 sampledAtMs) {
+    m_sampledAtMs = sampledAtMs;
+    m_reader->readAll();
     readMeminfo();
     readSwaps();
     readZram();
+    readZswap();
     readPsi();
+    readVmstat();
+    readNuma();
+    readCgroups();
+    applyLimit();
+}
+
+void SystemSnapshot::assign(const SnapshotData& d) {
+    m_mem = d.mem;
+    m_hostMem = d.hostMem;
+    m_limit = d.limit;
+    m_swaps = d.swaps;
+    m_zram = d.zram;
+    m_zswap = d.zswap;
+    m_psi = d.psi;
+    m_vmstat = d.vmstat;
+    m_numa = d.numa;
+    m_cgroups = d.cgroups;
+    m_sampledAtMs = d.sampledAtMs;
 }
 
 void SystemSnapshot::readMeminfo() {
-    QFile f(m_procRoot + QStringLiteral("/meminfo"));
-    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning().noquote() << "SystemSnapshot: cannot open" << f.fileName();
+    if (!m_reader->ok(m_meminfoSlot)) {
+        if (!m_meminfoWarned)
+            qWarning().noquote() << "SystemSnapshot: cannot open" << m_reader->path(m_meminfoSlot);
+        m_meminfoWarned = true;
         m_mem = {};
         return;
     }
-    QTextStream ts(&f);
-    double memTotalKiB = 0, memAvailableKiB = 0, swapTotalKiB = 0, swapFreeKiB = 0;
-    QString line;
-    QRegularExpression re(R"(^\s*([A-Za-z_]+):\s+([0-9]+))");
-    while (ts.readLineInto(&line)) {
-        auto m = re.match(line);
-        if (!m.hasMatch()) continue;
-        const QString key = m.captured(1);
-        const double val  = m.captured(2).toDouble();
-        if (key == QLatin1String("MemTotal"))       memTotalKiB       = val;
-        else if (key == QLatin1String("MemAvailable")) memAvailableKiB = val;
-        else if (key == QLatin1String("SwapTotal"))  swapTotalKiB      = val;
-        else if (key == QLatin1String("SwapFree"))   swapFreeKiB       = val;
-    }
-    m_mem.memTotalMiB = memTotalKiB / 1024.0;
-    m_mem.memAvailableMiB = memAvailableKiB / 1024.0;
-    m_mem.swapTotalMiB = swapTotalKiB / 1024.0;
-    m_mem.swapFreeMiB  = swapFreeKiB  / 1024.0;
+    m_meminfoWarned = false;
+    m_mem.fieldKiB = {};
+    m_mem.fields = MeminfoTable::parse(m_reader->data(m_meminfoSlot), m_meminfoWanted, m_mem.fieldKiB.data());
+    m_mem.memTotalMiB = m_mem.mib(MeminfoField::MemTotal);
+    m_mem.memAvailableMiB = m_mem.mib(MeminfoField::MemAvailable);
+    m_mem.swapTotalMiB = m_mem.mib(MeminfoField::SwapTotal);
+    m_mem.swapFreeMiB = m_mem.mib(MeminfoField::SwapFree);
 
     m_mem.memAvailablePercent = (m_mem.memTotalMiB > 0) ? (m_mem.memAvailableMiB * 100.0 / m_mem.memTotalMiB) : 0;
     m_mem.swapFreePercent     = (m_mem.swapTotalMiB > 0) ? (m_mem.swapFreeMiB * 100.0 / m_mem.swapTotalMiB) : 0;
 }
 
 void SystemSnapshot::readSwaps() {
-    QFile f(m_procRoot + QStringLiteral("/swaps"));
-    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!m_reader->ok(m_swapsSlot)) {
+        m_swaps = {};
+        m_swapsParsed = false;
         return;
     }
-    QTextStream ts(&f);
-    QString header;
-    if (!ts.readLineInto(&header)) {
-        return;
+    // Usage only moves while something is being swapped, so most samples
+    // see the same text; hashing it is cheaper than splitting it again
+    const QByteArrayView text = m_reader->data(m_swapsSlot);
+    const size_t hash = qHash(text);
+    if (!m_swapsParsed || hash != m_swapsHash) {
+        parseSwaps(text);
+        m_swapsHash = hash;
+        m_swapsParsed = true;
     }
-    double totalKiB = 0;
-    double usedKiB = 0;
-    QString line;
-    QRegularExpression re("\\s+");
-    while (ts.readLineInto(&line)) {
-        const QStringList parts = line.split(re, Qt::SkipEmptyParts);
-        if (parts.size() >= 5) {
-            totalKiB += parts[2].toDouble();
-            usedKiB  += parts[3].toDouble();
-        }
+    if (m_swaps.totalMiB > 0) {
+        m_mem.swapTotalMiB = m_swaps.totalMiB;
+        m_mem.swapFreeMiB = m_swaps.totalMiB - m_swaps.usedMiB;
+        m_mem.swapFreePercent = m_mem.swapFreeMiB * 100.0 / m_mem.swapTotalMiB;
     }
-    if (totalKiB > 0) {
-        m_mem.swapTotalMiB = totalKiB / 1024.0;
-        const double freeKiB = totalKiB - usedKiB;
-        m_mem.swapFreeMiB = freeKiB / 1024.0;
-        m_mem.swapFreePercent = (m_mem.swapTotalMiB > 0) ? (m_mem.swapFreeMiB * 100.0 / m_mem.swapTotalMiB) : 0;
+}
+
+void SystemSnapshot::parseSwaps(QByteArrayView text) {
+    m_swaps = {};
+    int topZram = std::numeric_limits<int>::min();
+    bool header = true;
+    ProcParse::forEachLine(text, [&](QByteArrayView line) {
+        if (header) { header = false; return; }
+        // Filename Type Size Used Priority, sizes in KiB
+        qsizetype pos = 0;
+        QByteArrayView f[5];
+        int n = 0;
+        for (; n < 5; ++n) {
+            f[n] = ProcParse::nextField(line, &pos);
+            if (f[n].isEmpty()) break;
+        }
+        if (n != 5) return;
+        SwapDevice d;
+        const qsizetype from = std::max<qsizetype>(0, f[0].size() - qsizetype(sizeof(d.path) - 1));
+        std::memcpy(d.path, f[0].data() + from, static_cast<size_t>(f[0].size() - from));
+        d.file = f[1] == "file";
+        d.zram = f[0].startsWith("/dev/zram");
+        d.sizeMiB = ProcParse::toDouble(f[2]) / 1024.0;
+        d.usedMiB = ProcParse::toDouble(f[3]) / 1024.0;
+        d.priority = static_cast<int>(ProcParse::toInt64(f[4]));
+        m_swaps.totalMiB += d.sizeMiB;
+        m_swaps.usedMiB += d.usedMiB;
+        if (d.zram) topZram = std::max(topZram, d.priority);
+        if (m_swaps.deviceCount < SwapInfo::kDevices) m_swaps.devices[m_swaps.deviceCount] = d;
+        ++m_swaps.deviceCount;
+    });
+    // Spilled: disk swap in use below a zram device that should have taken
+    // the pages first
+    for (int i = 0; i < std::min(m_swaps.deviceCount, SwapInfo::kDevices); ++i) {
+        const SwapDevice& d = m_swaps.devices[i];
+        if (!d.zram && d.priority < topZram) m_swaps.spilledMiB += d.usedMiB;
     }
 }
 
 void SystemSnapshot::readZram() {
-    QFile disk(m_sysRoot + QStringLiteral("/block/zram0/disksize"));
-    if (!disk.exists()) {
+    if (!m_reader->ok(m_zramDiskSlot)) {
         m_zram = {};
         return;
     }
     // GCOVR_EXCL_START
     m_zram.present = true;
+    m_zram.diskSizeMiB = ProcParse::toDouble(m_reader->data(m_zramDiskSlot)) / (1024.0 * 1024.0);
 
-    if (disk.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        const QString s = QString::fromUtf8(disk.readAll()).trimmed();
-        const double bytes = s.toDouble();
-        m_zram.diskSizeMiB = bytes / (1024.0 * 1024.0);
-    }
-
-    QFile mm(m_sysRoot + QStringLiteral("/block/zram0/mm_stat"));
-    if (mm.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        const QString s = QString::fromUtf8(mm.readAll()).trimmed();
-        const QStringList parts = s.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    if (m_reader->ok(m_zramMmSlot)) {
         // mm_stat: orig_data_size compr_data_size mem_used_total mem_limit mem_used_max zero_pages num_migrated
-        if (parts.size() >= 3) {
-            const double orig = parts[0].toDouble();
-            const double compr = parts[1].toDouble();
-            const double memUsed = parts[2].toDouble();
-            m_zram.origDataMiB = orig / (1024.0 * 1024.0);
-            m_zram.comprDataMiB = compr / (1024.0 * 1024.0);
-            m_zram.memUsedTotalMiB = memUsed / (1024.0 * 1024.0);
+        const QByteArrayView mm = m_reader->data(m_zramMmSlot);
+        qsizetype pos = 0;
+        const QByteArrayView orig = ProcParse::nextField(mm, &pos);
+        const QByteArrayView compr = ProcParse::nextField(mm, &pos);
+        const QByteArrayView memUsed = ProcParse::nextField(mm, &pos);
+        if (!memUsed.isEmpty()) {
+            m_zram.origDataMiB = ProcParse::toDouble(orig) / (1024.0 * 1024.0);
+            m_zram.comprDataMiB = ProcParse::toDouble(compr) / (1024.0 * 1024.0);
+            m_zram.memUsedTotalMiB = ProcParse::toDouble(memUsed) / (1024.0 * 1024.0);
         }
     }
     m_zram.logicalUsedPercent = (m_zram.diskSizeMiB > 0) ? (m_zram.origDataMiB * 100.0 / m_zram.diskSizeMiB) : 0;
     // GCOVR_EXCL_STOP
 }
 
+void SystemSnapshot::readZswap() {
+    m_zswap = {};
+    if (!m_reader->ok(m_zswapEnabledSlot)) return;
+    m_zswap.present = true;
+    const QByteArrayView enabled = ProcParse::trimmed(m_reader->data(m_zswapEnabledSlot));
+    m_zswap.enabled = enabled == "Y" || enabled == "1";
+    if (m_reader->ok(m_zswapMaxPoolSlot))
+        m_zswap.maxPoolPercent = ProcParse::toDouble(m_reader->data(m_zswapMaxPoolSlot));
+    if (m_reader->ok(m_zswapCompressorSlot)) {
+        const QByteArrayView c = ProcParse::trimmed(m_reader->data(m_zswapCompressorSlot));
+        const qsizetype n = std::min<qsizetype>(c.size(), sizeof(m_zswap.compressor) - 1);
+        std::memcpy(m_zswap.compressor, c.data(), static_cast<size_t>(n));
+    }
+
+    // Read after readMeminfo(), before a limit cgroup caps memTotalMiB: the
+    // pool limit is a share of physical RAM
+    m_zswap.poolMiB = m_mem.mib(MeminfoField::Zswap);
+    m_zswap.storedMiB = m_mem.mib(MeminfoField::Zswapped);
+    m_zswap.poolLimitMiB = m_mem.memTotalMiB * m_zswap.maxPoolPercent / 100.0;
+    m_zswap.poolUsedPercent = m_zswap.poolLimitMiB > 0 ? m_zswap.poolMiB * 100.0 / m_zswap.poolLimitMiB : 0;
+    m_zswap.compressionRatio = m_zswap.poolMiB > 0 ? m_zswap.storedMiB / m_zswap.poolMiB : 0;
+}
+
 void SystemSnapshot::readPsi() {
-    QFile f(m_procRoot + QStringLiteral("/pressure/memory"));
-    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!m_reader->ok(m_psiSlot)) {
         m_psi = {};
         return;
     }
     // GCOVR_EXCL_START
-    QTextStream ts(&f);
-    while (!ts.atEnd()) {
-        const QString line = ts.readLine().trimmed();
-        if (line.startsWith(QStringLiteral("some "))) {
-            QRegularExpression re(R"(avg10=([0-9\.]+))");
-            auto m = re.match(line);
-            if (m.hasMatch()) m_psi.some_avg10 = m.captured(1).toDouble();
-        } else if (line.startsWith(QStringLiteral("full "))) {
-            QRegularExpression re(R"(avg10=([0-9\.]+))");
-            auto m = re.match(line);
-            if (m.hasMatch()) m_psi.full_avg10 = m.captured(1).toDouble();
+    ProcParse::forEachLine(m_reader->data(m_psiSlot), [&](QByteArrayView line) {
+        line = ProcParse::trimmed(line);
+        if (line.startsWith("some "))
+            m_psi.some_avg10 = ProcParse::keyedValue(line, "avg10=", m_psi.some_avg10);
+        else if (line.startsWith("full "))
+            m_psi.full_avg10 = ProcParse::keyedValue(line, "avg10=", m_psi.full_avg10);
+    });
+    // GCOVR_EXCL_STOP
+}
+
+namespace {
+// The /proc/vmstat counters behind VmstatInfo. Several keys feed one
+// counter: background reclaim is kswapd plus khugepaged, and kernels before
+// 5.9 only have the combined workingset_refault.
+enum VmCounter { MajFault, SwapIn, SwapOut, RefaultAnon, RefaultFile, OomKill,
+                 ScanBackground, ScanDirect, StealBackground, StealDirect, VmCounterCount };
+
+struct VmKey {
+    std::string_view key;
+    VmCounter counter;
+};
+
+// Sorted by key for the binary search in readVmstat()
+constexpr VmKey kVmstatKeys[] = {
+    {"oom_kill", OomKill},
+    {"pgmajfault", MajFault},
+    {"pgscan_direct", ScanDirect},
+    {"pgscan_khugepaged", ScanBackground},
+    {"pgscan_kswapd", ScanBackground},
+    {"pgsteal_direct", StealDirect},
+    {"pgsteal_khugepaged", StealBackground},
+    {"pgsteal_kswapd", StealBackground},
+    {"pswpin", SwapIn},
+    {"pswpout", SwapOut},
+    {"workingset_refault", RefaultFile},
+    {"workingset_refault_anon", RefaultAnon},
+    {"workingset_refault_file", RefaultFile},
+};
+constexpr bool byKey(const VmKey& a, const VmKey& b) { return a.key < b.key; }
+static_assert(std::is_sorted(std::begin(kVmstatKeys), std::end(kVmstatKeys), byKey));
+} // namespace
+
+void SystemSnapshot::readVmstat() {
+    static_assert(VmCounterCount == kVmstatCounters);
+    if (!m_reader->ok(m_vmstatSlot)) {
+        m_vmstat = {};
+        m_vmstatPrevMs = 0;
+        return;
+    }
+    // One pass over ~180 lines; the table lookup is a handful of compares
+    std::array<quint64, kVmstatCounters> now {};
+    ProcParse::forEachLine(m_reader->data(m_vmstatSlot), [&](QByteArrayView line) {
+        qsizetype pos = 0;
+        const QByteArrayView key = ProcParse::nextField(line, &pos);
+        const std::string_view k(key.data(), static_cast<size_t>(key.size()));
+        const VmKey* it = std::lower_bound(std::begin(kVmstatKeys), std::end(kVmstatKeys), VmKey{k, OomKill}, byKey);
+        if (it == std::end(kVmstatKeys) || it->key != k) return;
+        now[it->counter] += static_cast<quint64>(ProcParse::toInt64(ProcParse::nextField(line, &pos)));
+    });
+    m_vmstat.oomKills = static_cast<qint64>(now[OomKill]);
+
+    // Rates need a window long enough to smooth over the 10 Hz sampling;
+    // until it has passed the previous rates stand
+    const qint64 elapsedMs = m_sampledAtMs - m_vmstatPrevMs;
+    if (m_vmstatPrevMs > 0 && elapsedMs < kRateWindowMs) return;
+    if (m_vmstatPrevMs > 0) {
+        static const double pageMiB = static_cast<double>(::sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+        const double seconds = elapsedMs / 1000.0;
+        auto rate = [&](VmCounter c) {
+            // A counter going backwards means a fake tree was rewritten, not a rate
+            return now[c] >= m_vmstatPrev[c] ? (now[c] - m_vmstatPrev[c]) / seconds : 0.0;
+        };
+        m_vmstat.present = true;
+        m_vmstat.majorFaultsPerSec = rate(MajFault);
+        m_vmstat.swapInMiBPerSec = rate(SwapIn) * pageMiB;
+        m_vmstat.swapOutMiBPerSec = rate(SwapOut) * pageMiB;
+        m_vmstat.refaultAnonMiBPerSec = rate(RefaultAnon) * pageMiB;
+        m_vmstat.refaultFileMiBPerSec = rate(RefaultFile) * pageMiB;
+        m_vmstat.directScanPerSec = rate(ScanDirect);
+        m_vmstat.scanPerSec = rate(ScanBackground) + m_vmstat.directScanPerSec;
+        m_vmstat.stealPerSec = rate(StealBackground) + rate(StealDirect);
+    }
+    m_vmstatPrev = now;
+    m_vmstatPrevMs = m_sampledAtMs;
+}
+
+void SystemSnapshot::readNuma() {
+    m_numa = {};
+    if (m_nodeSlots.empty()) return;
+    static constexpr MeminfoMask kNodeFields = meminfoBits({MeminfoField::MemTotal, MeminfoField::MemFree,
+                                                            MeminfoField::FilePages, MeminfoField::Active,
+                                                            MeminfoField::Inactive, MeminfoField::InactiveFile});
+    // Fixed room for the hosts this is meant for; past that a node takes
+    // the slot of the least constrained one, so all are still ranked
+    NumaNode all[64];
+    int count = 0; // in all
+    int nodes = 0; // with memory
+    for (const NodeSlots& slots : m_nodeSlots) {
+        if (!m_reader->ok(slots.meminfo)) continue;
+        std::array<double, static_cast<int>(MeminfoField::Count)> kib {};
+        // "Node 0 MemFree:  1234 kB"
+        MeminfoTable::parse(m_reader->data(slots.meminfo), kNodeFields, kib.data(), 2);
+        auto mib = [&](MeminfoField f) { return kib[static_cast<int>(f)] / 1024.0; };
+        NumaNode n;
+        n.id = slots.id;
+        n.totalMiB = mib(MeminfoField::MemTotal);
+        // Memoryless nodes (CPU-only, some CXL and EPYC setups) have nothing to run out of
+        if (n.totalMiB <= 0) continue;
+        n.freeMiB = mib(MeminfoField::MemFree);
+        n.filePagesMiB = mib(MeminfoField::FilePages);
+        n.activeMiB = mib(MeminfoField::Active);
+        n.inactiveMiB = mib(MeminfoField::Inactive);
+        n.availableMiB = n.freeMiB + mib(MeminfoField::InactiveFile);
+        n.availablePercent = n.availableMiB * 100.0 / n.totalMiB;
+        if (m_reader->ok(slots.numastat)) {
+            ProcParse::forEachLine(m_reader->data(slots.numastat), [&](QByteArrayView line) {
+                qsizetype pos = 0;
+                const QByteArrayView key = ProcParse::nextField(line, &pos);
+                if (key == "numa_miss") n.numaMiss = ProcParse::toInt64(ProcParse::nextField(line, &pos));
+                else if (key == "numa_foreign") n.numaForeign = ProcParse::toInt64(ProcParse::nextField(line, &pos));
+            });
+        }
+        ++nodes;
+        if (count < static_cast<int>(std::size(all))) {
+            all[count++] = n;
+            continue;
         }
+        NumaNode* roomiest = std::max_element(all, all + count, [](const NumaNode& a, const NumaNode& b) {
+            return a.availablePercent < b.availablePercent;
+        });
+        if (n.availablePercent < roomiest->availablePercent) *roomiest = n;
+    }
+    if (nodes < 2) return;
+
+    const int shown = std::min(count, NumaInfo::kNodes);
+    std::partial_sort(all, all + shown, all + count, [](const NumaNode& a, const NumaNode& b) {
+        return a.availablePercent < b.availablePercent;
+    });
+    m_numa.present = true;
+    m_numa.nodeCount = nodes;
+    m_numa.shown = shown;
+    std::copy(all, all + shown, m_numa.nodes);
+}
+
+static constexpr double kBytesPerMiB = 1024.0 * 1024.0;
+
+// Copy into a fixed buffer keeping the tail, the leaf is the interesting end
+template <size_t N>
+static void copyTail(char (&dst)[N], const QByteArray& src) {
+    const qsizetype cap = N - 1;
+    const qsizetype from = src.size() > cap ? src.size() - cap : 0;
+    std::memset(dst, 0, N);
+    std::memcpy(dst, src.constData() + from, static_cast<size_t>(src.size() - from));
+}
+
+static void fillEntry(CgroupEntry* e, const CgroupUsage& u) {
+    copyTail(e->path, QFile::encodeName(u.path.isEmpty() ? QStringLiteral("/") : u.path));
+    e->currentMiB = u.currentBytes / kBytesPerMiB;
+    e->maxMiB = u.maxBytes >= 0 ? u.maxBytes / kBytesPerMiB : -1;
+    e->swapCurrentMiB = u.swapCurrentBytes / kBytesPerMiB;
+    e->someAvg10 = u.someAvg10;
+}
+
+void SystemSnapshot::readCgroups() {
+    m_cgroups = {};
+    if (!m_cgroupSampler) return;
+    m_cgroupSampler->sample();
+    if (m_cgroupSampler->usage().isEmpty()) return;
+
+    m_cgroups.present = true;
+    const QVector<CgroupUsage> slices = m_cgroupSampler->topChildren(CgroupInfo::kSlices);
+    for (const CgroupUsage& u : slices) fillEntry(&m_cgroups.slices[m_cgroups.sliceCount++], u);
+    const QVector<CgroupUsage> scopes = m_cgroupSampler->topLeaves(CgroupInfo::kScopes);
+    for (const CgroupUsage& u : scopes) fillEntry(&m_cgroups.scopes[m_cgroups.scopeCount++], u);
+}
+
+void SystemSnapshot::applyLimit() {
+    m_hostMem = m_mem;
+    m_limit = {};
+    if (m_limitLevels.empty()) return;
+
+    auto value = [&](int slot) -> qint64 {
+        return slot >= 0 && m_reader->ok(slot) ? ProcParse::cgroupValue(m_reader->data(slot)) : -1;
+    };
+    // The tightest limit anywhere on the path wins, and so does the level
+    // with the least room left, which need not be the same level
+    qint64 memMax = -1, memRoom = -1, swapMax = -1, swapRoom = -1;
+    auto tighten = [](qint64* limit, qint64* room, qint64 max, qint64 current) {
+        if (max < 0) return;
+        *limit = *limit < 0 ? max : std::min(*limit, max);
+        const qint64 left = std::max<qint64>(0, max - std::max<qint64>(0, current));
+        *room = *room < 0 ? left : std::min(*room, left);
+    };
+    for (const LimitLevel& l : m_limitLevels) {
+        tighten(&memMax, &memRoom, value(l.max), value(l.current));
+        tighten(&swapMax, &swapRoom, value(l.swapMax), value(l.swapCurrent));
+    }
+
+    const LimitLevel& self = m_limitLevels.back();
+    m_limit.present = true;
+    copyTail(m_limit.path, m_limitPath);
+    m_limit.memMaxMiB = memMax >= 0 ? memMax / kBytesPerMiB : -1;
+    m_limit.memCurrentMiB = std::max<qint64>(0, value(self.current)) / kBytesPerMiB;
+    m_limit.swapMaxMiB = swapMax >= 0 ? swapMax / kBytesPerMiB : -1;
+    m_limit.swapCurrentMiB = std::max<qint64>(0, value(self.swapCurrent)) / kBytesPerMiB;
+
+    // min(host, cgroup): a limit above physical RAM changes nothing
+    if (memMax >= 0) {
+        const double maxMiB = memMax / kBytesPerMiB;
+        const double roomMiB = memRoom / kBytesPerMiB;
+        m_mem.memTotalMiB = m_hostMem.memTotalMiB > 0 ? std::min(m_hostMem.memTotalMiB, maxMiB) : maxMiB;
+        m_mem.memAvailableMiB = m_hostMem.memTotalMiB > 0 ? std::min(m_hostMem.memAvailableMiB, roomMiB) : roomMiB;
+        m_mem.memAvailablePercent = m_mem.memTotalMiB > 0 ? m_mem.memAvailableMiB * 100.0 / m_mem.memTotalMiB : 0;
+    }
+    if (swapMax >= 0) {
+        const double maxMiB = swapMax / kBytesPerMiB;
+        const double roomMiB = swapRoom / kBytesPerMiB;
+        m_mem.swapTotalMiB = std::min(m_hostMem.swapTotalMiB, maxMiB);
+        m_mem.swapFreeMiB = std::min(m_hostMem.swapFreeMiB, roomMiB);
+        m_mem.swapFreePercent = m_mem.swapTotalMiB > 0 ? m_mem.swapFreeMiB * 100.0 / m_mem.swapTotalMiB : 0;
     }
-    // GCOVR_EXCL_STOP
 }
@@ -1,10 +1,16 @@
 // ===== src/SystemSnapshot.h =====
 #pragma once
+#include "MeminfoTable.h"
+#include "ProcReader.h"
 #include <QObject>
 #include <QString>
+#include <array>
+#include <memory>
 #include <optional>
+#include <vector>
 
-// Live system values, read on each poll
+// Live system values, read on each poll. With a limit cgroup set, these are
+// the effective values: min(host, cgroup) totals and the cgroup's headroom.
 struct MemInfo {
     double memTotalMiB {0};
     double memAvailableMiB {0};
@@ -12,6 +18,14 @@ struct MemInfo {
     double swapTotalMiB {0};
     double swapFreeMiB {0};
     double swapFreePercent {0};
+
+    // Every subscribed /proc/meminfo field as read, host-wide even when the
+    // totals above are capped by a limit cgroup
+    std::array<double, static_cast<int>(MeminfoField::Count)> fieldKiB {};
+    MeminfoMask fields {0};                    // the ones the kernel printed
+    bool has(MeminfoField f) const { return fields & meminfoBit(f); }
+    double kib(MeminfoField f) const { return fieldKiB[static_cast<int>(f)]; }
+    double mib(MeminfoField f) const { return kib(f) / 1024.0; }
 };
 
 struct ZramInfo {
@@ -23,32 +37,242 @@ struct ZramInfo {
     double logicalUsedPercent {0}; // origDataMiB / diskSizeMiB
 };
 
+// One line of /proc/swaps
+struct SwapDevice {
+    char path[64] {};              // as printed, tail kept if longer
+    bool file {false};             // swap file rather than a partition
+    bool zram {false};
+    double sizeMiB {0};
+    double usedMiB {0};
+    int priority {0};
+};
+
+// Per-device swap. Pages go to the highest priority device first, so disk
+// swap in use below a zram device means swap spilled to the slow device.
+struct SwapInfo {
+    static constexpr int kDevices = 8;
+    int deviceCount {0};           // all devices, devices holds the first kDevices
+    SwapDevice devices[kDevices];
+    double totalMiB {0};
+    double usedMiB {0};
+    double spilledMiB {0};         // used on disk devices below a zram device
+    bool spilled() const { return spilledMiB > 0; }
+};
+
+// zswap, the compressed cache in front of disk swap. Sizes come from the
+// Zswap/Zswapped lines of /proc/meminfo (kernel 5.19 and later).
+struct ZswapInfo {
+    bool   present {false};        // zswap module parameters readable
+    bool   enabled {false};
+    char   compressor[16] {};
+    double maxPoolPercent {0};     // pool limit, percent of RAM
+    double poolMiB {0};            // compressed size, RAM actually used
+    double storedMiB {0};          // uncompressed size of the pages held
+    double poolLimitMiB {0};       // maxPoolPercent of MemTotal
+    double poolUsedPercent {0};    // poolMiB / poolLimitMiB; at 100 stores go to disk
+    double compressionRatio {0};   // storedMiB / poolMiB, 0 while empty
+};
+
 struct PsiInfo {
     double some_avg10 {0};
     double full_avg10 {0};
 };
 
+// Paging and reclaim activity from /proc/vmstat, per second over the last
+// rate window. PSI says tasks are stalled, these say why.
+struct VmstatInfo {
+    bool present {false};          // /proc/vmstat readable and one window complete
+    double majorFaultsPerSec {0};
+    double swapInMiBPerSec {0};
+    double swapOutMiBPerSec {0};
+    double refaultAnonMiBPerSec {0}; // evicted pages needed again: thrashing
+    double refaultFileMiBPerSec {0};
+    double scanPerSec {0};         // pages scanned by kswapd, khugepaged and direct reclaim
+    double directScanPerSec {0};   // the part scanned by allocating tasks themselves
+    double stealPerSec {0};        // pages reclaimed
+    qint64 oomKills {0};           // since boot
+    double refaultMiBPerSec() const { return refaultAnonMiBPerSec + refaultFileMiBPerSec; }
+};
+
+// One NUMA node, from /sys/devices/system/node/nodeN/{meminfo,numastat}
+struct NumaNode {
+    int id {-1};
+    double totalMiB {0};
+    double freeMiB {0};
+    double filePagesMiB {0};
+    double activeMiB {0};
+    double inactiveMiB {0};
+    double availableMiB {0};       // MemFree + Inactive(file), a conservative estimate
+    double availablePercent {0};
+    qint64 numaMiss {0};           // allocations that wanted another node but landed here
+    qint64 numaForeign {0};        // allocations meant for this node that landed elsewhere
+};
+
+// Per-node view for multi-socket hosts, where one node can run dry while
+// the global numbers look fine. Nodes are sorted by availablePercent, so
+// nodes[0] is the most constrained.
+struct NumaInfo {
+    static constexpr int kNodes = 8;
+    bool present {false};          // enabled and more than one node with memory
+    int nodeCount {0};             // nodes with memory; memoryless ones are left out
+    int shown {0};                 // entries filled in nodes
+    NumaNode nodes[kNodes];
+};
+
+// One cgroup in the tooltip's top lists. Fixed size so SnapshotData stays
+// trivially copyable for the seqlock.
+struct CgroupEntry {
+    char path[112] {};             // relative to the cgroup root, tail kept if longer
+    double currentMiB {0};
+    double maxMiB {-1};            // -1 when unlimited
+    double swapCurrentMiB {0};
+    double someAvg10 {0};
+};
+
+// The memory.max / memory.swap.max in force for a chosen cgroup: the
+// tightest limit along its path to the root
+struct CgroupLimitInfo {
+    bool present {false};          // a limit cgroup is configured and exists
+    char path[112] {};             // the configured cgroup, tail kept if longer
+    double memMaxMiB {-1};         // -1 when no level sets a limit
+    double memCurrentMiB {0};      // memory.current of the cgroup itself
+    double swapMaxMiB {-1};
+    double swapCurrentMiB {0};
+};
+
+struct CgroupInfo {
+    static constexpr int kSlices = 4;
+    static constexpr int kScopes = 5;
+    bool present {false};          // sampling enabled and the subtree exists
+    int sliceCount {0};
+    int scopeCount {0};
+    CgroupEntry slices[kSlices];   // direct children of the sampled subtree
+    CgroupEntry scopes[kScopes];   // leaf cgroups: app scopes and services
+};
+
+// Plain-value copy of everything a single refresh produces, safe to hand
+// between threads.
+struct SnapshotData {
+    MemInfo mem;                   // effective
+    MemInfo hostMem;               // /proc/meminfo and /proc/swaps as read
+    CgroupLimitInfo limit;
+    SwapInfo swaps;
+    ZramInfo zram;
+    ZswapInfo zswap;
+    PsiInfo psi;
+    VmstatInfo vmstat;
+    NumaInfo numa;
+    CgroupInfo cgroups;
+    qint64 sampledAtMs {0};        // monotonic clock, the sample timeline
+};
+
+class CgroupSampler;
+
 class SystemSnapshot : public QObject {
     Q_OBJECT
 public:
     explicit SystemSnapshot(QObject* parent = nullptr);
     SystemSnapshot(const QString& procRoot, const QString& sysRoot, QObject* parent = nullptr);
+    // Read through a specific backend, e.g. to compare pread and io_uring
+    SystemSnapshot(const QString& procRoot, const QString& sysRoot,
+                   std::unique_ptr<ProcReader> reader, QObject* parent = nullptr);
+    ~SystemSnapshot() override;
 
-    void refresh();
+    // Also sample a cgroup v2 subtree on each refresh, e.g. "/" or "/user.slice"
+    void enableCgroups(const QString& cgroupRoot, const QString& subtree = QString());
 
-    const MemInfo& mem() const { return m_mem; }
+    // Judge memory against a cgroup's limits instead of the whole host, e.g.
+    // nohang's unit or the user slice; "self" means the cgroup this process
+    // runs in, read from <procRoot>/self/cgroup. An empty path turns it off.
+    void setLimitCgroup(const QString& cgroupRoot, const QString& path);
+
+    // Also parse these /proc/meminfo fields into MemInfo::fieldKiB. The
+    // totals behind memTotalMiB and friends are always read; other fields
+    // cost a table lookup per line only while someone has subscribed.
+    void subscribeMeminfo(MeminfoMask fields) { m_meminfoWanted |= fields; }
+    MeminfoMask meminfoFields() const { return m_meminfoWanted; }
+    static constexpr MeminfoMask kCoreMeminfo = meminfoBits({MeminfoField::MemTotal, MeminfoField::MemAvailable,
+                                                             MeminfoField::SwapTotal, MeminfoField::SwapFree});
+
+    // Also read per-node meminfo and numastat. Nodes are discovered once,
+    // here; on a single-node host this does nothing.
+    void enableNuma();
+
+    void refresh();                                // one batched read, then parse
+    void refreshAt(qint64 sampledAtMs);            // same, on a given clock, e.g. a replay's
+    const ProcReader& reader() const { return *m_reader; }
+
+    const MemInfo& mem() const { return m_mem; }          // effective, see MemInfo
+    const MemInfo& hostMem() const { return m_hostMem; }
+    const CgroupLimitInfo& limit() const { return m_limit; }
+    const SwapInfo& swaps() const { return m_swaps; }
     const ZramInfo& zram() const { return m_zram; }
+    const ZswapInfo& zswap() const { return m_zswap; }
     const PsiInfo& psi() const { return m_psi; }
+    const VmstatInfo& vmstat() const { return m_vmstat; }
+    const NumaInfo& numa() const { return m_numa; }
+    const CgroupInfo& cgroups() const { return m_cgroups; }
+
+    qint64 sampledAtMs() const { return m_sampledAtMs; }
+
+    SnapshotData data() const { return {m_mem, m_hostMem, m_limit, m_swaps, m_zram, m_zswap, m_psi, m_vmstat, m_numa, m_cgroups, m_sampledAtMs}; }
+    void assign(const SnapshotData& d);            // adopt values sampled elsewhere
+
+    static constexpr qint64 kRateWindowMs = 1000;  // vmstat rates span at least this
 
 private:
+    void registerFiles();
     void readMeminfo();
     void readSwaps();
+    void parseSwaps(QByteArrayView text);
     void readZram();
+    void readZswap();
     void readPsi();
+    void readVmstat();
+    void readNuma();
+    void readCgroups();
+    void applyLimit();
 
     QString m_procRoot{QStringLiteral("/proc")};
     QString m_sysRoot{QStringLiteral("/sys")};
+    std::unique_ptr<ProcReader> m_reader;
+    int m_meminfoSlot {-1};
+    int m_swapsSlot {-1};
+    int m_zramDiskSlot {-1};
+    int m_zramMmSlot {-1};
+    int m_zswapEnabledSlot {-1};
+    int m_zswapMaxPoolSlot {-1};
+    int m_zswapCompressorSlot {-1};
+    int m_psiSlot {-1};
+    int m_vmstatSlot {-1};
+    bool m_meminfoWarned {false};
+    MeminfoMask m_meminfoWanted {kCoreMeminfo | meminfoBits({MeminfoField::Zswap, MeminfoField::Zswapped})};
     MemInfo m_mem;
+    MemInfo m_hostMem;
+    SwapInfo m_swaps;
+    size_t m_swapsHash {0};                        // of the text m_swaps was parsed from
+    bool m_swapsParsed {false};
     ZramInfo m_zram;
+    ZswapInfo m_zswap;
     PsiInfo m_psi;
+    static constexpr int kVmstatCounters = 10;
+    std::array<quint64, kVmstatCounters> m_vmstatPrev {}; // counters at the window start
+    qint64 m_vmstatPrevMs {0};
+    VmstatInfo m_vmstat;
+    struct NodeSlots {
+        int id {-1};
+        int meminfo {-1};
+        int numastat {-1};
+    };
+    std::vector<NodeSlots> m_nodeSlots;
+    NumaInfo m_numa;
+    std::unique_ptr<CgroupSampler> m_cgroupSampler;
+    CgroupInfo m_cgroups;
+    struct LimitLevel {                            // ProcReader slots, -1 if absent
+        int max {-1}, current {-1}, swapMax {-1}, swapCurrent {-1};
+    };
+    std::vector<LimitLevel> m_limitLevels;         // cgroup root first, the cgroup itself last
+    QByteArray m_limitPath;
+    CgroupLimitInfo m_limit;
+    qint64 m_sampledAtMs {0};
 };
@@ -0,0 +1,155 @@
+// ===== src/ThresholdSimulator.cpp =====
+#include "pch.h"
+#include "ThresholdSimulator.h"
+#include "SystemSnapshot.h"
+#include "Thresholds.h"
+#include "TraceReplay.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+// One ThresholdSet as plain floats; an unset threshold is an infinity no
+// value can cross, so the classify loops need no branches for it
+struct Limits {
+    float memFloor[3];
+    float swapFloor[3];
+    float zramCeil[3];
+    float psiCeil[3];
+};
+
+constexpr float kInf = std::numeric_limits<float>::infinity();
+
+float floorOf(const ThresholdValue& v) { return v.mib ? static_cast<float>(*v.mib) : -kInf; }
+float ceilOf(const ThresholdValue& v) { return v.mib ? static_cast<float>(*v.mib) : kInf; }
+float ceilOf(const std::optional<double>& v) { return v ? static_cast<float>(*v) : kInf; }
+
+Limits limitsOf(const ThresholdSet& th) {
+    return {{floorOf(th.warn_mem_free), floorOf(th.soft_mem_free), floorOf(th.hard_mem_free)},
+            {floorOf(th.warn_swap_free), floorOf(th.soft_swap_free), floorOf(th.hard_swap_free)},
+            {ceilOf(th.warn_zram_used), ceilOf(th.soft_zram_used), ceilOf(th.hard_zram_used)},
+            {ceilOf(th.warn_psi), ceilOf(th.soft_psi), ceilOf(th.hard_psi)}};
+}
+
+// Highest level crossed for samples [begin, end): RAM, swap and zram into
+// level, PSI into psiLevel since psi_excess_duration applies to it alone.
+// Kept free of branches and aliasing so it vectorizes.
+void classify(const Limits& lim, int begin, int end, const float* __restrict mem,
+              const float* __restrict swap, const float* __restrict zram, const float* __restrict psi,
+              quint8* __restrict level, quint8* __restrict psiLevel) {
+    for (int i = begin; i < end; ++i) {
+        const float m = mem[i];
+        const float s = swap[i];
+        const float z = zram[i];
+        const int warn = (m < lim.memFloor[0]) | (s < lim.swapFloor[0]) | (z > lim.zramCeil[0]);
+        const int soft = (m < lim.memFloor[1]) | (s < lim.swapFloor[1]) | (z > lim.zramCeil[1]);
+        const int hard = (m < lim.memFloor[2]) | (s < lim.swapFloor[2]) | (z > lim.zramCeil[2]);
+        level[i] = static_cast<quint8>(std::max(std::max(warn, soft * 2), hard * 3));
+    }
+    for (int i = begin; i < end; ++i) {
+        const float p = psi[i];
+        const int warn = p > lim.psiCeil[0];
+        const int soft = p > lim.psiCeil[1];
+        const int hard = p > lim.psiCeil[2];
+        psiLevel[i] = static_cast<quint8>(std::max(std::max(warn, soft * 2), hard * 3));
+    }
+}
+} // namespace
+
+void ThresholdSimulator::append(qint64 atMs, const Sample& s) {
+    const int i = size();
+    if (m_segments.empty() || m_segments.back().memTotalMiB != s.memTotalMiB ||
+        m_segments.back().swapTotalMiB != s.swapTotalMiB || m_segments.back().zramDiskMiB != s.zramDiskMiB)
+        m_segments.push_back({i, s.memTotalMiB, s.swapTotalMiB, s.zramDiskMiB});
+    m_time.push_back(atMs);
+    m_memAvailable.push_back(s.memAvailableMiB);
+    m_swapFree.push_back(s.swapFreeMiB);
+    m_zramUsed.push_back(s.zramUsedMiB);
+    m_psiSome.push_back(s.psiSomeAvg10);
+    m_psiFull.push_back(s.psiFullAvg10);
+}
+
+void ThresholdSimulator::append(const SystemSnapshot& snap) {
+    Sample s;
+    s.memAvailableMiB = static_cast<float>(snap.mem().memAvailableMiB);
+    s.swapFreeMiB = static_cast<float>(snap.mem().swapFreeMiB);
+    s.zramUsedMiB = static_cast<float>(snap.zram().origDataMiB);
+    s.psiSomeAvg10 = static_cast<float>(snap.psi().some_avg10);
+    s.psiFullAvg10 = static_cast<float>(snap.psi().full_avg10);
+    s.memTotalMiB = static_cast<float>(snap.mem().memTotalMiB);
+    s.swapTotalMiB = static_cast<float>(snap.mem().swapTotalMiB);
+    s.zramDiskMiB = static_cast<float>(snap.zram().diskSizeMiB);
+    append(snap.sampledAtMs(), s);
+}
+
+void ThresholdSimulator::reserve(int samples) {
+    m_time.reserve(samples);
+    for (auto* v : {&m_memAvailable, &m_swapFree, &m_zramUsed, &m_psiSome, &m_psiFull}) v->reserve(samples);
+}
+
+void ThresholdSimulator::clear() {
+    m_time.clear();
+    for (auto* v : {&m_memAvailable, &m_swapFree, &m_zramUsed, &m_psiSome, &m_psiFull}) v->clear();
+    m_segments.clear();
+}
+
+bool ThresholdSimulator::loadTrace(const QString& path, QString* error) {
+    TraceReplay replay;
+    if (!replay.open(path, error)) return false;
+    clear();
+    reserve(replay.trace().frameCount());
+    const SystemSnapshot& snap = replay.snapshot();
+    QObject::connect(&replay, &TraceReplay::sampled, [&] { append(snap); });
+    replay.run();
+    return true;
+}
+
+ThresholdSimulator::Result ThresholdSimulator::evaluate(const ThresholdsPercent& t) const {
+    Result r;
+    const int n = size();
+    if (n == 0) return r;
+
+    std::vector<quint8> level(static_cast<size_t>(n));
+    std::vector<quint8> psiLevel(static_cast<size_t>(n));
+    // The PSI series is chosen as SeverityEngine::psiValue does
+    const bool some = t.psi_metrics == QStringLiteral("some") || t.psi_metrics.startsWith(QStringLiteral("some_"));
+    const float* psi = some ? m_psiSome.data() : m_psiFull.data();
+    for (size_t k = 0; k < m_segments.size(); ++k) {
+        const Segment& seg = m_segments[k];
+        const int end = k + 1 < m_segments.size() ? m_segments[k + 1].begin : n;
+        const Limits lim = limitsOf(Thresholds::compute(t, seg.memTotalMiB, seg.swapTotalMiB, seg.zramDiskMiB));
+        classify(lim, seg.begin, end, m_memAvailable.data(), m_swapFree.data(), m_zramUsed.data(), psi,
+                 level.data(), psiLevel.data());
+    }
+
+    // Events, durations and psi_excess_duration need the previous sample
+    const qint64 holdMs = t.psi_duration ? std::llround(*t.psi_duration * 1000) : 0;
+    std::array<qint64, LevelCount> psiSince {-1, -1, -1, -1};
+    int prev = 0;
+    for (int i = 0; i < n; ++i) {
+        const qint64 now = m_time[i];
+        int psiHeld = psiLevel[i];
+        if (holdMs > 0) {
+            psiHeld = 0;
+            for (int l = Warn; l < LevelCount; ++l) {
+                if (psiLevel[i] < l) {
+                    psiSince[l] = -1;
+                    continue;
+                }
+                if (psiSince[l] < 0) psiSince[l] = now;
+                if (now - psiSince[l] >= holdMs) psiHeld = l;
+            }
+        }
+        const int cur = std::max<int>(level[i], psiHeld);
+        const qint64 dt = i + 1 < n ? std::clamp<qint64>(m_time[i + 1] - now, 0, kMaxGapMs) : 0;
+        for (int l = Warn; l <= cur; ++l) {
+            if (prev < l) {
+                ++r.events[l];
+                r.startsMs[l].push_back(now);
+            }
+            r.durationMs[l] += dt;
+        }
+        prev = cur;
+    }
+    return r;
+}
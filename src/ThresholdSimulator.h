@@ -0,0 +1,76 @@
+// ===== src/ThresholdSimulator.h =====
+#pragma once
+#include "NoHangConfig.h"
+#include <QString>
+#include <QtGlobal>
+#include <array>
+#include <vector>
+
+class SystemSnapshot;
+
+// ThresholdSimulator answers "what would this config have done" over a
+// recorded history, for tuning thresholds before deploying them. Samples
+// are kept column by column; evaluate() runs Thresholds::compute once per
+// stretch of unchanged totals (RAM, swap and zram sizes), then classifies
+// every sample against the resulting limits in branch-free loops over the
+// contiguous columns, which the compiler vectorizes. A scalar pass over the
+// per-sample levels applies psi_excess_duration and collects the events.
+//
+// Levels are judged like TrayApp::iconNameFor, without SeverityEngine's
+// hysteresis: a sample is at the highest level whose RAM or swap floor it
+// is below, or whose zram or PSI ceiling it is above.
+class ThresholdSimulator {
+public:
+    enum Level { Warn = 1, Soft, Hard, LevelCount };
+
+    struct Sample {
+        float memAvailableMiB {0};
+        float swapFreeMiB {0};
+        float zramUsedMiB {0};
+        float psiSomeAvg10 {0};
+        float psiFullAvg10 {0};
+        float memTotalMiB {0};
+        float swapTotalMiB {0};
+        float zramDiskMiB {0};
+    };
+
+    struct Result {
+        // Indexed by Level; index 0 is unused. An event is an entry into the
+        // level or above, so a jump from normal to hard counts at all three.
+        std::array<int, LevelCount> events {};
+        std::array<qint64, LevelCount> durationMs {}; // time at the level or above
+        std::array<std::vector<qint64>, LevelCount> startsMs; // when each event began
+    };
+
+    // A gap in the recording (suspend, tray restart) counts as this much at most
+    static constexpr qint64 kMaxGapMs = 5000;
+
+    void append(qint64 atMs, const Sample& s);
+    void append(const SystemSnapshot& snap);          // at its sampledAtMs
+    void reserve(int samples);
+    void clear();
+
+    // Replay a capture trace (see Trace) into the history, replacing it
+    bool loadTrace(const QString& path, QString* error = nullptr);
+
+    int size() const { return static_cast<int>(m_time.size()); }
+    qint64 timeMs(int i) const { return m_time[i]; }
+
+    Result evaluate(const ThresholdsPercent& t) const;
+
+private:
+    struct Segment {
+        int begin;                                     // first sample with these totals
+        float memTotalMiB;
+        float swapTotalMiB;
+        float zramDiskMiB;
+    };
+
+    std::vector<qint64> m_time;
+    std::vector<float> m_memAvailable;
+    std::vector<float> m_swapFree;
+    std::vector<float> m_zramUsed;
+    std::vector<float> m_psiSome;
+    std::vector<float> m_psiFull;
+    std::vector<Segment> m_segments;                   // totals rarely change
+};
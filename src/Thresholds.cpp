@@ -16,22 +16,27 @@ static ThresholdValue makeVal(std::optional<double> raw, double totalMiB) {
 }
 
 ThresholdSet Thresholds::compute(const ThresholdsPercent& t, const SystemSnapshot& snap) {
+    return compute(t, snap.mem().memTotalMiB, snap.mem().swapTotalMiB, snap.zram().diskSizeMiB);
+}
+
+ThresholdSet Thresholds::compute(const ThresholdsPercent& t, double memTotalMiB, double swapTotalMiB,
+                                 double zramDiskMiB) {
     ThresholdSet out;
     // RAM and Swap thresholds are free space floors
-    out.warn_mem_free  = makeVal(t.warn_mem_percent,  snap.mem().memTotalMiB);
-    out.warn_swap_free = makeVal(t.warn_swap_percent_free, snap.mem().swapTotalMiB);
+    out.warn_mem_free  = makeVal(t.warn_mem_percent,  memTotalMiB);
+    out.warn_swap_free = makeVal(t.warn_swap_percent_free, swapTotalMiB);
     // ZRAM thresholds are used percent of logical disksize
-    out.warn_zram_used = makeVal(t.warn_zram_percent_used, snap.zram().diskSizeMiB);
+    out.warn_zram_used = makeVal(t.warn_zram_percent_used, zramDiskMiB);
     out.warn_psi       = (t.warn_psi && *t.warn_psi != 0) ? t.warn_psi : std::nullopt;
 
-    out.soft_mem_free  = makeVal(t.soft_mem_percent,  snap.mem().memTotalMiB);
-    out.soft_swap_free = makeVal(t.soft_swap_percent_free, snap.mem().swapTotalMiB);
-    out.soft_zram_used = makeVal(t.soft_zram_percent_used, snap.zram().diskSizeMiB);
+    out.soft_mem_free  = makeVal(t.soft_mem_percent,  memTotalMiB);
+    out.soft_swap_free = makeVal(t.soft_swap_percent_free, swapTotalMiB);
+    out.soft_zram_used = makeVal(t.soft_zram_percent_used, zramDiskMiB);
     out.soft_psi       = (t.soft_psi && *t.soft_psi != 0) ? t.soft_psi : std::nullopt;
 
-    out.hard_mem_free  = makeVal(t.hard_mem_percent,  snap.mem().memTotalMiB);
-    out.hard_swap_free = makeVal(t.hard_swap_percent_free, snap.mem().swapTotalMiB);
-    out.hard_zram_used = makeVal(t.hard_zram_percent_used, snap.zram().diskSizeMiB);
+    out.hard_mem_free  = makeVal(t.hard_mem_percent,  memTotalMiB);
+    out.hard_swap_free = makeVal(t.hard_swap_percent_free, swapTotalMiB);
+    out.hard_zram_used = makeVal(t.hard_zram_percent_used, zramDiskMiB);
     out.hard_psi       = (t.hard_psi && *t.hard_psi != 0) ? t.hard_psi : std::nullopt;
 
     out.psi_metrics    = t.psi_metrics;
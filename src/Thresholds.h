@@ -33,4 +33,7 @@ struct ThresholdSet {
 class Thresholds {
 public:
     static ThresholdSet compute(const ThresholdsPercent& t, const SystemSnapshot& snap);
+    // The same from totals alone, for samples that are no longer a snapshot
+    static ThresholdSet compute(const ThresholdsPercent& t, double memTotalMiB, double swapTotalMiB,
+                                double zramDiskMiB);
 };
@@ -4,7 +4,9 @@
 #include "NoHangConfig.h"
 #include "SystemSnapshot.h"
 #include "Thresholds.h"
+#include "TopConsumers.h"
 #include <QStringBuilder>
+#include <algorithm>
 
 TooltipBuilder::TooltipBuilder(QObject* parent) : QObject(parent) {}
 
@@ -14,7 +16,8 @@ static QString fmtPct(double v) { return QString::number(v, 'f', 1) + " %"; }
 QString TooltipBuilder::build(const NoHangConfig& cfg,
                               const SystemSnapshot& snap,
                               bool active,
-                              const QString& cfgPath) const
+                              const QString& cfgPath,
+                              const TopConsumersResult* top) const
 {
     const ThresholdSet th = Thresholds::compute(cfg.thresholds(), snap);
 
@@ -35,23 +38,103 @@ QString TooltipBuilder::build(const NoHangConfig& cfg,
         }
     };
 
+    // cgroup limit in force; RAM and swap below are then min(host, cgroup)
+    const CgroupLimitInfo& lim = snap.limit();
+    if (lim.present && (lim.memMaxMiB >= 0 || lim.swapMaxMiB >= 0)) {
+        s += "Limit: " + QString::fromUtf8(lim.path);
+        if (lim.memMaxMiB >= 0) s += ", memory.max " + fmtMiB(lim.memMaxMiB);
+        s += ", current " + fmtMiB(lim.memCurrentMiB);
+        if (lim.swapMaxMiB >= 0) s += ", swap.max " + fmtMiB(lim.swapMaxMiB);
+        s += " (host RAM " + fmtMiB(snap.hostMem().memTotalMiB) + ")\n";
+    }
+
     // RAM
     s += "RAM: available " + fmtMiB(snap.mem().memAvailableMiB) + " (" + fmtPct(snap.mem().memAvailablePercent) + ")\n";
 
+    // The most constrained NUMA node, when there is more than one
+    const NumaInfo& numa = snap.numa();
+    if (numa.present && numa.shown > 0) {
+        const NumaNode& n = numa.nodes[0];
+        s += "NUMA: node " + QString::number(n.id) + " of " + QString::number(numa.nodeCount) + " lowest, available " +
+             fmtMiB(n.availableMiB) + " (" + fmtPct(n.availablePercent) + "), free " + fmtMiB(n.freeMiB) +
+             ", file " + fmtMiB(n.filePagesMiB);
+        if (n.numaForeign > 0) s += ", foreign allocations " + QString::number(n.numaForeign);
+        s += "\n";
+    }
+
+    // Where the memory is: page cache that reclaim can drop (unless dirty),
+    // and anon memory that can only go to swap
+    const MemInfo& m = snap.hostMem();
+    if (m.has(MeminfoField::ActiveFile) && m.has(MeminfoField::InactiveFile)) {
+        s += "Cache: active " + fmtMiB(m.mib(MeminfoField::ActiveFile)) + ", inactive " +
+             fmtMiB(m.mib(MeminfoField::InactiveFile));
+        if (m.has(MeminfoField::Dirty)) s += ", dirty " + fmtMiB(m.mib(MeminfoField::Dirty));
+        if (m.kib(MeminfoField::Writeback) > 0) s += ", writeback " + fmtMiB(m.mib(MeminfoField::Writeback));
+        if (m.has(MeminfoField::Shmem)) s += ", shmem " + fmtMiB(m.mib(MeminfoField::Shmem));
+        if (m.has(MeminfoField::SReclaimable)) s += ", slab reclaimable " + fmtMiB(m.mib(MeminfoField::SReclaimable));
+        s += "\n";
+    }
+    if (m.has(MeminfoField::ActiveAnon) && m.has(MeminfoField::InactiveAnon)) {
+        s += "Anon: active " + fmtMiB(m.mib(MeminfoField::ActiveAnon)) + ", inactive " +
+             fmtMiB(m.mib(MeminfoField::InactiveAnon));
+        if (m.kib(MeminfoField::AnonHugePages) > 0) s += ", THP " + fmtMiB(m.mib(MeminfoField::AnonHugePages));
+        if (m.kib(MeminfoField::SwapCached) > 0) s += ", swap cached " + fmtMiB(m.mib(MeminfoField::SwapCached));
+        s += "\n";
+    }
+
     // Swap
     s += "Swap: total " + fmtMiB(snap.mem().swapTotalMiB) + ", free " + fmtMiB(snap.mem().swapFreeMiB) + " (" + fmtPct(snap.mem().swapFreePercent) + ")\n";
 
+    // Swap devices, worth listing once there is more than one
+    const SwapInfo& sw = snap.swaps();
+    if (sw.deviceCount > 1) {
+        for (int i = 0; i < std::min(sw.deviceCount, SwapInfo::kDevices); ++i) {
+            const SwapDevice& d = sw.devices[i];
+            s += "  " + QString::fromUtf8(d.path) + " (" + (d.zram ? "zram" : d.file ? "file" : "partition") +
+                 ", prio " + QString::number(d.priority) + ") " + fmtMiB(d.usedMiB) + " of " + fmtMiB(d.sizeMiB) + "\n";
+        }
+    }
+    if (sw.spilled()) s += "Spilled to disk swap: " + fmtMiB(sw.spilledMiB) + "\n";
+
     // ZRAM
     if (snap.zram().present) {
         s += "ZRAM: size " + fmtMiB(snap.zram().diskSizeMiB) + ", logical used " + fmtMiB(snap.zram().origDataMiB) + " (" + fmtPct(snap.zram().logicalUsedPercent) + "), physical used " + fmtMiB(snap.zram().memUsedTotalMiB) + "\n";
     }
 
+    // zswap
+    const ZswapInfo& zs = snap.zswap();
+    if (zs.present && (zs.enabled || zs.poolMiB > 0)) {
+        s += "zswap: pool " + fmtMiB(zs.poolMiB);
+        if (zs.poolLimitMiB > 0)
+            s += " of " + fmtMiB(zs.poolLimitMiB) + " (" + fmtPct(zs.poolUsedPercent) + ")";
+        s += ", stored " + fmtMiB(zs.storedMiB);
+        if (zs.compressionRatio > 0) s += ", ratio " + QString::number(zs.compressionRatio, 'f', 1);
+        if (zs.compressor[0]) s += ", " + QString::fromLatin1(zs.compressor);
+        if (!zs.enabled) s += ", disabled";
+        s += "\n";
+    }
+
     // PSI
     s += "PSI: full avg10 " + QString::number(snap.psi().full_avg10, 'f', 2) + ", some avg10 " + QString::number(snap.psi().some_avg10, 'f', 2);
     if (!cfg.thresholds().psi_metrics.isEmpty()) s += ", metric " + cfg.thresholds().psi_metrics;
     if (th.psi_duration) s += ", duration " + QString::number(*th.psi_duration, 'f', 0) + " s";
     s += "\n";
 
+    // Paging and reclaim rates, why PSI is up
+    const VmstatInfo& vm = snap.vmstat();
+    if (vm.present) {
+        auto rate = [](double v) { return QString::number(v, 'f', 1); };
+        s += "Paging: swap in " + rate(vm.swapInMiBPerSec) + " MiB/s, out " + rate(vm.swapOutMiBPerSec) +
+             " MiB/s, refaults " + rate(vm.refaultMiBPerSec()) + " MiB/s, major faults " +
+             QString::number(vm.majorFaultsPerSec, 'f', 0) + "/s\n";
+        if (vm.scanPerSec > 0) {
+            s += "Reclaim: scanned " + QString::number(vm.scanPerSec, 'f', 0) + " pages/s";
+            if (vm.directScanPerSec > 0) s += " (direct " + QString::number(vm.directScanPerSec, 'f', 0) + ")";
+            s += ", efficiency " + fmtPct(vm.stealPerSec * 100.0 / vm.scanPerSec) + "\n";
+        }
+        if (vm.oomKills > 0) s += "OOM kills since boot: " + QString::number(vm.oomKills) + "\n";
+    }
+
     // Thresholds after current values
     s += "Thresholds:\n";
     appendThreshold("  RAM warn if free < ", th.warn_mem_free);
@@ -72,5 +155,34 @@ QString TooltipBuilder::build(const NoHangConfig& cfg,
     if (th.hard_psi)
         s += "  PSI hard action if > " + QString::number(*th.hard_psi, 'f', 0) + "\n";
 
+    // cgroup v2 slices and the busiest scopes inside them
+    const CgroupInfo& cg = snap.cgroups();
+    auto appendCgroup = [&](const CgroupEntry& e, bool leafOnly) {
+        QString name = QString::fromUtf8(e.path);
+        if (leafOnly) name = name.section(QLatin1Char('/'), -1);
+        s += "  " + name + " " + fmtMiB(e.currentMiB);
+        if (e.maxMiB >= 0) s += " / " + fmtMiB(e.maxMiB);
+        if (e.swapCurrentMiB > 0) s += ", swap " + fmtMiB(e.swapCurrentMiB);
+        s += ", PSI some " + QString::number(e.someAvg10, 'f', 2) + "\n";
+    };
+    if (cg.present && cg.sliceCount > 0) {
+        s += "Slices:\n";
+        for (int i = 0; i < cg.sliceCount; ++i) appendCgroup(cg.slices[i], false);
+    }
+    if (cg.present && cg.scopeCount > 0) {
+        s += "Top scopes:\n";
+        for (int i = 0; i < cg.scopeCount; ++i) appendCgroup(cg.scopes[i], true);
+    }
+
+    // Top consumers, only present while severity is above normal
+    if (top && !top->byMemory.isEmpty()) {
+        s += "Top memory (RSS + swap):\n";
+        for (const ProcessInfo& p : top->byMemory)
+            s += "  " + p.name + " [" + QString::number(p.pid) + "] " + fmtMiB(TopConsumers::memoryKiB(p) / 1024.0) + "\n";
+        s += "Likely OOM victims (oom_score):\n";
+        for (const ProcessInfo& p : top->byOomScore)
+            s += "  " + p.name + " [" + QString::number(p.pid) + "] " + QString::number(p.oomScore) + "\n";
+    }
+
     return s;
 }
@@ -1,10 +1,12 @@
 // ===== src/TooltipBuilder.h =====
 #pragma once
+#include "MeminfoTable.h"
 #include <QObject>
 #include <QString>
 
 class NoHangConfig;
 class SystemSnapshot;
+struct TopConsumersResult; // from TopConsumers.h
 
 class TooltipBuilder : public QObject {
     Q_OBJECT
@@ -15,8 +17,17 @@ public:
     // 1) status and config path
     // 2) thresholds with percent and MiB equivalents
     // 3) current values and a short hint about the next action
+    // 4) optionally, the largest processes and nohang's likely victims
     QString build(const NoHangConfig& cfg,
                   const SystemSnapshot& snap,
                   bool active,
-                  const QString& cfgPath) const;
+                  const QString& cfgPath,
+                  const TopConsumersResult* top = nullptr) const;
+
+    // /proc/meminfo fields the breakdown lines use, for
+    // SystemSnapshot::subscribeMeminfo()
+    static constexpr MeminfoMask kMeminfoFields = meminfoBits({
+        MeminfoField::ActiveFile, MeminfoField::InactiveFile, MeminfoField::ActiveAnon, MeminfoField::InactiveAnon,
+        MeminfoField::Dirty, MeminfoField::Writeback, MeminfoField::Shmem, MeminfoField::SwapCached,
+        MeminfoField::SReclaimable, MeminfoField::AnonHugePages});
 };
@@ -0,0 +1,68 @@
+// ===== src/TopConsumers.cpp =====
+#include "pch.h"
+#include "TopConsumers.h"
+#include <algorithm>
+
+// Reading the thread CPU clock is a syscall, so check it every few pids
+static constexpr qsizetype kPidsPerClockCheck = 8;
+
+TopConsumers::TopConsumers(const QString& procRoot, int count)
+    : m_scanner(procRoot, 1), m_count(std::max(count, 1)) {}
+
+void TopConsumers::reset() {
+    m_pids.clear();
+    m_next = 0;
+    m_filled = 0;
+    m_steps = 0;
+    m_cpuUs = 0;
+}
+
+bool TopConsumers::step(std::chrono::microseconds budget) {
+    const qint64 start = ProcessScanner::threadCpuUs();
+    if (!inPass()) {
+        reset();
+        m_pids = m_scanner.listPids();
+        if (m_rows.size() < static_cast<size_t>(m_pids.size())) m_rows.resize(m_pids.size());
+    }
+    ++m_steps;
+
+    for (qsizetype done = 1; m_next < m_pids.size(); ++done) {
+        // Slots are overwritten in place, their QStrings keep their capacity
+        if (m_scanner.readSummary(m_pids[m_next++], &m_rows[m_filled])) ++m_filled;
+        if (done % kPidsPerClockCheck == 0 && ProcessScanner::threadCpuUs() - start >= budget.count()) break;
+    }
+    m_cpuUs += ProcessScanner::threadCpuUs() - start;
+    if (inPass()) return false;
+
+    finishPass();
+    return true;
+}
+
+void TopConsumers::finishPass() {
+    m_order.resize(m_filled);
+    for (qsizetype i = 0; i < m_filled; ++i) m_order[i] = i;
+    const qsizetype n = std::min<qsizetype>(m_count, m_filled);
+    const auto top = m_order.begin() + n;
+
+    // Ties go to the lower pid so the lists do not flicker between passes
+    std::partial_sort(m_order.begin(), top, m_order.end(), [&](qsizetype a, qsizetype b) {
+        const qint64 ma = memoryKiB(m_rows[a]), mb = memoryKiB(m_rows[b]);
+        return ma != mb ? ma > mb : m_rows[a].pid < m_rows[b].pid;
+    });
+    m_result.byMemory.clear();
+    for (auto it = m_order.begin(); it != top; ++it) m_result.byMemory.push_back(m_rows[*it]);
+
+    auto byOom = [&](qsizetype a, qsizetype b) {
+        const ProcessInfo& pa = m_rows[a];
+        const ProcessInfo& pb = m_rows[b];
+        return pa.oomScore != pb.oomScore ? pa.oomScore > pb.oomScore : pa.pid < pb.pid;
+    };
+    if (n > 0 && n < m_filled) std::nth_element(m_order.begin(), top - 1, m_order.end(), byOom);
+    std::sort(m_order.begin(), top, byOom);
+    m_result.byOomScore.clear();
+    for (auto it = m_order.begin(); it != top; ++it) m_result.byOomScore.push_back(m_rows[*it]);
+
+    m_result.scanned = m_filled;
+    m_result.steps = m_steps;
+    m_result.cpuUs = m_cpuUs;
+}
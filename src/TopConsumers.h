@@ -0,0 +1,49 @@
+// ===== src/TopConsumers.h =====
+#pragma once
+#include "ProcessScanner.h"
+#include <chrono>
+#include <vector>
+
+// Result of one complete pass over the proc root
+struct TopConsumersResult {
+    QVector<ProcessInfo> byMemory;   // RSS + swap, largest first
+    QVector<ProcessInfo> byOomScore; // oom_score, nohang's likely victim first
+    qsizetype scanned {0};           // processes read in the pass
+    int steps {0};                   // step() calls the pass was spread over
+    qint64 cpuUs {0};                // thread CPU time spent on the pass
+};
+
+// TopConsumers answers "who is eating RAM?" without a full process table.
+// A pass reads stat, status and oom_score per pid into an array that is
+// reused between passes, then ranks it with partial_sort and nth_element.
+// step() stops once its CPU time budget is spent and resumes where it left
+// off on the next call, so a caller can spread a pass over several ticks.
+// Not thread safe; use from one thread at a time.
+class TopConsumers {
+public:
+    explicit TopConsumers(const QString& procRoot = QStringLiteral("/proc"), int count = 5);
+
+    // Advance the current pass, or start a new one. Returns true when the
+    // pass completed and result() was updated.
+    bool step(std::chrono::microseconds budget);
+    void reset(); // drop the partial pass, keep the buffers
+
+    bool inPass() const { return m_next < m_pids.size(); }
+    const TopConsumersResult& result() const { return m_result; }
+
+    static qint64 memoryKiB(const ProcessInfo& p) { return p.rssKiB + p.swapKiB; }
+
+private:
+    void finishPass();
+
+    ProcessScanner m_scanner;
+    int m_count;
+    QVector<int> m_pids;
+    qsizetype m_next {0};
+    std::vector<ProcessInfo> m_rows;  // grows to the process count, never shrinks
+    std::vector<qsizetype> m_order;   // indices into m_rows for ranking
+    qsizetype m_filled {0};
+    int m_steps {0};
+    qint64 m_cpuUs {0};
+    TopConsumersResult m_result;
+};
@@ -0,0 +1,187 @@
+// ===== src/TraceReplay.cpp =====
+#include "pch.h"
+#include "TraceReplay.h"
+#include "ProcParse.h"
+#include "ProcReader.h"
+#include "SystemSnapshot.h"
+#include <QTimer>
+#include <algorithm>
+#include <cstring>
+
+// Serves the current frame's contents to SystemSnapshot in place of reads
+class ReplayReader final : public ProcReader {
+public:
+    Backend backend() const override { return Backend::Replay; }
+
+    void setFiles(const std::vector<Trace::File>* files) { m_files = files; }
+
+    void readAll() override {
+        for (Slot& s : m_slots) {
+            s.len = -1; // not in this frame means missing, like a failed open
+            if (!s.live || !m_files) continue;
+            for (const auto& [path, content] : *m_files) {
+                if (path != QByteArrayView(s.name)) continue;
+                if (s.buf.size() < content.size()) s.buf.resize(content.size());
+                std::memcpy(s.buf.data(), content.data(), static_cast<size_t>(content.size()));
+                s.len = content.size();
+                break;
+            }
+        }
+    }
+
+protected:
+    void readOpen(const std::vector<int>&) override {}
+
+private:
+    const std::vector<Trace::File>* m_files {nullptr};
+};
+
+bool Trace::load(const QString& path, QString* error) {
+    m_file.close();
+    m_file.setFileName(path);
+    m_owned.clear();
+    m_text = {};
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) *error = path + QStringLiteral(": ") + m_file.errorString();
+        return false;
+    }
+    // Mapped, a day of samples is read by the page cache as it is played
+    if (m_file.size() > 0) {
+        if (const uchar* p = m_file.map(0, m_file.size()))
+            m_text = QByteArrayView(reinterpret_cast<const char*>(p), m_file.size());
+        else {
+            m_owned = m_file.readAll();
+            m_text = m_owned;
+        }
+    }
+    index();
+    if (m_frames.empty()) {
+        if (error) *error = path + QStringLiteral(": no \"@<ms>\" sample lines");
+        return false;
+    }
+    return true;
+}
+
+void Trace::setText(QByteArray text) {
+    m_file.close();
+    m_owned = std::move(text);
+    m_text = m_owned;
+    index();
+}
+
+void Trace::index() {
+    m_frames.clear();
+    const char* const base = m_text.data();
+    const qsizetype size = m_text.size();
+    qsizetype pos = 0;
+    while (pos < size) {
+        // Each "@" at the start of a line opens a frame
+        if (base[pos] == '@') {
+            const char* nl = static_cast<const char*>(std::memchr(base + pos, '\n', static_cast<size_t>(size - pos)));
+            const qsizetype lineEnd = nl ? nl - base : size;
+            if (!m_frames.empty()) m_frames.back().end = pos;
+            m_frames.push_back({ProcParse::toInt64(m_text.sliced(pos + 1, lineEnd - pos - 1)),
+                                std::min(lineEnd + 1, size), size});
+            pos = lineEnd + 1;
+            continue;
+        }
+        const char* nl = static_cast<const char*>(std::memchr(base + pos, '\n', static_cast<size_t>(size - pos)));
+        if (!nl) break;
+        pos = nl - base + 1;
+    }
+}
+
+void Trace::files(int frame, std::vector<File>* out) const {
+    out->clear();
+    const Frame& f = m_frames[frame];
+    const QByteArrayView text = m_text.sliced(f.begin, f.end - f.begin);
+    static constexpr QByteArrayView kOpen = "==> ";
+    static constexpr QByteArrayView kClose = " <==";
+    qsizetype pos = 0;
+    qsizetype contentBegin = -1;
+    QByteArrayView path;
+    auto finish = [&](qsizetype end) {
+        if (contentBegin < 0) return;
+        QByteArrayView content = text.sliced(contentBegin, end - contentBegin);
+        // head separates files with one empty line
+        if (content.endsWith("\n\n")) content.chop(1);
+        out->emplace_back(path, content);
+    };
+    while (pos < text.size()) {
+        qsizetype lineEnd = text.indexOf('\n', pos);
+        if (lineEnd < 0) lineEnd = text.size();
+        const QByteArrayView line = text.sliced(pos, lineEnd - pos);
+        if (line.startsWith(kOpen) && line.endsWith(kClose)) {
+            finish(pos);
+            path = line.sliced(kOpen.size(), line.size() - kOpen.size() - kClose.size());
+            contentBegin = std::min(lineEnd + 1, text.size());
+        }
+        pos = lineEnd + 1;
+    }
+    finish(text.size());
+}
+
+TraceReplay::TraceReplay(QObject* parent) : QObject(parent) {
+    auto reader = std::make_unique<ReplayReader>();
+    m_reader = reader.get();
+    m_reader->setFiles(&m_files);
+    m_snapshot = std::make_unique<SystemSnapshot>(QStringLiteral("/proc"), QStringLiteral("/sys"), std::move(reader));
+}
+
+TraceReplay::~TraceReplay() = default;
+
+bool TraceReplay::open(const QString& path, QString* error) {
+    stop();
+    m_next = 0;
+    return m_trace.load(path, error);
+}
+
+void TraceReplay::setTrace(QByteArray text) {
+    stop();
+    m_next = 0;
+    m_trace.setText(std::move(text));
+}
+
+bool TraceReplay::step() {
+    if (atEnd()) return false;
+    m_trace.files(m_next, &m_files);
+    m_nowMs = m_trace.timeMs(m_next);
+    ++m_next;
+    m_snapshot->refreshAt(m_nowMs);
+    emit sampled();
+    return true;
+}
+
+void TraceReplay::run() {
+    stop();
+    while (step()) {}
+    emit finished();
+}
+
+void TraceReplay::start(double speed) {
+    m_speed = speed > 0 ? speed : 1.0;
+    if (!m_timer) {
+        m_timer = new QTimer(this);
+        m_timer->setSingleShot(true);
+        m_timer->setTimerType(Qt::PreciseTimer);
+        connect(m_timer, &QTimer::timeout, this, [this] {
+            step();
+            scheduleNext();
+        });
+    }
+    step();
+    scheduleNext();
+}
+
+void TraceReplay::stop() {
+    if (m_timer) m_timer->stop();
+}
+
+void TraceReplay::scheduleNext() {
+    if (atEnd()) {
+        emit finished();
+        return;
+    }
+    const qint64 gap = std::max<qint64>(0, m_trace.timeMs(m_next) - m_nowMs);
+    m_timer->start(static_cast<int>(gap / m_speed));
+}
@@ -0,0 +1,101 @@
+// ===== src/TraceReplay.h =====
+#pragma once
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class QTimer;
+class ReplayReader;
+class SystemSnapshot;
+
+// A recorded timeline of /proc and /sys file contents, in the format the
+// capture one-liner writes (kCaptureCommand): each sample is an "@<ms>"
+// line followed by `head -v` output, a "==> path <==" header per file.
+//
+//   @1718000000123
+//   ==> /proc/meminfo <==
+//   MemTotal:       16384000 kB
+//   ...
+//
+//   ==> /proc/swaps <==
+//   ...
+//
+// The file is memory-mapped and only the frame starts are indexed on load;
+// a frame's files are split when it is played.
+class Trace {
+public:
+    using File = std::pair<QByteArrayView, QByteArrayView>; // path, content
+
+    static constexpr const char* kCaptureCommand =
+        "while :; do date +@%s%3N; head -v -c 1M /proc/meminfo /proc/swaps /proc/pressure/memory "
+        "/sys/block/zram0/disksize /sys/block/zram0/mm_stat 2>/dev/null; sleep 1; done > nohang.trace";
+
+    bool load(const QString& path, QString* error = nullptr);
+    void setText(QByteArray text);                   // an in-memory trace, e.g. a generated one
+
+    int frameCount() const { return static_cast<int>(m_frames.size()); }
+    qint64 timeMs(int frame) const { return m_frames[frame].atMs; }
+    // Split one frame into its files; out is cleared and reused
+    void files(int frame, std::vector<File>* out) const;
+
+private:
+    struct Frame {
+        qint64 atMs;
+        qsizetype begin;                             // just past the "@" line
+        qsizetype end;
+    };
+    void index();
+
+    QFile m_file;
+    QByteArray m_owned;
+    QByteArrayView m_text;
+    std::vector<Frame> m_frames;
+};
+
+// TraceReplay plays a Trace through a SystemSnapshot whose reader serves the
+// recorded contents instead of the live files, so everything downstream,
+// Thresholds::compute, SeverityEngine, iconNameFor, TooltipBuilder, runs
+// unchanged. The clock is virtual: each sample is stamped with its recorded
+// time. run() plays as fast as possible; start() keeps the recorded pacing,
+// optionally sped up, on the event loop.
+class TraceReplay : public QObject {
+    Q_OBJECT
+public:
+    explicit TraceReplay(QObject* parent = nullptr);
+    ~TraceReplay() override;
+
+    bool open(const QString& path, QString* error = nullptr);
+    void setTrace(QByteArray text);
+
+    SystemSnapshot& snapshot() { return *m_snapshot; }
+    const Trace& trace() const { return m_trace; }
+    int position() const { return m_next; }          // frames played
+    bool atEnd() const { return m_next >= m_trace.frameCount(); }
+    qint64 nowMs() const { return m_nowMs; }         // virtual clock, time of the last frame played
+
+    bool step();                                     // play one frame, emits sampled()
+    void run();                                      // play the rest at once
+    void start(double speed = 1.0);                  // recorded pacing divided by speed
+    void stop();
+
+signals:
+    void sampled();
+    void finished();
+
+private:
+    void scheduleNext();
+
+    Trace m_trace;
+    ReplayReader* m_reader {nullptr};                // owned by m_snapshot
+    std::unique_ptr<SystemSnapshot> m_snapshot;
+    std::vector<Trace::File> m_files;
+    int m_next {0};
+    qint64 m_nowMs {0};
+    double m_speed {1.0};
+    QTimer* m_timer {nullptr};
+};
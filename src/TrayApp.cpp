@@ -1,22 +1,43 @@
 // ===== src/TrayApp.cpp =====
 #include "TrayApp.h"
 #include "NoHangConfig.h"
+#include "DBusService.h"
+#include "GaugeIcon.h"
+#include "HistoryWindow.h"
+#include "MemoryEventsWatcher.h"
+#include "MemoryLock.h"
+#include "MetricsServer.h"
 #include "NoHangUnit.h"
 #include "ProcessTableAction.h"
+#include "PrometheusExporter.h"
+#include "SampleHistory.h"
+#include "SeverityEngine.h"
+#include "SnapshotSampler.h"
 #include "SystemSnapshot.h"
 #include "Thresholds.h"
 #include "TooltipBuilder.h"
+#include "TopConsumers.h"
 #include "pch.h"
 
 #include <KStatusNotifierItem>
 #include <QAction>
 #include <QFileInfo>
+#include <QMenu>
+#include <QPointer>
+#include <QThreadPool>
 #include <QTimer>
 
-static constexpr int kPollMs = 5000;
+static constexpr int kPollMs = 5000;   // systemd unit and config discovery
+static constexpr int kRenderMs = 1000; // icon and tooltip repaint
 static constexpr int kCfgWatchMs = 3000;
+static constexpr std::chrono::milliseconds kSampleInterval{100};
+static constexpr std::chrono::microseconds kTopBudget{5000}; // CPU per render tick
+static constexpr qint64 kTopRescanMs = 10000; // pause between complete passes
+static constexpr double kEventHoldSeconds = 30; // how long a memory.events bump keeps the icon up
 
-TrayApp::~TrayApp() = default;
+TrayApp::~TrayApp() {
+  delete m_historyWindow; // it reads m_history, which goes next
+}
 
 TrayApp::TrayApp(QObject *parent) : QObject(parent) {}
 
@@ -68,8 +89,59 @@ QString TrayApp::iconNameFor(const NoHangConfig &cfg,
 
 void TrayApp::start() {
   ensureModels();
+  m_configPathCache = discoverConfigPath(); // the menu action needs it now
   setupStatusItem();
+  auto source = std::make_unique<SystemSnapshot>(m_procRoot, m_sysRoot);
+  source->subscribeMeminfo(TooltipBuilder::kMeminfoFields);
+  source->enableNuma();
+  m_snapshot->subscribeMeminfo(TooltipBuilder::kMeminfoFields);
+  if (!m_cgroupSubtree.isEmpty())
+    source->enableCgroups(QStringLiteral("/sys/fs/cgroup"), m_cgroupSubtree);
+  if (!m_limitCgroup.isEmpty()) {
+    source->setLimitCgroup(QStringLiteral("/sys/fs/cgroup"), m_limitCgroup);
+    // The first render may beat the first sample, judge it the same way
+    m_snapshot->setLimitCgroup(QStringLiteral("/sys/fs/cgroup"), m_limitCgroup);
+  }
+  m_sampler = std::make_unique<SnapshotSampler>(std::move(source),
+                                                kSampleInterval);
+  m_sampler->start(m_lockMemory);
+  if (!m_watchCgroups.isEmpty()) {
+    m_events = std::make_unique<MemoryEventsWatcher>(
+        QStringLiteral("/sys/fs/cgroup"), m_watchCgroups);
+    connect(m_events.get(), &MemoryEventsWatcher::eventsChanged, this,
+            &TrayApp::onMemoryEvents);
+  }
+  if (!m_metricsSocket.isEmpty()) {
+    m_metrics = std::make_unique<MetricsServer>();
+    QString err;
+    if (!m_metrics->listen(m_metricsSocket, &err)) {
+      qWarning().noquote() << "TrayApp: metrics socket disabled:" << err;
+      m_metrics.reset();
+    }
+  }
+  if (!m_prometheusAddress.isEmpty()) {
+    m_exporter = std::make_unique<PrometheusExporter>();
+    QString err;
+    if (!m_exporter->listen(m_prometheusAddress, &err)) {
+      qWarning().noquote() << "TrayApp: Prometheus exporter disabled:" << err;
+      m_exporter.reset();
+    }
+  }
+  if (m_dbusEnabled) {
+    m_dbus = std::make_unique<DBusService>(m_history.get());
+    QString err;
+    if (!m_dbus->registerOn(QDBusConnection::sessionBus(), &err)) {
+      qWarning().noquote() << "TrayApp: D-Bus interface disabled:" << err;
+      m_dbus.reset();
+    }
+  }
   setupTimers();
+  if (m_lockMemory) {
+    QString err;
+    m_memoryLocked = MemoryLock::lockAll({}, &err);
+    if (!m_memoryLocked)
+      qWarning().noquote() << "TrayApp: mlockall failed:" << err;
+  }
   tick();
 }
 
@@ -79,11 +151,21 @@ void TrayApp::ensureModels() {
   if (!m_cfg)
     m_cfg = std::make_unique<NoHangConfig>(this);
   if (!m_snapshot)
-    m_snapshot = std::make_unique<SystemSnapshot>(this);
+    m_snapshot = std::make_unique<SystemSnapshot>(m_procRoot, m_sysRoot, this);
   if (!m_tooltip)
     m_tooltip = std::make_unique<TooltipBuilder>(this);
-  if (!m_procAction)
+  if (!m_procAction) {
     m_procAction = std::make_unique<ProcessTableAction>(this);
+    m_procAction->setPssBudget(m_pssBudget);
+  }
+  if (!m_severity)
+    m_severity = std::make_unique<SeverityEngine>();
+  if (!m_top)
+    m_top = std::make_shared<TopConsumers>();
+  if (!m_history)
+    m_history = std::make_unique<SampleHistory>();
+  if (m_gaugeIcon && !m_gauge)
+    m_gauge = std::make_unique<GaugeIcon>();
 }
 
 void TrayApp::setupStatusItem() {
@@ -93,8 +175,12 @@ void TrayApp::setupStatusItem() {
   // Active or passive icon will be set in refreshIcon
   m_sni->setStatus(KStatusNotifierItem::Active);
   if (auto *menu = m_sni->contextMenu()) {
-    QAction *act = m_procAction->makeAction(menu, m_unit->resolvedConfigPath());
+    QAction *act = m_procAction->makeAction(menu, m_configPathCache);
     menu->addAction(act);
+    menu->addAction(QStringLiteral("History…"), this, &TrayApp::showHistory);
+    m_eventsMenu = menu->addMenu(QStringLiteral("Recent memory events"));
+    connect(m_eventsMenu, &QMenu::aboutToShow, this, &TrayApp::fillEventsMenu);
+    fillEventsMenu();
   }
 }
 
@@ -104,6 +190,11 @@ void TrayApp::setupTimers() {
   connect(m_pollTimer, &QTimer::timeout, this, &TrayApp::tick);
   m_pollTimer->start();
 
+  m_renderTimer = new QTimer(this);
+  m_renderTimer->setInterval(kRenderMs);
+  connect(m_renderTimer, &QTimer::timeout, this, &TrayApp::render);
+  m_renderTimer->start();
+
   m_cfgWatchTimer = new QTimer(this);
   m_cfgWatchTimer->setInterval(kCfgWatchMs);
   connect(m_cfgWatchTimer, &QTimer::timeout, this,
@@ -111,10 +202,15 @@ void TrayApp::setupTimers() {
   m_cfgWatchTimer->start();
 }
 
+QString TrayApp::discoverConfigPath() const {
+  // systemctl is only asked when no config was fixed
+  return m_fixedConfig.isEmpty() ? m_unit->configPath() : m_fixedConfig;
+}
+
 void TrayApp::tick() {
   // Detect running unit and config path
-  const bool active = m_unit->isActive();
-  const QString cfgPath = m_unit->configPath();
+  m_active = m_fixedConfig.isEmpty() ? m_unit->isActive() : true;
+  const QString cfgPath = discoverConfigPath();
   if (cfgPath != m_configPathCache) {
     m_configPathCache = cfgPath;
     m_configMtimeCache = 0; // force re-parse
@@ -123,38 +219,187 @@ void TrayApp::tick() {
   // Parse thresholds from the current config, or defaults
   m_cfg->ensureParsed(cfgPath);
 
-  // Read live system data
-  m_snapshot->refresh();
+  render();
+}
+
+void TrayApp::render() {
+  // Adopt the latest complete sample, the sampler thread keeps running at
+  // its own rate regardless of how long painting takes here
+  if (m_sampler && m_sampler->sampleCount() > 0)
+    m_snapshot->assign(m_sampler->latest());
+  else
+    m_snapshot->refresh(); // first tick may beat the first sample
+
+  refreshIcon();
+  if (m_history->append(m_snapshot->data(), m_severity->level()) &&
+      m_historyWindow)
+    m_historyWindow->refresh(
+        Thresholds::compute(m_cfg->thresholds(), *m_snapshot), *m_snapshot);
+  publishMetrics();
+  scheduleTopScan();
+  refreshTooltip();
+}
+
+void TrayApp::showHistory() {
+  if (!m_historyWindow) {
+    m_historyWindow = new HistoryWindow(m_history.get());
+    m_historyWindow->refresh(
+        Thresholds::compute(m_cfg->thresholds(), *m_snapshot), *m_snapshot);
+  }
+  m_historyWindow->show();
+  m_historyWindow->raise();
+  m_historyWindow->activateWindow();
+}
+
+void TrayApp::publishMetrics() {
+  const SnapshotData d = m_snapshot->data();
+  if (m_metrics)
+    m_metrics->publish(MetricsServer::encode(d, m_severity->level(),
+                                             m_severity->cause(), m_active));
+  if (!m_exporter && !m_dbus)
+    return;
+  const ThresholdSet th = Thresholds::compute(m_cfg->thresholds(), *m_snapshot);
+  if (m_exporter)
+    m_exporter->update(d, th, *m_severity, m_active);
+  if (m_dbus)
+    m_dbus->update(d, th, *m_severity, m_active);
+}
+
+void TrayApp::scheduleTopScan() {
+  if (m_severity->level() == Severity::Normal) {
+    // Nothing to explain, and stale names would mislead next time
+    m_topResult.reset();
+    if (!m_topBusy)
+      m_top->reset();
+    m_topDoneMs = 0;
+    return;
+  }
+  if (m_topBusy)
+    return;
+  const qint64 now = m_snapshot->sampledAtMs();
+  if (!m_top->inPass() && m_topDoneMs && now - m_topDoneMs < kTopRescanMs)
+    return;
+
+  m_topBusy = true;
+  QPointer<TrayApp> self(this);
+  std::shared_ptr<TopConsumers> top = m_top;
+  QThreadPool::globalInstance()->start([self, top] {
+    const bool done = top->step(kTopBudget);
+    TopConsumersResult result;
+    if (done)
+      result = top->result();
+    QMetaObject::invokeMethod(
+        qApp,
+        [self, done, result] {
+          if (self)
+            self->onTopStep(done, result);
+        },
+        Qt::QueuedConnection);
+  });
+}
 
-  // Update UI
+void TrayApp::onTopStep(bool done, const TopConsumersResult &result) {
+  m_topBusy = false;
+  if (!done || m_severity->level() == Severity::Normal)
+    return;
+  m_topResult = std::make_unique<TopConsumersResult>(result);
+  m_topDoneMs = m_snapshot->sampledAtMs();
+  refreshTooltip();
+}
+
+void TrayApp::onMemoryEvents(const MemoryEventRecord &record) {
+  // The kernel just counted reclaim throttling or an OOM kill. Repaint now
+  // rather than on the next render tick, and hold the icon up even if the
+  // numbers recover before anyone looks.
+  const MemoryEventCounts &d = record.delta;
+  Severity to = Severity::Normal;
+  if (d.oom || d.oomKill || d.oomGroupKill)
+    to = Severity::Hard;
+  else if (d.max)
+    to = Severity::Soft;
+  else if (d.high)
+    to = Severity::Warn;
+
+  // Adopt the sampler's newest sample as render() does; a direct refresh
+  // would block here and lacks the sampler's cgroup and NUMA state
+  if (m_sampler && m_sampler->sampleCount() > 0)
+    m_snapshot->assign(m_sampler->latest());
+  if (to != Severity::Normal && m_active)
+    m_severity->escalate(to, m_snapshot->sampledAtMs() / 1000.0,
+                         kEventHoldSeconds);
   refreshIcon();
+  publishMetrics();
+  scheduleTopScan();
   refreshTooltip();
 }
 
+void TrayApp::fillEventsMenu() {
+  if (!m_eventsMenu)
+    return;
+  m_eventsMenu->clear();
+  if (!m_events || m_events->recent().isEmpty()) {
+    m_eventsMenu->addAction(m_events ? QStringLiteral("None since start")
+                                     : QStringLiteral("Not watching"))
+        ->setEnabled(false);
+    return;
+  }
+  for (const MemoryEventRecord &r : m_events->recent())
+    m_eventsMenu
+        ->addAction(QStringLiteral("%1  %2: %3")
+                        .arg(r.at.toString(QStringLiteral("HH:mm:ss")),
+                             r.cgroup, r.summary()))
+        ->setEnabled(false);
+}
+
 void TrayApp::refreshIcon() {
-  const bool active = m_unit->isActive();
-  const QString icon = active ? iconNameFor(*m_cfg, *m_snapshot)
-                              : QStringLiteral("security-low");
-  m_sni->setIconByName(icon);
+  const bool active = m_active;
+  const ThresholdSet th = Thresholds::compute(m_cfg->thresholds(), *m_snapshot);
+  if (active)
+    m_severity->update(th, *m_snapshot, m_snapshot->sampledAtMs() / 1000.0);
+  else
+    m_severity->reset();
+  const QString icon = SeverityEngine::iconName(m_severity->level());
+  if (m_gauge) {
+    // Cached pixmaps, handed over only when a bar moves a step
+    if (m_gauge->update(m_gauge->stateOf(th, *m_snapshot, m_severity->level(),
+                                         active),
+                        GaugeIcon::currentTheme()))
+      m_sni->setIconByPixmap(m_gauge->icon());
+  } else {
+    m_sni->setIconByName(icon);
+  }
   m_sni->setStatus(active ? KStatusNotifierItem::Active
                           : KStatusNotifierItem::Passive);
   m_sni->setTitle(active ? QStringLiteral("nohang, active")
                          : QStringLiteral("nohang, inactive"));
+  if (icon != m_iconName) {
+    m_iconName = icon;
+    emit iconChanged(icon);
+  }
 }
 
 void TrayApp::refreshTooltip() {
   // Build "configured vs current" text for RAM, swap, zram, PSI
   const QString tipTitle = QStringLiteral("nohang status");
   const QString tipIcon = QStringLiteral("security-medium");
-  const QString tipText = m_tooltip->build(
-      *m_cfg, *m_snapshot, m_unit->isActive(), m_unit->resolvedConfigPath());
+  QString tipText = m_tooltip->build(
+      *m_cfg, *m_snapshot, m_active, m_configPathCache,
+      m_topResult.get());
+  if (m_lockMemory) {
+    const MemoryLockReport r = MemoryLock::report();
+    tipText += QStringLiteral("tray: locked %1 MiB, resident %2 MiB%3\n")
+                   .arg(r.lockedMiB, 0, 'f', 0)
+                   .arg(r.residentMiB, 0, 'f', 0)
+                   .arg(m_memoryLocked ? QString()
+                                       : QStringLiteral(" (mlockall failed)"));
+  }
 
   // KStatusNotifierItem tooltips take icon-name, title, subtitle
   m_sni->setToolTip(tipIcon, tipTitle, tipText);
 }
 
 void TrayApp::onConfigMaybeChanged() {
-  const QString path = m_unit->configPath();
+  const QString &path = m_configPathCache; // tick() keeps it current
   if (path.isEmpty())
     return;
   QFileInfo fi(path);
@@ -1,9 +1,13 @@
 // ===== src/TrayApp.h =====
 #pragma once
 #include <QObject>
+#include <QPointer>
 #include <QString>
+#include <QStringList>
+#include <chrono>
 #include <memory>
 
+class QMenu;
 class QTimer;
 class KStatusNotifierItem;
 class NoHangUnit;
@@ -11,7 +15,19 @@ class NoHangConfig;
 class SystemSnapshot;
 class TooltipBuilder;
 class ProcessTableAction;
+class SnapshotSampler;
+class SeverityEngine;
+class TopConsumers;
+class MemoryEventsWatcher;
+class MetricsServer;
+class PrometheusExporter;
+class DBusService;
+class SampleHistory;
+class HistoryWindow;
+class GaugeIcon;
+struct MemoryEventRecord; // from MemoryEventsWatcher.h
 struct ThresholdSet; // from Thresholds.h
+struct TopConsumersResult; // from TopConsumers.h
 
 // TrayApp wires everything together.
 // 1) Discovers the running nohang service and its config path
@@ -26,18 +42,77 @@ public:
   ~TrayApp(); // out-of-line definition in the .cpp
   void start();
 
+  // Opt-in reclaim-proof mode: raise the sampler thread to real-time
+  // priority and mlockall the process once startup is done. Call before
+  // start().
+  void setLockMemory(bool on) { m_lockMemory = on; }
+
+  // CPU time the process table may spend on smaps_rollup per refresh.
+  // Call before start(); zero hides the PSS option.
+  void setPssBudget(std::chrono::milliseconds budget) { m_pssBudget = budget; }
+
+  // cgroup v2 subtree sampled for the tooltip, relative to /sys/fs/cgroup.
+  // "/" walks the whole hierarchy. Empty (the default) disables it. Call
+  // before start().
+  void setCgroupSubtree(const QString &subtree) { m_cgroupSubtree = subtree; }
+
+  // Judge RAM and swap against this cgroup's memory.max and swap.max (and
+  // its ancestors'), relative to /sys/fs/cgroup. "self" is the tray's own
+  // cgroup. Empty (the default) uses host totals, as nohang does. Call
+  // before start().
+  void setLimitCgroup(const QString &path) { m_limitCgroup = path; }
+
+  // cgroups whose memory.events counters raise the icon as soon as the
+  // kernel bumps them, relative to /sys/fs/cgroup. Empty (the default)
+  // disables the watcher. Call before start().
+  void setWatchCgroups(const QStringList &paths) { m_watchCgroups = paths; }
+
+  // Serve the latest sample and severity on this SOCK_SEQPACKET socket,
+  // see MetricsProtocol.h. Empty disables it. Call before start().
+  void setMetricsSocket(const QString &path) { m_metricsSocket = path; }
+
+  // Serve Prometheus /metrics on "[host:]port" (localhost unless a host is
+  // given) or a Unix socket path. Empty disables it. Call before start().
+  void setPrometheusAddress(const QString &address) { m_prometheusAddress = address; }
+
+  // Export org.archlars.NoHangTray on the session bus (on by default).
+  // Call before start().
+  void setDBusEnabled(bool on) { m_dbusEnabled = on; }
+
+  // Sample these trees instead of /proc and /sys, e.g. a
+  // ScenarioGenerator's. Call before start().
+  void setSnapshotRoots(const QString &procRoot, const QString &sysRoot) {
+    m_procRoot = procRoot;
+    m_sysRoot = sysRoot;
+  }
+
+  // Paint the icon as RAM and PSI bars instead of the themed shield
+  // names. Call before start().
+  void setGaugeIcon(bool on) { m_gaugeIcon = on; }
+
+  // Skip systemd discovery: treat nohang as running with this config, for
+  // benchmarks and demos. Empty (the default) asks systemctl. Call before
+  // start().
+  void setFixedConfig(const QString &cfgPath) { m_fixedConfig = cfgPath; }
+
   // Utility method exposed for testing; currently returns the input string
   // unchanged. Retained for compatibility if tooltips require escaping in
   // the future.
   static QString escapePercent(const QString &s);
 
   // Determine icon name based on current thresholds and system snapshot.
-  // This is exposed for testing of severity mapping logic.
+  // Stateless, for a single sample; the tray itself feeds SeverityEngine,
+  // which adds hysteresis and psi_excess_duration on top.
   static QString iconNameFor(const NoHangConfig &cfg,
                              const SystemSnapshot &snap);
 
+signals:
+  // The icon name just handed to the status item, emitted on changes only
+  void iconChanged(const QString &name);
+
 private slots:
-  void tick();           // periodic refresh
+  void tick();           // unit and config discovery, then render
+  void render();         // repaint from the latest sample
   void refreshIcon();    // sets icon based on active state
   void refreshTooltip(); // composes tooltip text from models
   void onConfigMaybeChanged();
@@ -46,17 +121,58 @@ private:
   void setupStatusItem();
   void setupTimers();
   void ensureModels();
+  void scheduleTopScan(); // background top-N pass while severity is raised
+  void onTopStep(bool done, const TopConsumersResult &result);
+  void onMemoryEvents(const MemoryEventRecord &record);
+  void fillEventsMenu(); // "Recent memory events", rebuilt when opened
+  void showHistory();    // "History…", the chart window
+  void publishMetrics(); // metrics socket, /metrics page and D-Bus
+  // The fixed config, else the unit's. Runs systemctl and blocks, so only
+  // tick() calls it; everything else reads m_configPathCache.
+  QString discoverConfigPath() const;
 
   std::unique_ptr<NoHangUnit> m_unit;
   std::unique_ptr<NoHangConfig> m_cfg;
   std::unique_ptr<SystemSnapshot> m_snapshot;
   std::unique_ptr<TooltipBuilder> m_tooltip;
   std::unique_ptr<ProcessTableAction> m_procAction;
+  std::unique_ptr<SnapshotSampler> m_sampler;
+  std::unique_ptr<SeverityEngine> m_severity;
+  std::shared_ptr<TopConsumers> m_top; // shared with the pool task in flight
+  std::unique_ptr<TopConsumersResult> m_topResult; // null while nothing to show
+
+  std::unique_ptr<MemoryEventsWatcher> m_events;
+  std::unique_ptr<MetricsServer> m_metrics;
+  std::unique_ptr<PrometheusExporter> m_exporter;
+  std::unique_ptr<SampleHistory> m_history; // 1 s samples, last 24 h
+  std::unique_ptr<DBusService> m_dbus;
+  QPointer<HistoryWindow> m_historyWindow; // only while open
 
+  std::unique_ptr<GaugeIcon> m_gauge; // with setGaugeIcon() only
   std::unique_ptr<KStatusNotifierItem> m_sni;
+  QMenu *m_eventsMenu{nullptr};
   QTimer *m_pollTimer{nullptr};
+  QTimer *m_renderTimer{nullptr};
   QTimer *m_cfgWatchTimer{nullptr};
 
+  QString m_procRoot{QStringLiteral("/proc")};
+  QString m_sysRoot{QStringLiteral("/sys")};
+  QString m_fixedConfig;
+  QString m_iconName;
+
   QString m_configPathCache;
   qint64 m_configMtimeCache{0};
+  bool m_active{false};
+  bool m_lockMemory{false};
+  bool m_gaugeIcon{false};
+  bool m_memoryLocked{false};
+  std::chrono::milliseconds m_pssBudget{20};
+  QString m_cgroupSubtree; // off unless --cgroup-subtree
+  QString m_limitCgroup; // host totals unless --limit-cgroup
+  QStringList m_watchCgroups; // off unless --watch-cgroups
+  QString m_metricsSocket;
+  QString m_prometheusAddress;
+  bool m_dbusEnabled{true};
+  bool m_topBusy{false};
+  qint64 m_topDoneMs{0};
 };
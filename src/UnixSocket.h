@@ -0,0 +1,49 @@
+// ===== src/UnixSocket.h =====
+#pragma once
+#include <QByteArray>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Helpers shared by the servers that listen on a Unix socket path
+namespace UnixSocket {
+
+// Make way for bind() at path. Nothing there is fine, and a socket nobody
+// answers on (ECONNREFUSED) is a stale leftover and is removed. Anything
+// else is left alone and fails with errno: EEXIST for a file that is not a
+// socket, EADDRINUSE for a live server of any socket type.
+inline bool removeStale(const QByteArray& path) {
+    struct stat st;
+    if (::lstat(path.constData(), &st) < 0) return errno == ENOENT;
+    if (!S_ISSOCK(st.st_mode)) {
+        errno = EEXIST;
+        return false;
+    }
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    if (static_cast<size_t>(path.size()) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.constData(), static_cast<size_t>(path.size()));
+    // The type does not matter: a live server of another type answers EPROTOTYPE
+    const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0) return false;
+    const int rc = ::connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    const int err = errno;
+    ::close(probe);
+    if (rc == 0 || err == EPROTOTYPE) {
+        errno = EADDRINUSE;
+        return false;
+    }
+    if (err != ECONNREFUSED) {
+        errno = err;
+        return false;
+    }
+    return ::unlink(path.constData()) == 0 || errno == ENOENT;
+}
+
+} // namespace UnixSocket
@@ -1,15 +1,237 @@
 // ===== src/main.cpp =====
 #include "pch.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include "NoHangConfig.h"
+#include "SeverityEngine.h"
+#include "SystemSnapshot.h"
+#include "ThresholdSimulator.h"
+#include "Thresholds.h"
+#include "TooltipBuilder.h"
+#include "TraceReplay.h"
 #include "TrayApp.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// --replay: play a recorded trace through the tray's pipeline and print
+// every severity transition with the tooltip the tray would have shown
+static int replay(QCoreApplication& app, const QString& tracePath, const QString& configPath, double speed) {
+    TraceReplay replay;
+    QString err;
+    if (!replay.open(tracePath, &err)) {
+        std::fprintf(stderr, "replay: %s\n", qPrintable(err));
+        return 1;
+    }
+    SystemSnapshot& snap = replay.snapshot();
+    snap.subscribeMeminfo(TooltipBuilder::kMeminfoFields);
+    NoHangConfig cfg;
+    cfg.ensureParsed(configPath);
+    SeverityEngine severity;
+    TooltipBuilder tooltip;
+    const qint64 startMs = replay.trace().timeMs(0);
+    QString lastIcon;
+    int transitions = 0;
+    int iconChanges = 0;
+
+    QObject::connect(&replay, &TraceReplay::sampled, [&] {
+        const ThresholdSet th = Thresholds::compute(cfg.thresholds(), snap);
+        // The stateless icon shows what a tray without hysteresis would do
+        const QString icon = TrayApp::iconNameFor(cfg, snap);
+        if (icon != lastIcon && !lastIcon.isEmpty()) ++iconChanges;
+        lastIcon = icon;
+        const auto t = severity.update(th, snap, replay.nowMs() / 1000.0);
+        if (!t) return;
+        ++transitions;
+        std::printf("+%.1fs %s -> %s (%s)\n", (replay.nowMs() - startMs) / 1000.0,
+                    qPrintable(SeverityEngine::name(t->from)), qPrintable(SeverityEngine::name(t->to)),
+                    qPrintable(SeverityEngine::name(t->cause)));
+        for (const QString& line : tooltip.build(cfg, snap, true, cfg.sourcePath()).split(QLatin1Char('\n'), Qt::SkipEmptyParts))
+            std::printf("    %s\n", qPrintable(line));
+    });
+
+    QElapsedTimer wall;
+    wall.start();
+    if (speed > 0) {
+        QObject::connect(&replay, &TraceReplay::finished, &app, &QCoreApplication::quit, Qt::QueuedConnection);
+        replay.start(speed);
+        app.exec();
+    } else {
+        replay.run();
+    }
+    std::printf("%d samples over %.0f s replayed in %lld ms: %d transitions, stateless icon changed %d times\n",
+                replay.position(), (replay.nowMs() - startMs) / 1000.0, static_cast<long long>(wall.elapsed()),
+                transitions, iconChanges);
+    return 0;
+}
+
+static QString span(qint64 ms) {
+    const qint64 s = ms / 1000;
+    if (s >= 3600) return QStringLiteral("%1h%2m").arg(s / 3600).arg(s / 60 % 60, 2, 10, QLatin1Char('0'));
+    if (s >= 60) return QStringLiteral("%1m%2s").arg(s / 60).arg(s % 60, 2, 10, QLatin1Char('0'));
+    return QStringLiteral("%1s").arg(s);
+}
+
+static QString when(qint64 ms) {
+    return QDateTime::fromMSecsSinceEpoch(ms).toString(QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+}
+
+// --simulate: judge recorded history against candidate configs and print
+// the events each would have raised
+static int simulate(const QStringList& configs, const QString& historyPath) {
+    static constexpr int kListedStarts = 5;
+    ThresholdSimulator sim;
+    QString err;
+    QElapsedTimer timer;
+    timer.start();
+    if (historyPath.isEmpty() || !sim.loadTrace(historyPath, &err)) {
+        std::fprintf(stderr, "simulate: %s\n", historyPath.isEmpty() ? "--history <trace> is required" : qPrintable(err));
+        return 1;
+    }
+    const qint64 loadMs = timer.elapsed();
+    const int n = sim.size();
+    std::printf("%d samples, %s to %s, loaded in %lld ms\n", n, qPrintable(when(sim.timeMs(0))),
+                qPrintable(when(sim.timeMs(n - 1))), static_cast<long long>(loadMs));
+
+    std::vector<ThresholdsPercent> candidates;
+    for (const QString& path : configs) {
+        if (!QFileInfo::exists(path)) {
+            // ensureParsed would quietly fall back to the distro config
+            std::fprintf(stderr, "simulate: %s: no such file\n", qPrintable(path));
+            return 1;
+        }
+        NoHangConfig cfg;
+        cfg.ensureParsed(path);
+        candidates.push_back(cfg.thresholds());
+    }
+    timer.restart();
+    std::vector<ThresholdSimulator::Result> results;
+    results.reserve(candidates.size());
+    for (const ThresholdsPercent& t : candidates) results.push_back(sim.evaluate(t));
+    const qint64 evalMs = timer.elapsed();
+
+    static const char* const kLevels[] = {"", "warn", "soft", "hard"};
+    for (size_t c = 0; c < results.size(); ++c) {
+        const ThresholdSimulator::Result& r = results[c];
+        std::printf("\n%s\n", qPrintable(configs[int(c)]));
+        for (int l = ThresholdSimulator::Warn; l < ThresholdSimulator::LevelCount; ++l) {
+            std::printf("  %s: %d events, %s at or above", kLevels[l], r.events[l], qPrintable(span(r.durationMs[l])));
+            const int listed = std::min<int>(kListedStarts, r.events[l]);
+            for (int e = 0; e < listed; ++e)
+                std::printf("%s%s", e == 0 ? ", from " : ", ", qPrintable(when(r.startsMs[l][e])));
+            if (r.events[l] > listed) std::printf(" and %d more", r.events[l] - listed);
+            std::printf("\n");
+        }
+    }
+    std::printf("\n%zu configs over %d samples evaluated in %lld ms\n", results.size(), n,
+                static_cast<long long>(evalMs));
+    return 0;
+}
+
+// argv[i] is --name or --name=value; --replay-speed is not --replay
+static bool isOption(const char* arg, const char* name) {
+    const size_t n = std::strlen(name);
+    return std::strncmp(arg, "--", 2) == 0 && std::strncmp(arg + 2, name, n) == 0 &&
+           (arg[2 + n] == '\0' || arg[2 + n] == '=');
+}
 
 int main(int argc, char* argv[]) {
-    QApplication app(argc, argv);
+    // A replay or a simulation needs no display
+    bool headless = false;
+    for (int i = 1; i < argc; ++i)
+        headless |= isOption(argv[i], "replay") || isOption(argv[i], "simulate");
+    std::unique_ptr<QCoreApplication> appHolder(headless ? new QCoreApplication(argc, argv)
+                                                         : new QApplication(argc, argv));
+    QCoreApplication& app = *appHolder;
     app.setApplicationName(QStringLiteral("nohang-tray"));
     app.setOrganizationName(QStringLiteral("ArchLars"));
     app.setOrganizationDomain(QStringLiteral("github.com/ArchLars"));
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    const QCommandLineOption lockMemory(QStringLiteral("lock-memory"),
+        QStringLiteral("Sample on a dedicated thread and lock the tray in RAM so it stays responsive while the system thrashes."));
+    parser.addOption(lockMemory);
+    const QCommandLineOption pssBudget(QStringLiteral("pss-budget-ms"),
+        QStringLiteral("CPU time per process table refresh for PSS reads from smaps_rollup, 0 disables (default 20)."),
+        QStringLiteral("ms"), QStringLiteral("20"));
+    parser.addOption(pssBudget);
+    const QCommandLineOption cgroupSubtree(QStringLiteral("cgroup-subtree"),
+        QStringLiteral("cgroup v2 subtree to show per-slice memory for, relative to /sys/fs/cgroup, e.g. / for all "
+                       "slices (default off)."),
+        QStringLiteral("path"));
+    parser.addOption(cgroupSubtree);
+    const QCommandLineOption limitCgroup(QStringLiteral("limit-cgroup"),
+        QStringLiteral("Judge RAM and swap against this cgroup's memory.max and memory.swap.max, e.g. "
+                       "/system.slice/nohang-desktop.service; \"self\" is the tray's own cgroup (default off, host totals as nohang uses)."),
+        QStringLiteral("path"));
+    parser.addOption(limitCgroup);
+    const QCommandLineOption watchCgroups(QStringLiteral("watch-cgroups"),
+        QStringLiteral("Comma-separated cgroups whose memory.events (high, max, oom, oom_kill) raise the icon at once, "
+                       "relative to /sys/fs/cgroup, e.g. / for the top-level slices (default off)."),
+        QStringLiteral("paths"));
+    parser.addOption(watchCgroups);
+    const QCommandLineOption metricsSocket(QStringLiteral("metrics-socket"),
+        QStringLiteral("Serve the latest sample and severity to other tools on this Unix socket, "
+                       "e.g. $XDG_RUNTIME_DIR/nohang-tray.sock; read it with nohang-tray-metrics (default off)."),
+        QStringLiteral("path"));
+    parser.addOption(metricsSocket);
+    const QCommandLineOption prometheus(QStringLiteral("prometheus"),
+        QStringLiteral("Serve Prometheus metrics at /metrics on [host:]port (host defaults to 127.0.0.1) "
+                       "or on a Unix socket path (default off)."),
+        QStringLiteral("address"));
+    parser.addOption(prometheus);
+    const QCommandLineOption noDBus(QStringLiteral("no-dbus"),
+        QStringLiteral("Do not export org.archlars.NoHangTray on the session bus."));
+    parser.addOption(noDBus);
+    const QCommandLineOption gaugeIcon(QStringLiteral("gauge-icon"),
+        QStringLiteral("Paint the icon as two bars, RAM in use and PSI, coloured by severity, instead of the shield."));
+    parser.addOption(gaugeIcon);
+    const QCommandLineOption replayTrace(QStringLiteral("replay"),
+        QStringLiteral("Play a recorded trace through the tray's pipeline without a tray and print the severity "
+                       "transitions. Record one with: %1").arg(QString::fromLatin1(Trace::kCaptureCommand)),
+        QStringLiteral("trace"));
+    parser.addOption(replayTrace);
+    const QCommandLineOption replaySpeed(QStringLiteral("replay-speed"),
+        QStringLiteral("Replay pacing: 1 is real time, 60 a minute per second, 0 as fast as possible (default 0)."),
+        QStringLiteral("factor"), QStringLiteral("0"));
+    parser.addOption(replaySpeed);
+    const QCommandLineOption config(QStringLiteral("config"),
+        QStringLiteral("nohang config to judge a replay against (default /etc/nohang/nohang-desktop.conf)."),
+        QStringLiteral("path"));
+    parser.addOption(config);
+    const QCommandLineOption simulateConfig(QStringLiteral("simulate"),
+        QStringLiteral("Judge the --history trace against this candidate nohang config and print the warn, soft and "
+                       "hard events it would have raised; repeat for more configs."),
+        QStringLiteral("config"));
+    parser.addOption(simulateConfig);
+    const QCommandLineOption history(QStringLiteral("history"),
+        QStringLiteral("Trace the --simulate configs are judged against, recorded as for --replay."),
+        QStringLiteral("trace"));
+    parser.addOption(history);
+    parser.process(app);
+
+    if (parser.isSet(simulateConfig))
+        return simulate(parser.values(simulateConfig), parser.value(history));
+
+    if (parser.isSet(replayTrace))
+        return replay(app, parser.value(replayTrace), parser.value(config), parser.value(replaySpeed).toDouble());
+
     TrayApp tray;
+    tray.setLockMemory(parser.isSet(lockMemory));
+    tray.setPssBudget(std::chrono::milliseconds(qMax(0, parser.value(pssBudget).toInt())));
+    tray.setCgroupSubtree(parser.value(cgroupSubtree));
+    tray.setLimitCgroup(parser.value(limitCgroup));
+    tray.setMetricsSocket(parser.value(metricsSocket));
+    tray.setPrometheusAddress(parser.value(prometheus));
+    tray.setDBusEnabled(!parser.isSet(noDBus));
+    tray.setGaugeIcon(parser.isSet(gaugeIcon));
+    tray.setWatchCgroups(parser.value(watchCgroups).split(QLatin1Char(','), Qt::SkipEmptyParts));
     tray.start(); // sets up the SNI, timers, and first refresh
 
     return app.exec();
@@ -0,0 +1,148 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "CgroupSampler.h"
+#include "FakeProc.h"
+#include <QDir>
+#include <QTemporaryDir>
+
+static constexpr qint64 MiB = 1024 * 1024;
+
+using FakeProc::writeFile;
+
+// Creates a cgroup directory with the memory controller files
+static void addCgroup(const QString& root, const QString& rel, qint64 current, const QByteArray& max = "max",
+                      qint64 swap = 0, double some = 0)
+{
+    const QString dir = root + '/' + rel;
+    QDir().mkpath(dir);
+    writeFile(dir + "/memory.current", QByteArray::number(current) + '\n');
+    writeFile(dir + "/memory.max", max + '\n');
+    writeFile(dir + "/memory.swap.current", QByteArray::number(swap) + '\n');
+    writeFile(dir + "/memory.pressure", "some avg10=" + QByteArray::number(some, 'f', 2) +
+                                            " avg60=0.00 avg300=0.00 total=1\n"
+                                            "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n");
+    writeFile(dir + "/cgroup.events", "populated 1\nfrozen 0\n");
+}
+
+// root
+//   system.slice 500 MiB
+//     sshd.service 20 MiB
+//   user.slice 3000 MiB
+//     user-1000.slice 2900 MiB
+//       app-firefox.scope 2000 MiB, max 4 GiB
+//       app-term.scope 100 MiB
+static void makeTree(const QString& root)
+{
+    writeFile(root + "/cgroup.controllers", "cpu memory pids\n");
+    writeFile(root + "/memory.pressure", "some avg10=0.00 avg60=0.00 avg300=0.00 total=0\n");
+    addCgroup(root, "system.slice", 500 * MiB);
+    addCgroup(root, "system.slice/sshd.service", 20 * MiB);
+    addCgroup(root, "user.slice", 3000 * MiB, "max", 64 * MiB, 1.5);
+    addCgroup(root, "user.slice/user-1000.slice", 2900 * MiB);
+    addCgroup(root, "user.slice/user-1000.slice/app-firefox.scope", 2000 * MiB, QByteArray::number(4096 * MiB), 0, 12.25);
+    addCgroup(root, "user.slice/user-1000.slice/app-term.scope", 100 * MiB);
+}
+
+static QStringList paths(const QVector<CgroupUsage>& rows)
+{
+    QStringList out;
+    for (const CgroupUsage& u : rows) out << u.path;
+    return out;
+}
+
+TEST(CgroupSamplerTest, WalksFakeTreeAndReadsMemoryFiles)
+{
+    QTemporaryDir root;
+    makeTree(root.path());
+
+    CgroupSampler sampler(root.path(), QString(), 4, ProcReader::Backend::Pread);
+    sampler.sample();
+    ASSERT_EQ(7, sampler.usage().size());
+    EXPECT_EQ(QString(), sampler.usage()[0].path);
+    EXPECT_EQ(-1, sampler.usage()[0].currentBytes); // root has no memory.current
+
+    EXPECT_EQ((QStringList{"user.slice/user-1000.slice/app-firefox.scope",
+                           "user.slice/user-1000.slice/app-term.scope",
+                           "system.slice/sshd.service"}),
+              paths(sampler.topLeaves(5)));
+    EXPECT_EQ((QStringList{"user.slice", "system.slice"}), paths(sampler.topChildren(4)));
+
+    const CgroupUsage ff = sampler.topLeaves(1).at(0);
+    EXPECT_EQ(2000 * MiB, ff.currentBytes);
+    EXPECT_EQ(4096 * MiB, ff.maxBytes);
+    EXPECT_DOUBLE_EQ(12.25, ff.someAvg10);
+    EXPECT_EQ(3, ff.depth);
+
+    const CgroupUsage user = sampler.topChildren(1).at(0);
+    EXPECT_EQ(-1, user.maxBytes);
+    EXPECT_EQ(64 * MiB, user.swapCurrentBytes);
+    EXPECT_FALSE(user.leaf);
+}
+
+TEST(CgroupSamplerTest, UpdatesOnlyTheSubtreeInotifyReports)
+{
+    QTemporaryDir root;
+    makeTree(root.path());
+    CgroupSampler sampler(root.path(), QString(), 4, ProcReader::Backend::Pread);
+    sampler.sample();
+    ASSERT_EQ(1, sampler.walks());
+    ASSERT_EQ(0, sampler.updates());
+
+    // Values change through the open fds, the hierarchy stays cached
+    writeFile(root.filePath("system.slice/sshd.service/memory.current"), QByteArray::number(9000 * MiB));
+    sampler.sample();
+    EXPECT_EQ(0, sampler.updates());
+    EXPECT_EQ(QStringLiteral("system.slice/sshd.service"), sampler.topLeaves(1).at(0).path);
+
+    // A new scope appears, only it is walked
+    addCgroup(root.path(), "user.slice/user-1000.slice/app-editor.scope", 1000 * MiB);
+    sampler.sample();
+    EXPECT_EQ(1, sampler.updates());
+    EXPECT_EQ(8, sampler.usage().size());
+    EXPECT_TRUE(paths(sampler.topLeaves(5)).contains("user.slice/user-1000.slice/app-editor.scope"));
+
+    // cgroup.events changing is not a hierarchy change
+    writeFile(root.filePath("user.slice/user-1000.slice/app-term.scope/cgroup.events"), "populated 0\nfrozen 0\n");
+    sampler.sample();
+    EXPECT_EQ(1, sampler.updates());
+
+    // ... and the scope goes away
+    ASSERT_TRUE(QDir(root.filePath("user.slice/user-1000.slice/app-term.scope")).removeRecursively());
+    sampler.sample();
+    EXPECT_EQ(2, sampler.updates());
+    EXPECT_EQ(7, sampler.usage().size());
+    EXPECT_FALSE(paths(sampler.topLeaves(5)).contains("user.slice/user-1000.slice/app-term.scope"));
+
+    // A whole slice goes, child first as rmdir requires
+    ASSERT_TRUE(QDir(root.filePath("system.slice")).removeRecursively());
+    sampler.sample();
+    EXPECT_EQ(4, sampler.updates());
+    EXPECT_EQ(5, sampler.usage().size());
+    EXPECT_EQ((QStringList{"user.slice"}), paths(sampler.topChildren(4)));
+
+    sampler.sample();
+    EXPECT_EQ(1, sampler.walks());
+    EXPECT_EQ(4, sampler.updates());
+    EXPECT_EQ(QString(), sampler.usage()[0].path);
+}
+
+TEST(CgroupSamplerTest, HonoursSubtreeAndDepth)
+{
+    QTemporaryDir root;
+    makeTree(root.path());
+
+    CgroupSampler user(root.path(), QStringLiteral("/user.slice"), 4, ProcReader::Backend::Pread);
+    user.sample();
+    EXPECT_EQ(4, user.usage().size());
+    EXPECT_EQ(3000 * MiB, user.usage()[0].currentBytes);
+    EXPECT_EQ((QStringList{"user-1000.slice"}), paths(user.topChildren(4)));
+
+    CgroupSampler shallow(root.path(), QString(), 1, ProcReader::Backend::Pread);
+    shallow.sample();
+    EXPECT_EQ(3, shallow.usage().size());
+    EXPECT_EQ((QStringList{"user.slice", "system.slice"}), paths(shallow.topLeaves(5)));
+
+    CgroupSampler missing(root.path(), QStringLiteral("/nope.slice"), 4, ProcReader::Backend::Pread);
+    missing.sample();
+    EXPECT_TRUE(missing.usage().isEmpty());
+}
@@ -0,0 +1,137 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#define private public
+#include "SystemSnapshot.h"
+#undef private
+#include "DBusService.h"
+#include "SampleHistory.h"
+#include <QDBusArgument>
+#include <QDBusVariant>
+
+// No bus needed: calls are built locally and answered through reply()
+
+namespace {
+
+QDBusMessage call(const QString& iface, const char* member, const QVariantList& args = {})
+{
+    QDBusMessage m = QDBusMessage::createMethodCall(QString::fromLatin1(DBusService::kService),
+                                                    QString::fromLatin1(DBusService::kPath), iface,
+                                                    QString::fromLatin1(member));
+    m.setArguments(args);
+    return m;
+}
+
+QDBusMessage properties(const char* member, const QVariantList& args)
+{
+    return call(QStringLiteral("org.freedesktop.DBus.Properties"), member, args);
+}
+
+void fill(SystemSnapshot& snap, double availableMiB, qint64 atMs)
+{
+    snap.m_mem.memTotalMiB = 1000.0;
+    snap.m_mem.memAvailableMiB = availableMiB;
+    snap.m_zram.present = true;
+    snap.m_psi.some_avg10 = 4.0;
+    snap.m_sampledAtMs = atMs;
+}
+
+ThresholdsPercent memLevels()
+{
+    ThresholdsPercent t;
+    t.warn_mem_percent = 40.0;
+    t.psi_metrics = QStringLiteral("full_avg10");
+    return t;
+}
+
+} // namespace
+
+TEST(DBusServiceTest, ServesCachedProperties)
+{
+    SystemSnapshot snap;
+    fill(snap, 300, 1000);
+    const ThresholdSet th = Thresholds::compute(memLevels(), snap);
+    SeverityEngine engine;
+    engine.update(th, snap, 1);
+    DBusService service(nullptr);
+    service.update(snap.data(), th, engine, true);
+    service.update(snap.data(), th, engine, true); // same sample
+    EXPECT_EQ(1u, service.rebuilds());
+
+    const QDBusMessage all = service.reply(properties("GetAll", {QString::fromLatin1(DBusService::kInterface)}));
+    ASSERT_EQ(QDBusMessage::ReplyMessage, all.type());
+    const QVariantMap props = all.arguments().value(0).toMap();
+    EXPECT_EQ(1u, props.value("Severity").toUInt());
+    EXPECT_EQ(QStringLiteral("warn"), props.value("SeverityName").toString());
+    EXPECT_EQ(QStringLiteral("RAM"), props.value("Cause").toString());
+    EXPECT_TRUE(props.value("DaemonActive").toBool());
+    EXPECT_DOUBLE_EQ(300, props.value("Memory").toMap().value("MemAvailableMiB").toDouble());
+    EXPECT_TRUE(props.value("Zram").toMap().value("Present").toBool());
+    EXPECT_DOUBLE_EQ(4.0, props.value("Psi").toMap().value("SomeAvg10").toDouble());
+    const QVariantMap th2 = props.value("Thresholds").toMap();
+    EXPECT_DOUBLE_EQ(400, th2.value("WarnMemFreeMiB").toDouble());
+    EXPECT_FALSE(th2.contains("HardMemFreeMiB")); // not configured
+    EXPECT_EQ(QStringLiteral("full_avg10"), th2.value("PsiMetrics").toString());
+
+    const QDBusMessage one = service.reply(properties("Get", {QString::fromLatin1(DBusService::kInterface), QStringLiteral("SeverityName")}));
+    ASSERT_EQ(QDBusMessage::ReplyMessage, one.type());
+    EXPECT_EQ(QStringLiteral("warn"), one.arguments().value(0).value<QDBusVariant>().variant().toString());
+
+    EXPECT_EQ(QDBusMessage::ErrorMessage, service.reply(properties("Get", {QString::fromLatin1(DBusService::kInterface), QStringLiteral("Nope")})).type());
+    EXPECT_EQ(QDBusMessage::ErrorMessage, service.reply(properties("Set", {QString::fromLatin1(DBusService::kInterface), QStringLiteral("Severity"), QVariant::fromValue(QDBusVariant(0u))})).type());
+    EXPECT_EQ(QDBusMessage::InvalidMessage, service.reply(call(QStringLiteral("org.example.Other"), "Ping")).type());
+}
+
+TEST(DBusServiceTest, SignalsSeverityTransitionsOnly)
+{
+    SystemSnapshot snap;
+    fill(snap, 900, 1000);
+    const ThresholdSet th = Thresholds::compute(memLevels(), snap);
+    SeverityEngine engine;
+    DBusService service(nullptr);
+    engine.update(th, snap, 1);
+    service.update(snap.data(), th, engine, true);
+    EXPECT_EQ(0u, service.severitySignals());
+
+    fill(snap, 300, 2000);
+    engine.update(th, snap, 2);
+    service.update(snap.data(), th, engine, true);
+    EXPECT_EQ(1u, service.severitySignals());
+
+    fill(snap, 290, 3000); // new sample, same level
+    engine.update(th, snap, 3);
+    service.update(snap.data(), th, engine, true);
+    EXPECT_EQ(1u, service.severitySignals());
+    EXPECT_EQ(3u, service.rebuilds());
+}
+
+TEST(DBusServiceTest, GetHistoryReturnsPackedArrays)
+{
+    SampleHistory history(100, 1000);
+    for (int i = 0; i < 10; ++i)
+        history.append(i * 1000, {float(100 + i), 50, 0, 1, 2}, i == 9 ? Severity::Warn : Severity::Normal);
+    DBusService service(&history);
+
+    const QDBusMessage r = service.reply(call(QString::fromLatin1(DBusService::kInterface), "GetHistory", {4u, 2u}));
+    ASSERT_EQ(QDBusMessage::ReplyMessage, r.type());
+    const QVariantList out = r.arguments();
+    ASSERT_EQ(7, out.size());
+    const QList<qlonglong> times = out[0].value<QList<qlonglong>>();
+    const QList<double> mem = out[1].value<QList<double>>();
+    ASSERT_EQ(2, times.size()); // samples 6-9 in two buckets
+    EXPECT_EQ(5001, times[0]);
+    EXPECT_DOUBLE_EQ(106.5, mem[0]);
+    EXPECT_DOUBLE_EQ(108.5, mem[1]);
+    const QByteArray severity = out[6].toByteArray();
+    ASSERT_EQ(2, severity.size());
+    EXPECT_EQ(char(Severity::Warn), severity[1]);
+
+    EXPECT_EQ(QDBusMessage::ErrorMessage,
+              service.reply(call(QString::fromLatin1(DBusService::kInterface), "GetHistory", {4u, 0u})).type());
+}
+
+TEST(DBusServiceTest, IntrospectsOnlyItsPath)
+{
+    DBusService service(nullptr);
+    EXPECT_TRUE(service.introspect(QString::fromLatin1(DBusService::kPath)).contains("SeverityChanged"));
+    EXPECT_TRUE(service.introspect(QStringLiteral("/other")).isEmpty());
+}
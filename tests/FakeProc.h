@@ -0,0 +1,43 @@
+// ===== tests/FakeProc.h =====
+#pragma once
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QString>
+#include <QtGlobal>
+
+// Fixture helpers for fake /proc, /sys and cgroupfs trees under a temporary
+// root, shared by the tests and benchmarks that point a reader at one
+namespace FakeProc {
+
+// Write content to path, creating the parent directories. Returns false,
+// with a warning, if it cannot.
+inline bool writeFile(const QString& path, const QByteArray& content) {
+    QDir().mkpath(QFileInfo(path).path());
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate) || f.write(content) != content.size()) {
+        qWarning("FakeProc: cannot write %s", qPrintable(path));
+        return false;
+    }
+    return true;
+}
+
+// root/<pid>/ with stat, status, oom_score, oom_score_adj, cmdline and
+// cgroup laid out as the kernel prints them
+inline void addProcess(const QString& root, int pid, const QByteArray& comm, qint64 rssKiB, qint64 swapKiB,
+                       int oomScore, int oomAdj = 0, quint64 start = 1000) {
+    const QString dir = root + '/' + QString::number(pid);
+    writeFile(dir + "/stat", QByteArray::number(pid) + " (" + comm + ") S 1 " + QByteArray::number(pid) +
+                                 " 0 0 -1 4194560 100 0 0 0 5 3 0 0 20 0 1 0 " + QByteArray::number(start) +
+                                 " 1000000 200 18446744073709551615\n");
+    writeFile(dir + "/status", "Name:\t" + comm + "\nState:\tS (sleeping)\nUid:\t1000\t1000\t1000\t1000\n"
+                               "VmRSS:\t" + QByteArray::number(rssKiB) + " kB\n"
+                               "VmSwap:\t" + QByteArray::number(swapKiB) + " kB\n");
+    writeFile(dir + "/oom_score", QByteArray::number(oomScore) + '\n');
+    writeFile(dir + "/oom_score_adj", QByteArray::number(oomAdj) + '\n');
+    writeFile(dir + "/cmdline", "/usr/bin/" + comm + '\0' + "--flag" + '\0');
+    writeFile(dir + "/cgroup", "0::/user.slice/app-" + comm + ".scope\n");
+}
+
+} // namespace FakeProc
@@ -0,0 +1,115 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#define private public
+#include "SystemSnapshot.h"
+#undef private
+#include "GaugeIcon.h"
+#include "Thresholds.h"
+#include <QGuiApplication>
+#include <QImage>
+
+static SystemSnapshot& sample(SystemSnapshot& snap, double memAvailable, double psiFull)
+{
+    snap.m_mem.memTotalMiB = 1000.0;
+    snap.m_mem.memAvailableMiB = memAvailable;
+    snap.m_psi.full_avg10 = psiFull;
+    return snap;
+}
+
+TEST(GaugeIconTest, QuantizesWithStickyLevels)
+{
+    SystemSnapshot snap;
+    ThresholdSet th;
+    th.hard_psi = 40.0;
+    GaugeIcon g;
+
+    GaugeIcon::State s = g.stateOf(th, sample(snap, 500, 20), Severity::Normal, true);
+    EXPECT_EQ(4, s.ram); // half of RAM in use
+    EXPECT_EQ(4, s.psi); // half of hard_psi
+    EXPECT_TRUE(g.update(s, GaugeIcon::Theme::Light));
+
+    // Within three quarters of a step of the level: unchanged
+    s = g.stateOf(th, sample(snap, 420, 23), Severity::Normal, true);
+    EXPECT_EQ(4, s.ram);
+    EXPECT_EQ(4, s.psi);
+    EXPECT_FALSE(g.update(s, GaugeIcon::Theme::Light));
+
+    // Past that, the nearest level
+    s = g.stateOf(th, sample(snap, 400, 100), Severity::Hard, true);
+    EXPECT_EQ(5, s.ram);
+    EXPECT_EQ(GaugeIcon::kLevels, s.psi); // clamped
+    EXPECT_TRUE(g.update(s, GaugeIcon::Theme::Light));
+
+    EXPECT_TRUE(g.update(s, GaugeIcon::Theme::Dark)); // the theme alone changes the icon
+}
+
+TEST(GaugeIconTest, PaintsEachStateOnce)
+{
+    int argc = 0;
+    char** argv = nullptr;
+    qputenv("QT_QPA_PLATFORM", QByteArray("offscreen"));
+    QGuiApplication app(argc, argv);
+
+    GaugeIcon g;
+    GaugeIcon::State s;
+    s.ram = 3;
+    g.update(s, GaugeIcon::Theme::Light);
+    const QIcon first = g.icon();
+    EXPECT_EQ(int(std::size(GaugeIcon::kSizes)), g.painted());
+    EXPECT_FALSE(first.availableSizes().isEmpty());
+
+    g.icon();
+    EXPECT_EQ(int(std::size(GaugeIcon::kSizes)), g.painted()); // all from the cache
+
+    s.psi = 1;
+    g.update(s, GaugeIcon::Theme::Light);
+    g.icon();
+    EXPECT_EQ(2 * int(std::size(GaugeIcon::kSizes)), g.painted());
+    EXPECT_EQ(g.painted(), g.cached());
+}
+
+TEST(GaugeIconTest, CacheIsBounded)
+{
+    int argc = 0;
+    char** argv = nullptr;
+    qputenv("QT_QPA_PLATFORM", QByteArray("offscreen"));
+    QGuiApplication app(argc, argv);
+
+    GaugeIcon g;
+    GaugeIcon::State s;
+    for (int ram = 0; ram <= GaugeIcon::kLevels; ++ram) {
+        for (int psi = 0; psi <= GaugeIcon::kLevels; ++psi) {
+            s.ram = static_cast<quint8>(ram);
+            s.psi = static_cast<quint8>(psi);
+            g.update(s, GaugeIcon::Theme::Dark);
+            g.icon();
+        }
+    }
+    EXPECT_LE(g.cachedBytes(), GaugeIcon::kCacheBytes);
+    EXPECT_LT(g.cached(), g.painted());
+
+    // The latest state is still cached, the first one was evicted
+    const int painted = g.painted();
+    g.icon();
+    EXPECT_EQ(painted, g.painted());
+    g.update(GaugeIcon::State {}, GaugeIcon::Theme::Dark);
+    g.icon();
+    EXPECT_EQ(painted + int(std::size(GaugeIcon::kSizes)), g.painted());
+}
+
+TEST(GaugeIconTest, BarsFillFromTheBottom)
+{
+    int argc = 0;
+    char** argv = nullptr;
+    qputenv("QT_QPA_PLATFORM", QByteArray("offscreen"));
+    QGuiApplication app(argc, argv);
+
+    GaugeIcon::State s;
+    s.ram = GaugeIcon::kLevels; // full
+    s.psi = 0;                  // empty
+    const QImage img = GaugeIcon::paint(s, 32, GaugeIcon::Theme::Light).toImage();
+    ASSERT_EQ(QSize(32, 32), img.size());
+    const QRgb green = qRgb(0x27, 0xae, 0x60);
+    EXPECT_EQ(green, img.pixel(8, 4));   // top of the RAM bar
+    EXPECT_NE(green, img.pixel(24, 28)); // bottom of the PSI bar
+}
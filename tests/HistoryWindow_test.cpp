@@ -0,0 +1,85 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "HistoryWindow.h"
+#include "SystemSnapshot.h"
+#include "Thresholds.h"
+#include <QApplication>
+#include <QTemporaryDir>
+
+static constexpr qint64 kStartMs = 1700000000000;
+
+static SampleHistory::Values values(int i)
+{
+    return {float(4000 + (i % 600)), 2048.0f, 512.0f, float(i % 7), float(i % 3)};
+}
+
+TEST(HistoryWindowTest, RedrawsOnlyWhatIsNew)
+{
+    int argc = 0;
+    char** argv = nullptr;
+    qputenv("QT_QPA_PLATFORM", QByteArray("offscreen"));
+    QApplication app(argc, argv);
+
+    QTemporaryDir dir;
+    SystemSnapshot snap(dir.path(), dir.path());
+    ThresholdSet th;
+    th.warn_mem_free.mib = 1000;
+    th.psi_metrics = QStringLiteral("full_avg10");
+
+    SampleHistory history;
+    HistoryWindow w(&history);
+    w.show();
+    QApplication::processEvents();
+    ASSERT_GT(w.columns(), 0);
+    EXPECT_EQ(300, w.rangeSeconds());
+
+    for (int i = 0; i < 100; ++i) history.append(kStartMs + i * 1000, values(i), Severity::Normal);
+    w.refresh(th, snap);
+    EXPECT_EQ(1, w.fullRedraws());
+    EXPECT_EQ(0, w.partialRedraws());
+    EXPECT_EQ(100, w.keptPoints(SampleHistory::MemAvailableMiB)); // fewer samples than columns
+
+    // A tick adds a sample and touches only the end
+    history.append(kStartMs + 100 * 1000, values(100), Severity::Normal);
+    w.refresh(th, snap);
+    EXPECT_EQ(1, w.fullRedraws());
+    EXPECT_EQ(1, w.partialRedraws());
+    EXPECT_EQ(101, w.keptPoints(SampleHistory::PsiFullAvg10));
+
+    // Nothing new, nothing drawn
+    w.refresh(th, snap);
+    EXPECT_EQ(1, w.fullRedraws());
+    EXPECT_EQ(1, w.partialRedraws());
+
+    w.setRangeSeconds(3600);
+    EXPECT_EQ(3600, w.rangeSeconds());
+    EXPECT_EQ(2, w.fullRedraws());
+}
+
+TEST(HistoryWindowTest, DayFitsThePixelWidth)
+{
+    int argc = 0;
+    char** argv = nullptr;
+    qputenv("QT_QPA_PLATFORM", QByteArray("offscreen"));
+    QApplication app(argc, argv);
+
+    QTemporaryDir dir;
+    SystemSnapshot snap(dir.path(), dir.path());
+    SampleHistory history;
+    for (int i = 0; i < SampleHistory::kDefaultCapacity; ++i)
+        history.append(kStartMs + qint64(i) * 1000, values(i), Severity::Normal);
+
+    HistoryWindow w(&history);
+    w.setRangeSeconds(24 * 3600);
+    w.show();
+    QApplication::processEvents();
+    w.refresh(ThresholdSet {}, snap);
+
+    const int kept = w.keptPoints(SampleHistory::MemAvailableMiB);
+    EXPECT_LE(kept, w.columns());
+    EXPECT_GE(kept, w.columns() - 1); // every column holds samples
+
+    // The 5 min view of the same data keeps one point per sample
+    w.setRangeSeconds(300);
+    EXPECT_LE(w.keptPoints(SampleHistory::ZramUsedMiB), 301);
+}
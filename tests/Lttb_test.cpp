@@ -0,0 +1,42 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "Lttb.h"
+#include <cmath>
+#include <vector>
+
+TEST(LttbTest, KeepsEndsAndPeaks)
+{
+    // A flat line with one spike; averaging would flatten it to a bump
+    std::vector<double> y(10000, 1.0);
+    y[4321] = 50;
+    auto idx = Lttb::select(int(y.size()), 100, [](int i) { return double(i); }, [&](int i) { return y[i]; });
+    ASSERT_LE(idx.size(), 100u);
+    EXPECT_EQ(0, idx.front());
+    EXPECT_EQ(9999, idx.back());
+    EXPECT_NE(idx.end(), std::find(idx.begin(), idx.end(), 4321));
+    EXPECT_TRUE(std::is_sorted(idx.begin(), idx.end()));
+}
+
+TEST(LttbTest, ShortInputIsKeptWhole)
+{
+    auto idx = Lttb::select(5, 100, [](int i) { return double(i); }, [](int) { return 0.0; });
+    EXPECT_EQ((std::vector<int> {0, 1, 2, 3, 4}), idx);
+}
+
+TEST(LttbTest, BucketsHonourAnchorAndSkipEmpty)
+{
+    const std::vector<double> y {0, 10, 0, 0, 5, 6};
+    auto x = [](int i) { return double(i); };
+    auto v = [&](int i) { return y[i]; };
+    std::vector<int> out;
+    // Buckets {0,1,2}, {}, {3,4}, {5}: one pick per non-empty bucket
+    Lttb::selectInBuckets({0, 3, 3, 5, 6}, Lttb::Point {-1, 0}, x, v, &out);
+    ASSERT_EQ(3u, out.size());
+    EXPECT_EQ(1, out[0]); // the spike spans the largest triangle
+    EXPECT_EQ(5, out[2]);
+
+    // Without an anchor the first bucket keeps its first point
+    out.clear();
+    Lttb::selectInBuckets({0, 3, 6}, std::nullopt, x, v, &out);
+    EXPECT_EQ((std::vector<int> {0, 3}), out); // the last bucket is judged against its own end
+}
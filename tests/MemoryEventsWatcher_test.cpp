@@ -0,0 +1,102 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "MemoryEventsWatcher.h"
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+static void writeEvents(const QString& dir, int high, int max, int oom, int oomKill)
+{
+    QDir().mkpath(dir);
+    QFile f(dir + "/memory.events");
+    ASSERT_TRUE(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    f.write(QStringLiteral("low 0\nhigh %1\nmax %2\noom %3\noom_kill %4\noom_group_kill 0\n")
+                .arg(high).arg(max).arg(oom).arg(oomKill).toLatin1());
+}
+
+TEST(MemoryEventsWatcherTest, ParsesCounters)
+{
+    const MemoryEventCounts c = MemoryEventsWatcher::parse("low 1\nhigh 22\nmax 3\noom 4\noom_kill 5\noom_group_kill 6\n");
+    EXPECT_EQ(1, c.low);
+    EXPECT_EQ(22, c.high);
+    EXPECT_EQ(3, c.max);
+    EXPECT_EQ(4, c.oom);
+    EXPECT_EQ(5, c.oomKill);
+    EXPECT_EQ(6, c.oomGroupKill);
+    EXPECT_TRUE(MemoryEventsWatcher::parse("").isZero());
+}
+
+TEST(MemoryEventsWatcherTest, ReportsIncrementsOnly)
+{
+    QTemporaryDir tmp;
+    ASSERT_TRUE(tmp.isValid());
+    const QString app = tmp.path() + "/user.slice/app.scope";
+    writeEvents(app, 10, 2, 0, 0);
+
+    MemoryEventsWatcher w(tmp.path(), {"/user.slice/app.scope"});
+    ASSERT_EQ(QStringList{"user.slice/app.scope"}, w.watched());
+
+    QVector<MemoryEventRecord> seen;
+    QObject::connect(&w, &MemoryEventsWatcher::eventsChanged, [&](const MemoryEventRecord& r) { seen << r; });
+    w.poll();
+    EXPECT_TRUE(seen.isEmpty()); // counts from before the start are history
+
+    writeEvents(app, 13, 2, 1, 1);
+    w.poll();
+    ASSERT_EQ(1, seen.size());
+    EXPECT_EQ(QStringLiteral("user.slice/app.scope"), seen[0].cgroup);
+    EXPECT_EQ(3, seen[0].delta.high);
+    EXPECT_EQ(0, seen[0].delta.max);
+    EXPECT_EQ(1, seen[0].delta.oomKill);
+    EXPECT_EQ(13, seen[0].total.high);
+    EXPECT_EQ(QStringLiteral("oom_kill +1, oom +1, high +3"), seen[0].summary());
+
+    // Rewriting the same values is a modify without a change
+    writeEvents(app, 13, 2, 1, 1);
+    w.poll();
+    EXPECT_EQ(1, seen.size());
+    EXPECT_EQ(1, w.recent().size());
+}
+
+TEST(MemoryEventsWatcherTest, HostRootWatchesTopLevelSlices)
+{
+    QTemporaryDir tmp;
+    ASSERT_TRUE(tmp.isValid());
+    writeEvents(tmp.path() + "/system.slice", 0, 0, 0, 0);
+    writeEvents(tmp.path() + "/user.slice", 0, 0, 0, 0);
+
+    MemoryEventsWatcher w(tmp.path(), {"/"});
+    EXPECT_EQ((QStringList{"system.slice", "user.slice"}), w.watched());
+
+    writeEvents(tmp.path() + "/user.slice", 0, 4, 0, 0);
+    w.poll();
+    ASSERT_EQ(1, w.recent().size());
+    EXPECT_EQ(QStringLiteral("user.slice"), w.recent()[0].cgroup);
+    EXPECT_EQ(4, w.recent()[0].delta.max);
+}
+
+TEST(MemoryEventsWatcherTest, KeepsBoundedRecentList)
+{
+    QTemporaryDir tmp;
+    ASSERT_TRUE(tmp.isValid());
+    writeEvents(tmp.path(), 0, 0, 0, 0); // a container's own root has memory.events
+
+    MemoryEventsWatcher w(tmp.path(), {"/"});
+    ASSERT_EQ(QStringList{"/"}, w.watched());
+    for (int i = 1; i <= MemoryEventsWatcher::kRecent + 3; ++i) {
+        writeEvents(tmp.path(), i, 0, 0, 0);
+        w.poll();
+    }
+    ASSERT_EQ(MemoryEventsWatcher::kRecent, w.recent().size());
+    EXPECT_EQ(MemoryEventsWatcher::kRecent + 3, w.recent().front().total.high); // newest first
+}
+
+TEST(MemoryEventsWatcherTest, MissingCgroupIsSkipped)
+{
+    QTemporaryDir tmp;
+    ASSERT_TRUE(tmp.isValid());
+    MemoryEventsWatcher w(tmp.path(), {"nope.slice"});
+    EXPECT_TRUE(w.watched().isEmpty());
+    w.poll();
+    EXPECT_TRUE(w.recent().isEmpty());
+}
@@ -0,0 +1,47 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "MemoryLock.h"
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+TEST(MemoryLockTest, ReportParsesSelfStatus)
+{
+    QTemporaryDir procDir;
+    QDir().mkpath(procDir.filePath("self"));
+    QFile status(procDir.filePath("self/status"));
+    ASSERT_TRUE(status.open(QIODevice::WriteOnly | QIODevice::Text));
+    QTextStream ts(&status);
+    ts << "Name:\tnohang-tray\n";
+    ts << "VmLck:\t    2048 kB\n";
+    ts << "VmRSS:\t    4096 kB\n";
+    status.close();
+
+    const MemoryLockReport r = MemoryLock::report(procDir.path());
+    EXPECT_DOUBLE_EQ(2.0, r.lockedMiB);
+    EXPECT_DOUBLE_EQ(4.0, r.residentMiB);
+}
+
+TEST(MemoryLockTest, ReportIsZeroWithoutStatus)
+{
+    QTemporaryDir procDir;
+    const MemoryLockReport r = MemoryLock::report(procDir.path());
+    EXPECT_DOUBLE_EQ(0.0, r.lockedMiB);
+    EXPECT_DOUBLE_EQ(0.0, r.residentMiB);
+}
+
+TEST(MemoryLockTest, LockAllPinsResidentMemory)
+{
+    MemoryLock::Options opts;
+    opts.heapArenaBytes = 1024 * 1024;
+    QString err;
+    if (!MemoryLock::lockAll(opts, &err)) {
+        EXPECT_FALSE(err.isEmpty());
+        GTEST_SKIP() << "mlockall refused: " << err.toStdString();
+    }
+    const MemoryLockReport r = MemoryLock::report();
+    MemoryLock::unlockAll();
+    EXPECT_GT(r.lockedMiB, 0.0);
+    EXPECT_GT(r.residentMiB, 0.0);
+}
@@ -0,0 +1,189 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "MetricsServer.h"
+#include "SystemSnapshot.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using MetricsProtocol::Message;
+
+namespace {
+
+int connectTo(const QString& path)
+{
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    const QByteArray p = QFile::encodeName(path);
+    std::memcpy(addr.sun_path, p.constData(), static_cast<size_t>(p.size()));
+    const int fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void request(int fd, char r) { ASSERT_EQ(1, ::send(fd, &r, 1, MSG_NOSIGNAL)); }
+
+// Runs the event loop until pred holds or a second has passed
+template <typename Pred>
+bool waitFor(Pred pred)
+{
+    QElapsedTimer t;
+    t.start();
+    while (!pred() && t.elapsed() < 1000) QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    return pred();
+}
+
+bool receive(int fd, Message* m)
+{
+    bool got = false;
+    waitFor([&] { return got = ::recv(fd, m, sizeof(*m), MSG_DONTWAIT) == static_cast<ssize_t>(sizeof(*m)); });
+    return got;
+}
+
+SnapshotData sample(double availableMiB)
+{
+    SnapshotData d {};
+    d.mem.memTotalMiB = 16384;
+    d.mem.memAvailableMiB = availableMiB;
+    d.psi.some_avg10 = 1.234;
+    d.sampledAtMs = 42;
+    return d;
+}
+
+} // namespace
+
+TEST(MetricsServerTest, EncodesFixedLayout)
+{
+    SnapshotData d = sample(8000.4);
+    d.swaps.spilledMiB = 12;
+    d.vmstat.swapInMiBPerSec = 1.5;
+    const Message m = MetricsServer::encode(d, Severity::Soft, SeverityMetric::Psi, true);
+    EXPECT_EQ(MetricsProtocol::kMagic, m.magic);
+    EXPECT_EQ(sizeof(Message), m.size);
+    EXPECT_EQ(2, m.severity);
+    EXPECT_EQ(static_cast<int>(SeverityMetric::Psi), m.cause);
+    EXPECT_EQ(8000u, m.memAvailableMiB);
+    EXPECT_EQ(123, m.psiSomeAvg10);
+    EXPECT_EQ(1536u, m.swapInKiBPerSec);
+    EXPECT_EQ(12u, m.spilledMiB);
+    EXPECT_TRUE(m.flags & MetricsProtocol::DaemonActive);
+    EXPECT_TRUE(m.flags & MetricsProtocol::SpilledToDisk);
+    EXPECT_FALSE(m.flags & MetricsProtocol::HasZram);
+}
+
+TEST(MetricsServerTest, GetAndSubscribeReceiveOnlyChanges)
+{
+    int argc = 0;
+    QCoreApplication app(argc, nullptr);
+    QTemporaryDir dir;
+    MetricsServer server;
+    QString err;
+    ASSERT_TRUE(server.listen(dir.filePath("m.sock"), &err)) << qPrintable(err);
+    EXPECT_TRUE(server.publish(MetricsServer::encode(sample(8000), Severity::Normal, SeverityMetric::Mem, true)));
+
+    const int getter = connectTo(server.path());
+    const int sub = connectTo(server.path());
+    ASSERT_GE(getter, 0);
+    ASSERT_GE(sub, 0);
+    request(getter, MetricsProtocol::Get);
+    request(sub, MetricsProtocol::Subscribe);
+
+    Message m;
+    ASSERT_TRUE(receive(getter, &m));
+    EXPECT_EQ(1u, m.seq);
+    EXPECT_EQ(8000u, m.memAvailableMiB);
+    ASSERT_TRUE(receive(sub, &m)); // the latest right away
+    ASSERT_TRUE(waitFor([&] { return server.subscriberCount() == 1; }));
+
+    // Sub-MiB noise and a new timestamp are not a change
+    SnapshotData same = sample(8000.2);
+    same.sampledAtMs = 99;
+    EXPECT_FALSE(server.publish(MetricsServer::encode(same, Severity::Normal, SeverityMetric::Mem, true)));
+    EXPECT_TRUE(server.publish(MetricsServer::encode(sample(7000), Severity::Warn, SeverityMetric::Mem, true)));
+    ASSERT_TRUE(receive(sub, &m));
+    EXPECT_EQ(2u, m.seq);
+    EXPECT_EQ(7000u, m.memAvailableMiB);
+    EXPECT_EQ(1, m.severity);
+    EXPECT_FALSE(receive(getter, &m)); // Get is one-shot
+    EXPECT_FALSE(receive(sub, &m));    // and nothing more was sent
+
+    ::close(getter);
+    ::close(sub);
+    EXPECT_TRUE(waitFor([&] { return server.clientCount() == 0; }));
+}
+
+TEST(MetricsServerTest, DropsClientsThatStopReading)
+{
+    int argc = 0;
+    QCoreApplication app(argc, nullptr);
+    QTemporaryDir dir;
+    MetricsServer server;
+    ASSERT_TRUE(server.listen(dir.filePath("m.sock")));
+    const int lazy = connectTo(server.path());
+    request(lazy, MetricsProtocol::Subscribe);
+    ASSERT_TRUE(waitFor([&] { return server.subscriberCount() == 1; }));
+
+    // Never read: once the socket queue is full, sends fail and the client goes
+    for (int i = 0; i < 100000 && server.clientCount() > 0; ++i)
+        server.publish(MetricsServer::encode(sample(i), Severity::Normal, SeverityMetric::Mem, true));
+    EXPECT_EQ(0, server.clientCount());
+    EXPECT_GE(server.drops(), quint64(MetricsServer::kMaxDrops));
+    ::close(lazy);
+}
+
+TEST(MetricsServerTest, RefusesPathOwnedByLiveServer)
+{
+    int argc = 0;
+    QCoreApplication app(argc, nullptr);
+    QTemporaryDir dir;
+    MetricsServer first;
+    ASSERT_TRUE(first.listen(dir.filePath("m.sock")));
+    MetricsServer second;
+    QString err;
+    EXPECT_FALSE(second.listen(dir.filePath("m.sock"), &err));
+    EXPECT_FALSE(err.isEmpty());
+
+    first.close();
+    EXPECT_TRUE(second.listen(dir.filePath("m.sock")));
+}
+
+TEST(MetricsServerTest, LeavesOtherFilesAlone)
+{
+    int argc = 0;
+    QCoreApplication app(argc, nullptr);
+    QTemporaryDir dir;
+    QFile file(dir.filePath("notes.txt"));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("keep me");
+    file.close();
+
+    MetricsServer server;
+    QString err;
+    EXPECT_FALSE(server.listen(file.fileName(), &err));
+    EXPECT_FALSE(err.isEmpty());
+    EXPECT_TRUE(file.exists());
+
+    // A live stream socket is not stale just because it is not SEQPACKET
+    const int other = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    const QByteArray path = QFile::encodeName(dir.filePath("s.sock"));
+    std::memcpy(addr.sun_path, path.constData(), static_cast<size_t>(path.size()));
+    ASSERT_EQ(0, ::bind(other, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)));
+    ASSERT_EQ(0, ::listen(other, 1));
+    EXPECT_FALSE(server.listen(dir.filePath("s.sock")));
+    EXPECT_TRUE(QFileInfo::exists(dir.filePath("s.sock")));
+
+    // Closed, it is a stale leftover and gets replaced
+    ::close(other);
+    EXPECT_TRUE(server.listen(dir.filePath("s.sock")));
+}
@@ -0,0 +1,128 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "FakeProc.h"
+#include "ProcReader.h"
+#include <QTemporaryDir>
+
+using FakeProc::writeFile;
+
+class ProcReaderTest : public ::testing::TestWithParam<ProcReader::Backend> {};
+
+TEST_P(ProcReaderTest, ReadsRegisteredFilesInOneBatch)
+{
+    QTemporaryDir dir;
+    writeFile(dir.filePath("a"), "alpha\n");
+    writeFile(dir.filePath("b"), "beta\n");
+
+    auto r = ProcReader::create(GetParam());
+    const int a = r->add(dir.filePath("a"));
+    const int b = r->add(dir.filePath("b"));
+    r->readAll();
+
+    ASSERT_TRUE(r->ok(a));
+    ASSERT_TRUE(r->ok(b));
+    EXPECT_EQ(QByteArrayView("alpha\n"), r->data(a));
+    EXPECT_EQ(QByteArrayView("beta\n"), r->data(b));
+    EXPECT_EQ(dir.filePath("a"), r->path(a));
+}
+
+TEST_P(ProcReaderTest, KeepsFdsOpenAndSeesRewrites)
+{
+    QTemporaryDir dir;
+    writeFile(dir.filePath("a"), "first\n");
+
+    auto r = ProcReader::create(GetParam());
+    const int a = r->add(dir.filePath("a"));
+    r->readAll();
+    EXPECT_EQ(QByteArrayView("first\n"), r->data(a));
+    const quint64 afterFirst = r->syscalls();
+
+    writeFile(dir.filePath("a"), "second, longer\n");
+    r->readAll();
+    EXPECT_EQ(QByteArrayView("second, longer\n"), r->data(a));
+    // no reopen: one read (or one ring submission) per batch
+    EXPECT_EQ(afterFirst + 1, r->syscalls());
+}
+
+TEST_P(ProcReaderTest, MissingFileIsRetried)
+{
+    QTemporaryDir dir;
+    auto r = ProcReader::create(GetParam());
+    const int a = r->add(dir.filePath("late"));
+    r->readAll();
+    EXPECT_FALSE(r->ok(a));
+    EXPECT_TRUE(r->data(a).isEmpty());
+
+    writeFile(dir.filePath("late"), "here\n");
+    r->readAll();
+    ASSERT_TRUE(r->ok(a));
+    EXPECT_EQ(QByteArrayView("here\n"), r->data(a));
+}
+
+TEST_P(ProcReaderTest, GrowsBufferForLargeFiles)
+{
+    QTemporaryDir dir;
+    const QByteArray big(100000, 'x');
+    writeFile(dir.filePath("big"), big);
+
+    auto r = ProcReader::create(GetParam());
+    const int a = r->add(dir.filePath("big"));
+    r->readAll();
+    ASSERT_TRUE(r->ok(a));
+    EXPECT_EQ(big.size(), r->data(a).size());
+}
+
+TEST_P(ProcReaderTest, GrowsSmallBuffers)
+{
+    QTemporaryDir dir;
+    writeFile(dir.filePath("n"), "123456789012345678901234567890\n");
+
+    auto r = ProcReader::create(GetParam());
+    const int a = r->add(dir.filePath("n"), 16);
+    r->readAll();
+    ASSERT_TRUE(r->ok(a));
+    EXPECT_EQ(QByteArrayView("123456789012345678901234567890\n"), r->data(a));
+}
+
+TEST_P(ProcReaderTest, RemovedSlotsAreSkippedAndReused)
+{
+    QTemporaryDir dir;
+    writeFile(dir.filePath("a"), "alpha\n");
+    writeFile(dir.filePath("b"), "beta\n");
+    writeFile(dir.filePath("c"), "gamma\n");
+
+    auto r = ProcReader::create(GetParam());
+    const int a = r->add(dir.filePath("a"));
+    const int b = r->add(dir.filePath("b"));
+    r->readAll();
+    r->remove(a);
+    r->readAll();
+    EXPECT_FALSE(r->ok(a));
+    EXPECT_EQ(QByteArrayView("beta\n"), r->data(b));
+
+    const int c = r->add(dir.filePath("c"));
+    EXPECT_EQ(a, c);
+    r->readAll();
+    EXPECT_EQ(QByteArrayView("gamma\n"), r->data(c));
+    EXPECT_EQ(dir.filePath("c"), r->path(c));
+}
+
+TEST_P(ProcReaderTest, ReadsLiveProc)
+{
+    auto r = ProcReader::create(GetParam());
+    const int a = r->add(QStringLiteral("/proc/meminfo"));
+    r->readAll();
+    r->readAll();
+    ASSERT_TRUE(r->ok(a));
+    EXPECT_TRUE(r->data(a).startsWith("MemTotal:"));
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, ProcReaderTest,
+                         ::testing::Values(ProcReader::Backend::Pread, ProcReader::Backend::IoUring));
+
+TEST(ProcReaderBackendTest, EnvironmentSelectsPread)
+{
+    qputenv("NOHANG_TRAY_IO_BACKEND", "pread");
+    EXPECT_EQ(ProcReader::Backend::Pread, ProcReader::create()->backend());
+    qunsetenv("NOHANG_TRAY_IO_BACKEND");
+}
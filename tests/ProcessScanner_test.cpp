@@ -0,0 +1,241 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "FakeProc.h"
+#include "ProcessScanner.h"
+#include <QDir>
+#include <QTemporaryDir>
+#include <unistd.h>
+
+using FakeProc::addProcess;
+using FakeProc::writeFile;
+
+TEST(ProcessScannerTest, ParsesFakeProcRoot)
+{
+    QTemporaryDir root;
+    addProcess(root.path(), 42, "firefox", 204800, 1024, 700, 100, 5555);
+    addProcess(root.path(), 7, "odd) name (x", 1024, 0, 10, -100);
+    QDir().mkpath(root.filePath("self"));    // non-numeric entries are ignored
+    QDir().mkpath(root.filePath("sys"));
+    writeFile(root.filePath("meminfo"), "MemTotal: 1 kB\n");
+
+    ProcessScanner scanner(root.path());
+    const QVector<ProcessInfo> rows = scanner.scan();
+    ASSERT_EQ(2, rows.size());
+
+    EXPECT_EQ(7, rows[0].pid);
+    EXPECT_EQ(QStringLiteral("odd) name (x"), rows[0].name);
+    EXPECT_EQ(-100, rows[0].oomScoreAdj);
+
+    const ProcessInfo& ff = rows[1];
+    EXPECT_EQ(42, ff.pid);
+    EXPECT_EQ(1, ff.ppid);
+    EXPECT_EQ(QStringLiteral("firefox"), ff.name);
+    EXPECT_EQ('S', ff.state);
+    EXPECT_EQ(1000u, ff.uid);
+    EXPECT_EQ(204800, ff.rssKiB);
+    EXPECT_EQ(1024, ff.swapKiB);
+    EXPECT_EQ(700, ff.oomScore);
+    EXPECT_EQ(100, ff.oomScoreAdj);
+    EXPECT_EQ(5555u, ff.startTime);
+    EXPECT_EQ(QStringLiteral("/usr/bin/firefox --flag"), ff.cmdline);
+    EXPECT_EQ(QStringLiteral("/user.slice/app-firefox.scope"), ff.cgroup);
+}
+
+TEST(ProcessScannerTest, WorkerCountDoesNotChangeResult)
+{
+    QTemporaryDir root;
+    for (int pid = 1; pid <= 300; ++pid) addProcess(root.path(), pid, "p" + QByteArray::number(pid), pid, 0, pid, 0);
+
+    const QVector<ProcessInfo> one = ProcessScanner(root.path(), 1).scan();
+    const QVector<ProcessInfo> four = ProcessScanner(root.path(), 4).scan();
+    ASSERT_EQ(300, one.size());
+    ASSERT_EQ(one.size(), four.size());
+    for (qsizetype i = 0; i < one.size(); ++i) {
+        EXPECT_EQ(one[i].pid, four[i].pid);
+        EXPECT_EQ(one[i].rssKiB, four[i].rssKiB);
+    }
+    EXPECT_TRUE(std::is_sorted(four.begin(), four.end(),
+                               [](const ProcessInfo& a, const ProcessInfo& b) { return a.pid < b.pid; }));
+}
+
+TEST(ProcessScannerTest, SkipsVanishedAndKernelThreads)
+{
+    QTemporaryDir root;
+    addProcess(root.path(), 10, "alive", 100, 0, 1, 0);
+    QDir().mkpath(root.filePath("11"));             // exited between readdir and open
+    QDir().mkpath(root.filePath("2"));              // kernel thread: no VmRSS
+    writeFile(root.filePath("2/stat"), "2 (kthreadd) S 0 0 0 0 -1 0 0 0 0 0 0 0 0 0 20 0 1 0 2 0 0 0\n");
+    writeFile(root.filePath("2/status"), "Name:\tkthreadd\nUid:\t0\t0\t0\t0\n");
+
+    const QVector<ProcessInfo> rows = ProcessScanner(root.path()).scan();
+    ASSERT_EQ(2, rows.size());
+    EXPECT_EQ(2, rows[0].pid);
+    EXPECT_EQ(0, rows[0].rssKiB);
+    EXPECT_EQ(10, rows[1].pid);
+}
+
+TEST(ProcessScannerTest, UpdateReportsRowDeltas)
+{
+    QTemporaryDir root;
+    addProcess(root.path(), 10, "a", 100, 0, 1, 0);
+    addProcess(root.path(), 20, "b", 200, 0, 2, 0);
+    addProcess(root.path(), 30, "c", 300, 0, 3, 0);
+
+    ProcessScanner scanner(root.path(), 1);
+    ProcessDelta first = scanner.update();
+    EXPECT_EQ(3, first.added.size());
+    EXPECT_TRUE(first.removed.isEmpty());
+    EXPECT_EQ(3, scanner.staticReads());
+
+    // Nothing moved: no deltas and no static reads
+    EXPECT_TRUE(scanner.update().isEmpty());
+    EXPECT_EQ(3, scanner.staticReads());
+
+    // 20 grows, 30 exits, 40 starts
+    addProcess(root.path(), 20, "b", 999, 5, 2, 0);
+    QDir(root.filePath("30")).removeRecursively();
+    addProcess(root.path(), 40, "d", 400, 0, 4, 0);
+    const ProcessDelta d = scanner.update();
+    ASSERT_EQ(1, d.changed.size());
+    EXPECT_EQ(20, d.changed[0].pid);
+    EXPECT_EQ(999, d.changed[0].rssKiB);
+    EXPECT_EQ(QStringLiteral("/usr/bin/b --flag"), d.changed[0].cmdline); // kept from the cache
+    EXPECT_EQ(QVector<int>{30}, d.removed);
+    ASSERT_EQ(1, d.added.size());
+    EXPECT_EQ(40, d.added[0].pid);
+    EXPECT_EQ(4, scanner.staticReads());
+    EXPECT_EQ(3, scanner.cached().size());
+}
+
+TEST(ProcessScannerTest, UpdateDetectsPidReuse)
+{
+    QTemporaryDir root;
+    addProcess(root.path(), 10, "old", 100, 0, 1, 0, 1000);
+    ProcessScanner scanner(root.path(), 1);
+    scanner.update();
+
+    // Static files change without a new start time: the cache wins
+    writeFile(root.filePath("10/cmdline"), QByteArray("/usr/bin/renamed\0", 17));
+    EXPECT_TRUE(scanner.update().isEmpty());
+    EXPECT_EQ(QStringLiteral("/usr/bin/old --flag"), scanner.cached()[0].cmdline);
+
+    // Same pid, new start time: a different process
+    addProcess(root.path(), 10, "new", 100, 0, 1, 0, 2000);
+    const ProcessDelta d = scanner.update();
+    EXPECT_EQ(QVector<int>{10}, d.removed);
+    ASSERT_EQ(1, d.added.size());
+    EXPECT_EQ(QStringLiteral("new"), d.added[0].name);
+    EXPECT_EQ(QStringLiteral("/usr/bin/new --flag"), d.added[0].cmdline);
+    EXPECT_EQ(2000u, d.added[0].startTime);
+    EXPECT_TRUE(d.changed.isEmpty());
+}
+
+static void addRollup(const QString& root, int pid, qint64 pss, qint64 anon, qint64 shmem, qint64 swapPss)
+{
+    writeFile(root + '/' + QString::number(pid) + "/smaps_rollup",
+              "55d0c0000000-7ffd00000000 ---p 00000000 00:00 0                          [rollup]\n"
+              "Rss:               " + QByteArray::number(pss * 2) + " kB\n"
+              "Pss:               " + QByteArray::number(pss) + " kB\n"
+              "Pss_Dirty:         " + QByteArray::number(pss) + " kB\n"
+              "Pss_Anon:          " + QByteArray::number(anon) + " kB\n"
+              "Pss_File:          0 kB\n"
+              "Pss_Shmem:         " + QByteArray::number(shmem) + " kB\n"
+              "Swap:              " + QByteArray::number(swapPss * 3) + " kB\n"
+              "SwapPss:           " + QByteArray::number(swapPss) + " kB\n");
+}
+
+TEST(ProcessScannerTest, ReadsSmapsRollup)
+{
+    QTemporaryDir root;
+    addProcess(root.path(), 10, "a", 100, 0, 1, 0);
+    addRollup(root.path(), 10, 4000, 3000, 500, 64);
+
+    PssInfo pss;
+    ASSERT_TRUE(ProcessScanner(root.path()).readPss(10, &pss));
+    EXPECT_EQ(4000, pss.pssKiB);
+    EXPECT_EQ(3000, pss.pssAnonKiB);
+    EXPECT_EQ(500, pss.pssShmemKiB);
+    EXPECT_EQ(64, pss.swapPssKiB);
+    EXPECT_FALSE(pss.valid()); // timestamp is the caller's
+    EXPECT_FALSE(ProcessScanner(root.path()).readPss(11, &pss));
+}
+
+TEST(ProcessScannerTest, PssIsReadRoundRobinWithinBudget)
+{
+    QTemporaryDir root;
+    for (int pid = 1; pid <= 5; ++pid) {
+        addProcess(root.path(), pid, "p" + QByteArray::number(pid), 100, 0, 1, 0);
+        addRollup(root.path(), pid, pid * 100, pid * 10, 0, 0);
+    }
+
+    ProcessScanner scanner(root.path(), 1);
+    scanner.update(); // no budget, no PSS
+    for (const ProcessInfo& p : scanner.cached()) EXPECT_FALSE(p.pss.valid());
+
+    // A budget this small stops after the first read of each call
+    const std::chrono::microseconds tiny(1);
+    int read = 0;
+    for (int round = 0; round < 5; ++round) {
+        const ProcessDelta d = scanner.update(tiny);
+        ASSERT_GE(d.changed.size(), 1);
+        read = 0;
+        for (const ProcessInfo& p : scanner.cached()) read += p.pss.valid();
+        if (read == 5) break;
+    }
+    EXPECT_EQ(5, read);
+    EXPECT_EQ(300, scanner.cached()[2].pss.pssKiB);
+    EXPECT_GT(scanner.cached()[0].pss.sampledAtMs, 0);
+
+    // The cursor wraps to pid 1; pid 2 is not reached and keeps its value
+    addRollup(root.path(), 1, 9999, 0, 0, 0);
+    addRollup(root.path(), 2, 9999, 0, 0, 0);
+    scanner.update(tiny);
+    EXPECT_EQ(9999, scanner.cached()[0].pss.pssKiB);
+    EXPECT_EQ(200, scanner.cached()[1].pss.pssKiB);
+}
+
+TEST(ProcessScannerTest, GroupsByAppCgroupThenExe)
+{
+    auto proc = [](int pid, const char* name, const char* exe, const char* cgroup, qint64 rss, qint64 pss) {
+        ProcessInfo p;
+        p.pid = pid;
+        p.name = name;
+        p.exe = exe;
+        p.cgroup = cgroup;
+        p.rssKiB = rss;
+        if (pss > 0) {
+            p.pss.pssKiB = pss;
+            p.pss.sampledAtMs = 1000 + pid;
+        }
+        return p;
+    };
+    const QVector<ProcessInfo> rows = {
+        proc(1, "firefox", "/usr/lib/firefox/firefox", "/user.slice/user-1000.slice/app-firefox.scope", 500, 300),
+        proc(2, "Web Content", "/usr/lib/firefox/firefox", "/user.slice/user-1000.slice/app-firefox.scope", 400, 100),
+        proc(3, "bash", "/usr/bin/bash", "/user.slice/user-1000.slice/session-2.scope", 10, 5),
+        proc(4, "bash", "/usr/bin/bash", "/user.slice/user-1000.slice/session-3.scope", 10, 0),
+        proc(5, "kthreadd", "", "/", 0, 0),
+    };
+
+    const QVector<AppUsage> apps = ProcessScanner::groupByApp(rows);
+    ASSERT_EQ(3, apps.size());
+    EXPECT_EQ(QStringLiteral("app-firefox.scope"), apps[0].label);
+    EXPECT_EQ(2, apps[0].processes);
+    EXPECT_EQ(400, apps[0].pss.pssKiB);
+    EXPECT_EQ(900, apps[0].rssKiB);
+    EXPECT_EQ(1001, apps[0].pss.sampledAtMs); // oldest read
+    EXPECT_EQ(QStringLiteral("bash"), apps[1].label); // session scopes fall back to exe
+    EXPECT_EQ(2, apps[1].processes);
+    EXPECT_EQ(1, apps[1].pssMissing);
+    EXPECT_EQ(QStringLiteral("kthreadd"), apps[2].label);
+}
+
+TEST(ProcessScannerTest, ScansLiveProc)
+{
+    ProcessScanner scanner;
+    ProcessInfo self;
+    ASSERT_TRUE(scanner.readProcess(getpid(), &self));
+    EXPECT_GT(self.rssKiB, 0);
+    EXPECT_FALSE(self.name.isEmpty());
+    EXPECT_FALSE(scanner.scan().isEmpty());
+}
@@ -7,6 +7,11 @@
 #include <QTextEdit>
 #include <QFile>
 #include <QFileInfo>
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableView>
+#include <QDir>
 #define private public
 #include "ProcessTableAction.h"
 #undef private
@@ -25,18 +30,43 @@ TEST(ProcessTableActionTest, StoresConfigPathAndCreatesAction)
     EXPECT_EQ(QString("Show nohang tasks"), qact->text());
 }
 
-TEST(ProcessTableActionTest, RunTasksDisplaysOutput)
+// Put a stand-in 'nohang' executable first on PATH
+static void installFakeNohang(const QTemporaryDir& dir, const QByteArray& body)
 {
-    // prepare dummy 'nohang' executable
-    QTemporaryDir dir;
     QFile script(dir.filePath("nohang"));
     ASSERT_TRUE(script.open(QIODevice::WriteOnly | QIODevice::Text));
-    script.write("#!/bin/sh\necho dummy output\n");
+    script.write("#!/bin/sh\n" + body);
     script.close();
     QFile::setPermissions(script.fileName(), QFile::ExeUser | QFile::ExeGroup | QFile::ExeOther |
                                         QFile::ReadUser | QFile::ReadGroup | QFile::ReadOther);
     QByteArray newPath = dir.path().toUtf8() + ':' + qgetenv("PATH");
     qputenv("PATH", newPath);
+}
+
+static QDialog* findTasksDialog()
+{
+    for (QWidget* w : QApplication::topLevelWidgets())
+        if (auto* dlg = qobject_cast<QDialog*>(w))
+            if (dlg->windowTitle() == "nohang --tasks" && dlg->isVisible()) return dlg;
+    return nullptr;
+}
+
+// Process events until pred() holds or the timeout expires
+template <typename Pred>
+static bool waitFor(Pred pred, int timeoutMs = 5000)
+{
+    QElapsedTimer t;
+    t.start();
+    while (!pred() && t.elapsed() < timeoutMs) {
+        QApplication::processEvents(QEventLoop::AllEvents, 20);
+    }
+    return pred();
+}
+
+TEST(ProcessTableActionTest, RunTasksDisplaysOutput)
+{
+    QTemporaryDir dir;
+    installFakeNohang(dir, "echo dummy output\n");
 
     int argc = 0;
     char** argv = nullptr;
@@ -51,20 +81,114 @@ TEST(ProcessTableActionTest, RunTasksDisplaysOutput)
 
     EXPECT_EQ(before + 1, QApplication::topLevelWidgets().size());
 
-    bool found = false;
-    for (QWidget* w : QApplication::topLevelWidgets()) {
-        if (auto* dlg = qobject_cast<QDialog*>(w)) {
-            if (dlg->windowTitle() == "nohang --tasks") {
-                QTextEdit* edit = dlg->findChild<QTextEdit*>();
-                ASSERT_NE(nullptr, edit);
-                EXPECT_EQ(QStringLiteral("dummy output\n"), edit->toPlainText());
-                dlg->close();
-                found = true;
-            }
-        }
-    }
-    EXPECT_TRUE(found);
+    QDialog* dlg = findTasksDialog();
+    ASSERT_NE(nullptr, dlg);
+    QTextEdit* edit = dlg->findChild<QTextEdit*>();
+    ASSERT_NE(nullptr, edit);
+    auto* status = dlg->findChild<QLabel*>("tasksStatus");
+    ASSERT_NE(nullptr, status);
+    EXPECT_TRUE(waitFor([&] { return status->text().startsWith("finished"); }));
+    EXPECT_EQ(QStringLiteral("dummy output\n"), edit->toPlainText());
+    dlg->close();
 
     QApplication::processEvents();
+    QApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
     EXPECT_EQ(before, QApplication::topLevelWidgets().size());
 }
+
+TEST(ProcessTableActionTest, StreamsSlowOutputIncrementally)
+{
+    QTemporaryDir dir;
+    // Emits one line, then keeps running well past the old 3 s cut-off
+    installFakeNohang(dir, "echo first\nsleep 1\necho second\nsleep 3\necho third\n");
+
+    int argc = 0;
+    char** argv = nullptr;
+    qputenv("QT_QPA_PLATFORM", QByteArray("offscreen"));
+    QApplication app(argc, argv);
+
+    QElapsedTimer opened;
+    opened.start();
+    ProcessTableAction act;
+    act.runTasks();
+    // Opening must not wait for nohang
+    EXPECT_LT(opened.elapsed(), 500);
+
+    QDialog* dlg = findTasksDialog();
+    ASSERT_NE(nullptr, dlg);
+    QTextEdit* edit = dlg->findChild<QTextEdit*>();
+    auto* status = dlg->findChild<QLabel*>("tasksStatus");
+    ASSERT_NE(nullptr, edit);
+    ASSERT_NE(nullptr, status);
+
+    EXPECT_TRUE(waitFor([&] { return edit->toPlainText() == "first\n"; }));
+    EXPECT_TRUE(status->text().startsWith("running"));
+    EXPECT_TRUE(waitFor([&] { return edit->toPlainText() == "first\nsecond\n"; }));
+    EXPECT_TRUE(waitFor([&] { return status->text().startsWith("finished"); }, 8000));
+    EXPECT_EQ(QStringLiteral("first\nsecond\nthird\n"), edit->toPlainText());
+    dlg->close();
+}
+
+TEST(ProcessTableActionTest, CancelStopsRunningTasks)
+{
+    QTemporaryDir dir;
+    installFakeNohang(dir, "echo started\nexec sleep 30\n");
+
+    int argc = 0;
+    char** argv = nullptr;
+    qputenv("QT_QPA_PLATFORM", QByteArray("offscreen"));
+    QApplication app(argc, argv);
+
+    ProcessTableAction act;
+    act.runTasks();
+    QDialog* dlg = findTasksDialog();
+    ASSERT_NE(nullptr, dlg);
+    QTextEdit* edit = dlg->findChild<QTextEdit*>();
+    auto* status = dlg->findChild<QLabel*>("tasksStatus");
+    auto* cancel = dlg->findChild<QPushButton*>("tasksCancel");
+    ASSERT_NE(nullptr, cancel);
+
+    EXPECT_TRUE(waitFor([&] { return edit->toPlainText() == "started\n"; }));
+    cancel->click();
+    EXPECT_TRUE(waitFor([&] { return status->text().startsWith("cancelled"); }));
+    EXPECT_EQ(QStringLiteral("Close"), cancel->text());
+
+    cancel->click();
+    QApplication::processEvents();
+    EXPECT_EQ(nullptr, findTasksDialog());
+}
+
+TEST(ProcessTableActionTest, ShowTableListsProcessesFromProcRoot)
+{
+    QTemporaryDir root;
+    for (int pid : {5, 9}) {
+        const QString dir = root.filePath(QString::number(pid));
+        QDir().mkpath(dir);
+        QFile stat(dir + "/stat");
+        ASSERT_TRUE(stat.open(QIODevice::WriteOnly));
+        stat.write(QByteArray::number(pid) + " (proc" + QByteArray::number(pid) +
+                   ") S 1 0 0 0 -1 0 0 0 0 0 0 0 0 0 20 0 1 0 100 0 0\n");
+    }
+
+    int argc = 0;
+    char** argv = nullptr;
+    qputenv("QT_QPA_PLATFORM", QByteArray("offscreen"));
+    QApplication app(argc, argv);
+
+    ProcessTableAction act;
+    act.setProcRoot(root.path());
+    act.showTable();
+
+    QDialog* dlg = nullptr;
+    for (QWidget* w : QApplication::topLevelWidgets())
+        if (auto* d = qobject_cast<QDialog*>(w); d && d->windowTitle() == "nohang tasks") dlg = d;
+    ASSERT_NE(nullptr, dlg);
+    auto* view = dlg->findChild<QTableView*>("tableView");
+    auto* status = dlg->findChild<QLabel*>("tableStatus");
+    ASSERT_NE(nullptr, view);
+    ASSERT_NE(nullptr, status);
+
+    EXPECT_TRUE(waitFor([&] { return view->model()->rowCount() == 2; }));
+    EXPECT_TRUE(status->text().startsWith("2 processes"));
+    dlg->close();
+}
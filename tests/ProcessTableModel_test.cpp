@@ -0,0 +1,117 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "ProcessTableModel.h"
+#include <QSignalSpy>
+#include <QSortFilterProxyModel>
+
+static ProcessInfo proc(int pid, const char* name, qint64 rssKiB, int oomScore)
+{
+    ProcessInfo p;
+    p.pid = pid;
+    p.name = QString::fromLatin1(name);
+    p.state = 'S';
+    p.rssKiB = rssKiB;
+    p.oomScore = oomScore;
+    return p;
+}
+
+TEST(ProcessTableModelTest, ExposesColumnsAndFormatting)
+{
+    ProcessTableModel model;
+    model.setProcesses({proc(1, "init", 10240, 0), proc(42, "firefox", 1536, 600)});
+
+    EXPECT_EQ(2, model.rowCount());
+    EXPECT_EQ(ProcessTableModel::ColumnCount, model.columnCount());
+    EXPECT_EQ(QStringLiteral("RSS MiB"), model.headerData(ProcessTableModel::RssMiB, Qt::Horizontal).toString());
+
+    EXPECT_EQ(42, model.data(model.index(1, ProcessTableModel::Pid)).toInt());
+    EXPECT_EQ(QStringLiteral("firefox"), model.data(model.index(1, ProcessTableModel::Name)).toString());
+    EXPECT_EQ(QStringLiteral("1.5"), model.data(model.index(1, ProcessTableModel::RssMiB)).toString());
+    EXPECT_EQ(1536, model.data(model.index(1, ProcessTableModel::RssMiB), ProcessTableModel::SortRole).toLongLong());
+    EXPECT_FALSE(model.data(model.index(5, 0)).isValid());
+}
+
+TEST(ProcessTableModelTest, SortsNumericallyAndFilters)
+{
+    ProcessTableModel model;
+    model.setProcesses({proc(1, "init", 900, 0), proc(2, "kworker", 10000, 0), proc(3, "firefox", 100000, 600)});
+
+    QSortFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.setSortRole(ProcessTableModel::SortRole);
+    proxy.setFilterKeyColumn(ProcessTableModel::Name);
+    proxy.setFilterCaseSensitivity(Qt::CaseInsensitive);
+
+    proxy.sort(ProcessTableModel::RssMiB, Qt::DescendingOrder);
+    EXPECT_EQ(3, proxy.data(proxy.index(0, ProcessTableModel::Pid)).toInt());
+    EXPECT_EQ(2, proxy.data(proxy.index(1, ProcessTableModel::Pid)).toInt());
+    EXPECT_EQ(1, proxy.data(proxy.index(2, ProcessTableModel::Pid)).toInt());
+
+    proxy.setFilterFixedString(QStringLiteral("FIRE"));
+    ASSERT_EQ(1, proxy.rowCount());
+    EXPECT_EQ(QStringLiteral("firefox"), proxy.data(proxy.index(0, ProcessTableModel::Name)).toString());
+}
+
+TEST(ProcessTableModelTest, AppliesDeltasWithoutReset)
+{
+    ProcessTableModel model;
+    ProcessDelta initial;
+    initial.added = {proc(1, "init", 100, 0), proc(5, "b", 100, 0), proc(9, "c", 100, 0)};
+    QSignalSpy resets(&model, &QAbstractItemModel::modelReset);
+    QSignalSpy inserts(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removes(&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy changes(&model, &QAbstractItemModel::dataChanged);
+
+    model.applyDelta(initial);
+    ASSERT_EQ(3, model.rowCount());
+    EXPECT_EQ(1, inserts.count()); // one contiguous run
+
+    ProcessDelta d;
+    d.removed = {5, 9};
+    d.added = {proc(3, "new", 100, 0), proc(12, "late", 100, 0)};
+    d.changed = {proc(1, "init", 4096, 0)};
+    model.applyDelta(d);
+
+    ASSERT_EQ(3, model.rowCount());
+    EXPECT_EQ(1, model.data(model.index(0, ProcessTableModel::Pid)).toInt());
+    EXPECT_EQ(3, model.data(model.index(1, ProcessTableModel::Pid)).toInt());
+    EXPECT_EQ(12, model.data(model.index(2, ProcessTableModel::Pid)).toInt());
+    EXPECT_EQ(QStringLiteral("4.0"), model.data(model.index(0, ProcessTableModel::RssMiB)).toString());
+    EXPECT_EQ(0, resets.count());
+    EXPECT_EQ(1, removes.count());
+    EXPECT_EQ(2, inserts.count()); // 3 and 12 both land at the end
+    EXPECT_EQ(1, changes.count());
+}
+
+TEST(ProcessTableModelTest, ShowsPssOnlyOnceRead)
+{
+    ProcessTableModel model;
+    ProcessInfo p = proc(7, "chrome", 4096, 0);
+    model.setProcesses({p});
+    EXPECT_EQ(QString(), model.data(model.index(0, ProcessTableModel::PssMiB)).toString());
+    EXPECT_EQ(-1, model.data(model.index(0, ProcessTableModel::PssMiB), ProcessTableModel::SortRole).toLongLong());
+
+    p.pss.pssKiB = 2048;
+    p.pss.sampledAtMs = ProcessScanner::nowMs();
+    model.setProcesses({p});
+    EXPECT_EQ(QStringLiteral("2.0"), model.data(model.index(0, ProcessTableModel::PssMiB)).toString());
+    EXPECT_TRUE(model.data(model.index(0, ProcessTableModel::PssMiB), Qt::ToolTipRole).toString().contains("s ago"));
+}
+
+TEST(ProcessTableModelTest, AppModelListsGroups)
+{
+    AppUsage a;
+    a.key = "/usr/bin/app";
+    a.label = "app";
+    a.processes = 3;
+    a.rssKiB = 3072;
+    a.pssMissing = 1;
+    AppTableModel model;
+    model.setApps({a});
+    ASSERT_EQ(1, model.rowCount());
+    EXPECT_EQ(AppTableModel::ColumnCount, model.columnCount());
+    EXPECT_EQ(QStringLiteral("app"), model.data(model.index(0, AppTableModel::App)).toString());
+    EXPECT_EQ(QStringLiteral("3.0"), model.data(model.index(0, AppTableModel::RssMiB)).toString());
+    EXPECT_EQ(QString(), model.data(model.index(0, AppTableModel::PssMiB)).toString());
+    EXPECT_TRUE(model.data(model.index(0, AppTableModel::App), Qt::ToolTipRole).toString().contains("1 of 3"));
+}
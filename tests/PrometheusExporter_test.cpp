@@ -0,0 +1,216 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#define private public
+#include "SystemSnapshot.h"
+#undef private
+#include "PrometheusExporter.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <arpa/inet.h>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// A minimal HTTP client: connect, send the request, read until the server
+// closes, spinning the event loop the exporter runs on meanwhile
+QByteArray fetch(int fd, const QByteArray& request)
+{
+    if (fd < 0) return {};
+    ::send(fd, request.constData(), static_cast<size_t>(request.size()), MSG_NOSIGNAL);
+    QByteArray reply;
+    QElapsedTimer t;
+    t.start();
+    char buf[4096];
+    while (t.elapsed() < 2000) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        const ssize_t n = ::recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n == 0) break;
+        if (n > 0) reply.append(buf, n);
+    }
+    ::close(fd);
+    return reply;
+}
+
+int connectTcp(int port)
+{
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<quint16>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    return ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 ? fd : -1;
+}
+
+int connectUnix(const QString& path)
+{
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    const QByteArray p = QFile::encodeName(path);
+    std::memcpy(addr.sun_path, p.constData(), static_cast<size_t>(p.size()));
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    return ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 ? fd : -1;
+}
+
+QByteArray get(int fd, const char* target)
+{
+    return fetch(fd, QByteArray("GET ") + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n");
+}
+
+// SystemSnapshot is a QObject, so fill one in place
+void lowMemory(SystemSnapshot& snap)
+{
+    snap.m_mem.memTotalMiB = 1000.0;
+    snap.m_mem.memAvailableMiB = 250.0;
+    snap.m_mem.memAvailablePercent = 25.0;
+    snap.m_mem.fieldKiB[static_cast<int>(MeminfoField::Cached)] = 2048;
+    snap.m_mem.fields = meminfoBit(MeminfoField::Cached);
+    snap.m_hostMem = snap.m_mem;
+    snap.m_zram.present = true;
+    snap.m_zram.diskSizeMiB = 512;
+    snap.m_psi.full_avg10 = 12.5;
+    snap.m_sampledAtMs = 1000;
+}
+
+ThresholdsPercent memLevels()
+{
+    ThresholdsPercent t;
+    t.warn_mem_percent = 40.0;
+    t.hard_mem_percent = 20.0;
+    t.warn_psi = 10.0;
+    t.psi_duration = 3.0;
+    return t;
+}
+
+} // namespace
+
+TEST(PrometheusExporterTest, RendersGaugesThresholdsAndSeverity)
+{
+    SystemSnapshot snap;
+    lowMemory(snap);
+    const ThresholdSet th = Thresholds::compute(memLevels(), snap);
+    SeverityEngine engine;
+    engine.update(th, snap, 1);
+    PrometheusExporter exporter;
+    exporter.update(snap.data(), th, engine, true);
+
+    const QByteArray page = exporter.page();
+    EXPECT_TRUE(page.contains("# TYPE nohang_tray_severity gauge\nnohang_tray_severity 1\n"));
+    EXPECT_TRUE(page.contains("nohang_tray_daemon_active 1\n"));
+    EXPECT_TRUE(page.contains("nohang_tray_metric_severity{metric=\"mem\"} 1\n"));
+    EXPECT_TRUE(page.contains("# TYPE nohang_tray_severity_transitions_total counter\n"));
+    EXPECT_TRUE(page.contains("nohang_tray_severity_transitions_total{to=\"warn\"} 1\n"));
+    EXPECT_TRUE(page.contains("nohang_tray_memory_available_bytes 262144000\n"));
+    EXPECT_TRUE(page.contains("nohang_tray_memory_available_ratio 0.25\n"));
+    EXPECT_TRUE(page.contains("nohang_tray_meminfo_bytes{field=\"Cached\"} 2097152\n"));
+    EXPECT_FALSE(page.contains("field=\"Dirty\"")); // not read, not exported
+    EXPECT_TRUE(page.contains("nohang_tray_zram_disksize_bytes 536870912\n"));
+    EXPECT_TRUE(page.contains("nohang_tray_pressure_memory_avg10_ratio{kind=\"full\"} 0.125\n"));
+    EXPECT_TRUE(page.contains("nohang_tray_threshold_bytes{resource=\"mem_free\",level=\"warn\"} 419430400\n"));
+    EXPECT_TRUE(page.contains("nohang_tray_threshold_bytes{resource=\"mem_free\",level=\"hard\"} 209715200\n"));
+    EXPECT_FALSE(page.contains("level=\"soft\"")); // not configured
+    EXPECT_TRUE(page.contains("nohang_tray_threshold_psi_ratio{level=\"warn\"} 0.1\n"));
+    EXPECT_TRUE(page.contains("nohang_tray_threshold_psi_duration_seconds 3\n"));
+}
+
+TEST(PrometheusExporterTest, RendersOnlyForNewSamples)
+{
+    SystemSnapshot snap;
+    lowMemory(snap);
+    const ThresholdSet th = Thresholds::compute(memLevels(), snap);
+    SeverityEngine engine;
+    PrometheusExporter exporter;
+    exporter.update(snap.data(), th, engine, true);
+    exporter.update(snap.data(), th, engine, true);
+    EXPECT_EQ(1u, exporter.renders());
+    const char* buffer = exporter.page().constData();
+
+    exporter.update(snap.data(), th, engine, false); // the daemon went away
+    EXPECT_EQ(2u, exporter.renders());
+    snap.m_sampledAtMs = 1100;
+    exporter.update(snap.data(), th, engine, false);
+    EXPECT_EQ(3u, exporter.renders());
+    EXPECT_EQ(buffer, exporter.page().constData()); // same allocation reused
+}
+
+TEST(PrometheusExporterTest, ServesMetricsOverTcp)
+{
+    int argc = 0;
+    QCoreApplication app(argc, nullptr);
+    PrometheusExporter exporter;
+    QString err;
+    ASSERT_TRUE(exporter.listen(QStringLiteral("127.0.0.1:0"), &err)) << qPrintable(err);
+    ASSERT_GT(exporter.port(), 0);
+    SystemSnapshot snap;
+    lowMemory(snap);
+    SeverityEngine engine;
+    exporter.update(snap.data(), Thresholds::compute(memLevels(), snap), engine, true);
+
+    const QByteArray reply = get(connectTcp(exporter.port()), "/metrics");
+    ASSERT_TRUE(reply.startsWith("HTTP/1.1 200 OK\r\n")) << reply.constData();
+    EXPECT_TRUE(reply.contains("Content-Type: text/plain; version=0.0.4"));
+    EXPECT_TRUE(reply.contains("Content-Length: " + QByteArray::number(exporter.page().size()) + "\r\n"));
+    EXPECT_TRUE(reply.endsWith(exporter.page()));
+    EXPECT_EQ(1u, exporter.scrapes());
+
+    EXPECT_TRUE(get(connectTcp(exporter.port()), "/nope").startsWith("HTTP/1.1 404"));
+    EXPECT_TRUE(fetch(connectTcp(exporter.port()), "POST /metrics HTTP/1.1\r\n\r\n").startsWith("HTTP/1.1 405"));
+    const QByteArray head = fetch(connectTcp(exporter.port()), "HEAD /metrics HTTP/1.1\r\n\r\n");
+    EXPECT_TRUE(head.startsWith("HTTP/1.1 200 OK\r\n"));
+    EXPECT_TRUE(head.endsWith("\r\n\r\n")); // headers only
+    EXPECT_EQ(0, exporter.clientCount());
+}
+
+TEST(PrometheusExporterTest, ServesMetricsOverUnixSocket)
+{
+    int argc = 0;
+    QCoreApplication app(argc, nullptr);
+    QTemporaryDir dir;
+    PrometheusExporter exporter;
+    ASSERT_TRUE(exporter.listen(dir.filePath("metrics.sock")));
+    EXPECT_EQ(0, exporter.port());
+    SystemSnapshot snap;
+    lowMemory(snap);
+    SeverityEngine engine;
+    exporter.update(snap.data(), Thresholds::compute(memLevels(), snap), engine, true);
+
+    const QByteArray reply = get(connectUnix(dir.filePath("metrics.sock")), "/metrics?x=1");
+    EXPECT_TRUE(reply.startsWith("HTTP/1.1 200 OK\r\n"));
+    EXPECT_TRUE(reply.contains("nohang_tray_severity 0\n"));
+
+    PrometheusExporter second;
+    EXPECT_FALSE(second.listen(dir.filePath("metrics.sock"))); // still served
+}
+
+TEST(PrometheusExporterTest, KeepsNonSocketFileAtUnixPath)
+{
+    int argc = 0;
+    QCoreApplication app(argc, nullptr);
+    QTemporaryDir dir;
+    QFile file(dir.filePath("metrics"));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("keep me");
+    file.close();
+
+    PrometheusExporter exporter;
+    QString err;
+    EXPECT_FALSE(exporter.listen(file.fileName(), &err));
+    EXPECT_FALSE(err.isEmpty());
+    EXPECT_TRUE(file.exists());
+    EXPECT_FALSE(exporter.isListening());
+}
+
+TEST(PrometheusExporterTest, RejectsBadAddresses)
+{
+    PrometheusExporter exporter;
+    QString err;
+    EXPECT_FALSE(exporter.listen(QStringLiteral("localhost:http"), &err));
+    EXPECT_FALSE(err.isEmpty());
+    EXPECT_FALSE(exporter.listen(QStringLiteral("example.org:9100")));
+    EXPECT_FALSE(exporter.isListening());
+}
@@ -0,0 +1,71 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "SampleHistory.h"
+#include "SystemSnapshot.h"
+
+static SampleHistory::Values values(float memAvailable)
+{
+    return {memAvailable, 100.0f, 0.0f, 1.0f, 0.5f};
+}
+
+TEST(SampleHistoryTest, AppendsOncePerInterval)
+{
+    SampleHistory h(10, 1000);
+    EXPECT_TRUE(h.append(0, values(1), Severity::Normal));
+    EXPECT_FALSE(h.append(500, values(2), Severity::Normal)); // too soon
+    EXPECT_TRUE(h.append(950, values(3), Severity::Warn));    // timer jitter is fine
+    ASSERT_EQ(2, h.size());
+    EXPECT_EQ(950, h.timeMs(1));
+    EXPECT_FLOAT_EQ(3, h.value(SampleHistory::MemAvailableMiB, 1));
+    EXPECT_EQ(Severity::Warn, h.severity(1));
+    EXPECT_EQ(2u, h.appended());
+}
+
+TEST(SampleHistoryTest, WrapsKeepingTheNewest)
+{
+    SampleHistory h(3, 1000);
+    for (int i = 0; i < 5; ++i) h.append(i * 1000, values(float(i)), Severity::Normal);
+    ASSERT_EQ(3, h.size());
+    EXPECT_EQ(2000, h.timeMs(0));
+    EXPECT_EQ(4000, h.timeMs(2));
+    EXPECT_FLOAT_EQ(4, h.value(SampleHistory::MemAvailableMiB, 2));
+    EXPECT_EQ(1, h.lowerBound(2500));
+    EXPECT_EQ(3, h.lowerBound(9000));
+    EXPECT_EQ(5u, h.appended());
+
+    h.clear();
+    EXPECT_EQ(0, h.size());
+    h.append(0, values(7), Severity::Normal);
+    EXPECT_FLOAT_EQ(7, h.value(SampleHistory::MemAvailableMiB, 0));
+}
+
+TEST(SampleHistoryTest, BucketsAverageValuesAndKeepWorstSeverity)
+{
+    SampleHistory h(100, 1000);
+    for (int i = 0; i < 10; ++i)
+        h.append(i * 1000, values(float(i)), i == 4 ? Severity::Hard : Severity::Normal);
+
+    const SampleHistory::Buckets b = h.bucketed(2000, 3000);
+    ASSERT_EQ(3, b.timeMs.size()); // 2-4, 5-7, 8-9
+    EXPECT_EQ(2000, b.timeMs[0]);
+    EXPECT_EQ(8000, b.timeMs[2]);
+    EXPECT_DOUBLE_EQ(3.0, b.values[SampleHistory::MemAvailableMiB][0]);
+    EXPECT_DOUBLE_EQ(8.5, b.values[SampleHistory::MemAvailableMiB][2]);
+    EXPECT_DOUBLE_EQ(100.0, b.values[SampleHistory::SwapFreeMiB][1]);
+    EXPECT_EQ(char(Severity::Hard), b.severity[0]);
+    EXPECT_EQ(char(Severity::Normal), b.severity[1]);
+}
+
+TEST(SampleHistoryTest, TakesValuesFromSnapshotData)
+{
+    SnapshotData d {};
+    d.mem.memAvailableMiB = 512;
+    d.zram.origDataMiB = 64;
+    d.psi.full_avg10 = 2.5;
+    d.sampledAtMs = 1000;
+    SampleHistory h;
+    ASSERT_TRUE(h.append(d, Severity::Soft));
+    EXPECT_FLOAT_EQ(512, h.value(SampleHistory::MemAvailableMiB, 0));
+    EXPECT_FLOAT_EQ(64, h.value(SampleHistory::ZramUsedMiB, 0));
+    EXPECT_FLOAT_EQ(2.5, h.value(SampleHistory::PsiFullAvg10, 0));
+}
@@ -0,0 +1,64 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "ScenarioGenerator.h"
+#include "SystemSnapshot.h"
+#include <QFileInfo>
+
+using Scenario = ScenarioGenerator::Scenario;
+
+TEST(ScenarioGeneratorTest, SnapshotReadsEveryStep)
+{
+    ScenarioGenerator gen;
+    ASSERT_TRUE(gen.isValid());
+    SystemSnapshot snap(gen.procRoot(), gen.sysRoot());
+    for (const Scenario s : ScenarioGenerator::kScenarios) {
+        for (int step = 0; step < ScenarioGenerator::steps(s); step += 7) {
+            const ScenarioGenerator::State st = ScenarioGenerator::stateAt(s, step);
+            gen.write(st);
+            snap.refresh();
+            SCOPED_TRACE(std::string(ScenarioGenerator::name(s)) + " step " + std::to_string(step));
+            EXPECT_NEAR(ScenarioGenerator::kMemTotalMiB, snap.mem().memTotalMiB, 0.01);
+            EXPECT_NEAR(st.memAvailableMiB, snap.mem().memAvailableMiB, 0.01);
+            EXPECT_NEAR(st.swapFreeMiB, snap.mem().swapFreeMiB, 0.01);
+            EXPECT_NEAR(st.psiSomeAvg10, snap.psi().some_avg10, 0.01);
+            EXPECT_NEAR(st.psiFullAvg10, snap.psi().full_avg10, 0.01);
+            ASSERT_TRUE(snap.zram().present);
+            EXPECT_NEAR(ScenarioGenerator::kZramDiskMiB, snap.zram().diskSizeMiB, 0.01);
+            EXPECT_NEAR(st.zramOrigMiB, snap.zram().origDataMiB, 0.01);
+        }
+    }
+}
+
+TEST(ScenarioGeneratorTest, RewritesInPlaceAtFixedSize)
+{
+    ScenarioGenerator gen;
+    ASSERT_TRUE(gen.isValid());
+    const QString meminfo = gen.procRoot() + QStringLiteral("/meminfo");
+    const QString pressure = gen.procRoot() + QStringLiteral("/pressure/memory");
+    const qint64 memSize = QFileInfo(meminfo).size();
+    const qint64 psiSize = QFileInfo(pressure).size();
+    ASSERT_GT(memSize, 0);
+    gen.write(Scenario::LinearLeak, ScenarioGenerator::steps(Scenario::LinearLeak) - 1);
+    gen.write(Scenario::PsiSpike, 10);
+    EXPECT_EQ(memSize, QFileInfo(meminfo).size());
+    EXPECT_EQ(psiSize, QFileInfo(pressure).size());
+}
+
+TEST(ScenarioGeneratorTest, ScenariosDevelopAsDescribed)
+{
+    const int leakEnd = ScenarioGenerator::steps(Scenario::LinearLeak) - 1;
+    EXPECT_GT(ScenarioGenerator::stateAt(Scenario::LinearLeak, 1).memAvailableMiB,
+              ScenarioGenerator::stateAt(Scenario::LinearLeak, 100).memAvailableMiB);
+    EXPECT_DOUBLE_EQ(0, ScenarioGenerator::stateAt(Scenario::LinearLeak, leakEnd).memAvailableMiB);
+
+    // Sudden ones hold the baseline, then jump in one step
+    const auto before = ScenarioGenerator::stateAt(Scenario::ForkBomb, 9);
+    const auto after = ScenarioGenerator::stateAt(Scenario::ForkBomb, 10);
+    EXPECT_DOUBLE_EQ(ScenarioGenerator::stateAt(Scenario::ForkBomb, 0).memAvailableMiB, before.memAvailableMiB);
+    EXPECT_LT(after.memAvailableMiB, before.memAvailableMiB / 10);
+    EXPECT_GT(ScenarioGenerator::stateAt(Scenario::PsiSpike, 10).psiSomeAvg10, 50);
+
+    const auto full = ScenarioGenerator::stateAt(Scenario::ZramFill, ScenarioGenerator::steps(Scenario::ZramFill) - 1);
+    EXPECT_DOUBLE_EQ(ScenarioGenerator::kZramDiskMiB, full.zramOrigMiB);
+    EXPECT_DOUBLE_EQ(0, full.swapFreeMiB);
+}
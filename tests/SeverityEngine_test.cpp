@@ -0,0 +1,256 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#define private public
+#include "SystemSnapshot.h"
+#undef private
+#include "SeverityEngine.h"
+#include <vector>
+
+namespace {
+
+struct Point {
+    double t;        // seconds on the sample timeline
+    double memAvail; // MiB, of 1000 MiB total
+    double psi;      // full avg10
+};
+
+struct Expected {
+    double t;
+    Severity to;
+    SeverityMetric cause;
+};
+
+struct Case {
+    const char* name;
+    ThresholdsPercent cfg;
+    std::vector<Point> series;
+    std::vector<Expected> transitions;
+};
+
+ThresholdsPercent memLevels()
+{
+    ThresholdsPercent t;
+    t.warn_mem_percent = 40.0; // 400 MiB, band 5 % of 200 = 10 MiB
+    t.soft_mem_percent = 30.0; // 300 MiB
+    t.hard_mem_percent = 20.0; // 200 MiB
+    return t;
+}
+
+ThresholdsPercent psiLevels(double duration)
+{
+    ThresholdsPercent t;
+    t.warn_psi = 10.0;
+    t.hard_psi = 40.0;
+    t.psi_duration = duration;
+    return t;
+}
+
+std::vector<Case> cases()
+{
+    return {
+        {"NoThresholdsNeverTransitions", {},
+         {{0, 100, 90}, {1, 10, 90}},
+         {}},
+        {"HoveringAroundThresholdDoesNotFlap", memLevels(),
+         {{0, 500, 0}, {1, 399, 0}, {2, 401, 0}, {3, 399, 0}, {4, 405, 0}, {5, 409, 0}, {6, 411, 0}},
+         {{1, Severity::Warn, SeverityMetric::Mem}, {6, Severity::Normal, SeverityMetric::Mem}}},
+        {"EscalatesThroughLevelsAndRecovers", memLevels(),
+         {{0, 500, 0}, {1, 350, 0}, {2, 250, 0}, {3, 150, 0}, {4, 205, 0}, {5, 215, 0}, {6, 600, 0}},
+         {{1, Severity::Warn, SeverityMetric::Mem},
+          {2, Severity::Soft, SeverityMetric::Mem},
+          {3, Severity::Hard, SeverityMetric::Mem},
+          {5, Severity::Soft, SeverityMetric::Mem},
+          {6, Severity::Normal, SeverityMetric::Mem}}},
+        {"SinglePsiSpikeIsIgnoredWithDuration", psiLevels(3),
+         {{0, 900, 0}, {1, 900, 50}, {2, 900, 0}, {3, 900, 0}},
+         {}},
+        {"SustainedPsiEscalatesAfterDuration", psiLevels(3),
+         {{0, 900, 0}, {1, 900, 15}, {2, 900, 15}, {3, 900, 15}, {4, 900, 15}, {5, 900, 5}},
+         {{4, Severity::Warn, SeverityMetric::Psi}, {5, Severity::Normal, SeverityMetric::Psi}}},
+        {"PsiWithoutDurationIsImmediate", psiLevels(0),
+         {{0, 900, 0}, {1, 900, 50}, {2, 900, 39}, {3, 900, 37}},
+         {{1, Severity::Hard, SeverityMetric::Psi}, {3, Severity::Warn, SeverityMetric::Psi}}},
+        {"PsiDurationRestartsAfterDip", psiLevels(2),
+         {{0, 900, 15}, {1, 900, 15}, {1.5, 900, 5}, {2, 900, 15}, {3, 900, 15}, {4, 900, 15}},
+         {{4, Severity::Warn, SeverityMetric::Psi}}},
+    };
+}
+
+class SeverityEngineTest : public ::testing::TestWithParam<Case> {};
+
+} // namespace
+
+TEST_P(SeverityEngineTest, EmitsExpectedTransitions)
+{
+    const Case& c = GetParam();
+    SystemSnapshot snap;
+    snap.m_mem.memTotalMiB = 1000.0;
+    SeverityEngine engine;
+
+    std::vector<SeverityTransition> seen;
+    for (const Point& p : c.series) {
+        snap.m_mem.memAvailableMiB = p.memAvail;
+        snap.m_psi.full_avg10 = p.psi;
+        const ThresholdSet th = Thresholds::compute(c.cfg, snap);
+        if (auto t = engine.update(th, snap, p.t)) seen.push_back(*t);
+    }
+
+    ASSERT_EQ(c.transitions.size(), seen.size());
+    Severity prev = Severity::Normal;
+    for (size_t i = 0; i < seen.size(); ++i) {
+        SCOPED_TRACE(i);
+        EXPECT_DOUBLE_EQ(c.transitions[i].t, seen[i].atSeconds);
+        EXPECT_EQ(prev, seen[i].from);
+        EXPECT_EQ(c.transitions[i].to, seen[i].to);
+        if (seen[i].to != Severity::Normal) EXPECT_EQ(c.transitions[i].cause, seen[i].cause);
+        prev = seen[i].to;
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Series, SeverityEngineTest, ::testing::ValuesIn(cases()),
+                         [](const ::testing::TestParamInfo<Case>& info) { return std::string(info.param.name); });
+
+TEST(SeverityEngineMiscTest, IconNamesMatchTrayLevels)
+{
+    EXPECT_EQ(QStringLiteral("security-low"), SeverityEngine::iconName(Severity::Normal));
+    EXPECT_EQ(QStringLiteral("security-medium"), SeverityEngine::iconName(Severity::Warn));
+    EXPECT_EQ(QStringLiteral("security-medium"), SeverityEngine::iconName(Severity::Soft));
+    EXPECT_EQ(QStringLiteral("security-high"), SeverityEngine::iconName(Severity::Hard));
+}
+
+TEST(SeverityEngineMiscTest, ResetReturnsToNormal)
+{
+    SystemSnapshot snap;
+    snap.m_mem.memTotalMiB = 1000.0;
+    snap.m_mem.memAvailableMiB = 100.0;
+    SeverityEngine engine;
+    ASSERT_TRUE(engine.update(Thresholds::compute(memLevels(), snap), snap, 0).has_value());
+    EXPECT_EQ(Severity::Hard, engine.level());
+    EXPECT_EQ(Severity::Hard, engine.level(SeverityMetric::Mem));
+
+    engine.reset();
+    EXPECT_EQ(Severity::Normal, engine.level());
+    EXPECT_EQ(1u, engine.transitions(Severity::Hard)); // counters survive a reset
+    EXPECT_EQ(0u, engine.transitions(Severity::Normal));
+}
+
+TEST(SeverityEngineMiscTest, SomePsiMetricSelectsSomeAvg10)
+{
+    SystemSnapshot snap;
+    snap.m_psi.some_avg10 = 7.0;
+    snap.m_psi.full_avg10 = 3.0;
+    ThresholdSet th;
+    th.psi_metrics = QStringLiteral("some_avg10");
+    EXPECT_DOUBLE_EQ(7.0, SeverityEngine::psiValue(th, snap));
+    th.psi_metrics = QStringLiteral("full_avg10");
+    EXPECT_DOUBLE_EQ(3.0, SeverityEngine::psiValue(th, snap));
+}
+
+TEST(SeverityEngineMiscTest, EscalationHoldsThenExpires)
+{
+    SystemSnapshot snap;
+    snap.m_mem.memTotalMiB = 1000.0;
+    snap.m_mem.memAvailableMiB = 900.0;
+    const ThresholdSet th = Thresholds::compute(memLevels(), snap);
+    SeverityEngine engine;
+    EXPECT_FALSE(engine.update(th, snap, 0).has_value());
+
+    auto t = engine.escalate(Severity::Hard, 1, 30);
+    ASSERT_TRUE(t.has_value());
+    EXPECT_EQ(Severity::Hard, t->to);
+    EXPECT_EQ(SeverityMetric::Events, t->cause);
+
+    // A weaker event later does not lower or shorten it
+    EXPECT_FALSE(engine.escalate(Severity::Warn, 2, 5).has_value());
+    EXPECT_FALSE(engine.update(th, snap, 20).has_value());
+    EXPECT_EQ(Severity::Hard, engine.level(SeverityMetric::Events));
+
+    t = engine.update(th, snap, 31);
+    ASSERT_TRUE(t.has_value());
+    EXPECT_EQ(Severity::Normal, t->to);
+    EXPECT_EQ(1u, engine.transitions(Severity::Hard));
+    EXPECT_EQ(1u, engine.transitions(Severity::Normal));
+    EXPECT_EQ(0u, engine.transitions(Severity::Warn));
+}
+
+TEST(SeverityEngineMiscTest, SustainedSwapInRaisesLevel)
+{
+    SystemSnapshot snap;
+    snap.m_mem.memTotalMiB = 1000.0;
+    snap.m_mem.memAvailableMiB = 900.0;
+    snap.m_vmstat.present = true;
+    const ThresholdSet th = Thresholds::compute(memLevels(), snap);
+    SeverityEngine engine; // warn at 20 MiB/s, held 5 s
+
+    snap.m_vmstat.swapInMiBPerSec = 30;
+    std::optional<SeverityTransition> t;
+    for (int s = 0; s <= 5 && !t; ++s) t = engine.update(th, snap, s);
+    ASSERT_TRUE(t.has_value());
+    EXPECT_DOUBLE_EQ(5.0, t->atSeconds);
+    EXPECT_EQ(Severity::Warn, t->to);
+    EXPECT_EQ(SeverityMetric::SwapIn, t->cause);
+
+    // Inside the band it holds, below it recovers
+    snap.m_vmstat.swapInMiBPerSec = 16;
+    EXPECT_FALSE(engine.update(th, snap, 6).has_value());
+    snap.m_vmstat.swapInMiBPerSec = 10;
+    t = engine.update(th, snap, 7);
+    ASSERT_TRUE(t.has_value());
+    EXPECT_EQ(Severity::Normal, t->to);
+}
+
+TEST(SeverityEngineMiscTest, FullZswapPoolWarns)
+{
+    SystemSnapshot snap;
+    snap.m_mem.memTotalMiB = 1000.0;
+    snap.m_mem.memAvailableMiB = 900.0;
+    snap.m_zswap.present = true;
+    snap.m_zswap.poolUsedPercent = 95;
+    const ThresholdSet th = Thresholds::compute(memLevels(), snap);
+
+    SeverityEngine engine;
+    EXPECT_FALSE(engine.update(th, snap, 0).has_value()); // disabled zswap is not judged
+
+    snap.m_zswap.enabled = true;
+    auto t = engine.update(th, snap, 1);
+    ASSERT_TRUE(t.has_value());
+    EXPECT_EQ(Severity::Warn, t->to);
+    EXPECT_EQ(SeverityMetric::Zswap, t->cause);
+}
+
+TEST(SeverityEngineMiscTest, ConstrainedNumaNodeRaisesLevel)
+{
+    SystemSnapshot snap;
+    snap.m_mem.memTotalMiB = 1000.0;
+    snap.m_mem.memAvailableMiB = 600.0; // fine globally
+    snap.m_numa.present = true;
+    snap.m_numa.nodeCount = snap.m_numa.shown = 2;
+    snap.m_numa.nodes[0].id = 1;
+    snap.m_numa.nodes[0].availablePercent = 25.0; // below soft (30 %)
+    snap.m_numa.nodes[1].availablePercent = 95.0;
+    const ThresholdSet th = Thresholds::compute(memLevels(), snap);
+
+    SeverityEngine engine;
+    auto t = engine.update(th, snap, 0);
+    ASSERT_TRUE(t.has_value());
+    EXPECT_EQ(Severity::Soft, t->to);
+    EXPECT_EQ(SeverityMetric::Node, t->cause);
+    EXPECT_EQ(Severity::Normal, engine.level(SeverityMetric::Mem));
+}
+
+TEST(SeverityEngineMiscTest, DiskSwapSpillWarns)
+{
+    SystemSnapshot snap;
+    snap.m_mem.memTotalMiB = 1000.0;
+    snap.m_mem.memAvailableMiB = 900.0;
+    const ThresholdSet th = Thresholds::compute(memLevels(), snap);
+    SeverityEngine engine; // warn above 64 MiB
+
+    snap.m_swaps.spilledMiB = 10;
+    EXPECT_FALSE(engine.update(th, snap, 0).has_value());
+    snap.m_swaps.spilledMiB = 200;
+    auto t = engine.update(th, snap, 1);
+    ASSERT_TRUE(t.has_value());
+    EXPECT_EQ(Severity::Warn, t->to);
+    EXPECT_EQ(SeverityMetric::SwapSpill, t->cause);
+}
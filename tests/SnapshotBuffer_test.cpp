@@ -0,0 +1,68 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "SnapshotBuffer.h"
+#include "SystemSnapshot.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(SnapshotBufferTest, LoadReturnsLastStore)
+{
+    SnapshotBuffer<SnapshotData> buf;
+    EXPECT_EQ(0u, buf.version());
+    EXPECT_DOUBLE_EQ(0.0, buf.load().mem.memTotalMiB);
+
+    SnapshotData d;
+    d.mem.memTotalMiB = 2048.0;
+    d.zram.present = true;
+    d.psi.full_avg10 = 1.5;
+    buf.store(d);
+
+    const SnapshotData out = buf.load();
+    EXPECT_EQ(1u, buf.version());
+    EXPECT_DOUBLE_EQ(2048.0, out.mem.memTotalMiB);
+    EXPECT_TRUE(out.zram.present);
+    EXPECT_DOUBLE_EQ(1.5, out.psi.full_avg10);
+}
+
+// Every field of a stored sample carries the same value, so a reader that
+// ever sees two different values has observed a torn snapshot.
+TEST(SnapshotBufferTest, ConcurrentReadersNeverSeeTornSnapshots)
+{
+    SnapshotBuffer<SnapshotData> buf;
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::atomic<quint64> reads{0};
+    constexpr int kStores = 200000;
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&] {
+            double last = 0;
+            while (!done.load(std::memory_order_acquire)) {
+                const SnapshotData d = buf.load();
+                const double v = d.mem.memTotalMiB;
+                if (d.mem.memAvailableMiB != v || d.mem.swapFreeMiB != v ||
+                    d.zram.origDataMiB != v || d.psi.some_avg10 != v || d.psi.full_avg10 != v)
+                    torn.fetch_add(1);
+                if (v < last) torn.fetch_add(1); // versions only move forward
+                last = v;
+                reads.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for (int i = 1; i <= kStores; ++i) {
+        SnapshotData d;
+        d.mem.memTotalMiB = d.mem.memAvailableMiB = d.mem.swapFreeMiB = i;
+        d.zram.origDataMiB = d.psi.some_avg10 = d.psi.full_avg10 = i;
+        buf.store(d);
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& t : readers) t.join();
+
+    EXPECT_EQ(0, torn.load());
+    EXPECT_GT(reads.load(), 0u);
+    EXPECT_EQ(static_cast<quint64>(kStores), buf.version());
+    EXPECT_DOUBLE_EQ(kStores, buf.load().mem.memTotalMiB);
+}
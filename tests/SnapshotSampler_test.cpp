@@ -0,0 +1,148 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "SnapshotSampler.h"
+#include <QDir>
+#include <QFile>
+#include <QScopeGuard>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <csignal>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+static void writeMeminfo(const QString& procRoot)
+{
+    QFile meminfo(procRoot + "/meminfo");
+    ASSERT_TRUE(meminfo.open(QIODevice::WriteOnly | QIODevice::Text));
+    QTextStream ts(&meminfo);
+    ts << "MemTotal:       2048 kB\n";
+    ts << "MemAvailable:   1024 kB\n";
+}
+
+// Poll the sampler and return the longest gap between two new samples
+static std::chrono::milliseconds longestGap(const SnapshotSampler& s, std::chrono::milliseconds span)
+{
+    const auto end = std::chrono::steady_clock::now() + span;
+    auto lastChange = std::chrono::steady_clock::now();
+    quint64 lastCount = s.sampleCount();
+    std::chrono::milliseconds worst{0};
+    while (std::chrono::steady_clock::now() < end) {
+        std::this_thread::sleep_for(2ms);
+        const auto now = std::chrono::steady_clock::now();
+        const quint64 c = s.sampleCount();
+        if (c != lastCount) {
+            lastCount = c;
+            lastChange = now;
+        }
+        worst = std::max(worst, std::chrono::duration_cast<std::chrono::milliseconds>(now - lastChange));
+    }
+    return worst;
+}
+
+// Create a memory-limited child of our own cgroup v2 node, or return empty
+static QString makeLimitedCgroup()
+{
+    QFile self("/proc/self/cgroup");
+    if (!self.open(QIODevice::ReadOnly | QIODevice::Text)) return {};
+    QString rel;
+    for (const QString& line : QString::fromUtf8(self.readAll()).split('\n'))
+        if (line.startsWith("0::")) rel = line.mid(3);
+    if (rel.isEmpty()) return {};
+    for (const QString mount : {QStringLiteral("/sys/fs/cgroup"), QStringLiteral("/sys/fs/cgroup/unified")}) {
+        const QString dir = mount + rel + "/nohang-tray-test-hog";
+        if (!QDir().mkpath(dir)) continue;
+        QFile max(dir + "/memory.max");
+        if (max.open(QIODevice::WriteOnly) && max.write("64M") > 0) return dir;
+        QDir().rmdir(dir);
+    }
+    return {};
+}
+
+TEST(SnapshotSamplerTest, ProducesSamplesOnSchedule)
+{
+    QTemporaryDir procDir;
+    QTemporaryDir sysDir;
+    writeMeminfo(procDir.path());
+
+    SnapshotSampler sampler(std::make_unique<SystemSnapshot>(procDir.path(), sysDir.path()), 20ms);
+    sampler.start();
+    std::this_thread::sleep_for(300ms);
+    sampler.stop();
+
+    EXPECT_GE(sampler.sampleCount(), 8u);
+    EXPECT_DOUBLE_EQ(2.0, sampler.latest().mem.memTotalMiB);
+    EXPECT_DOUBLE_EQ(1.0, sampler.latest().mem.memAvailableMiB);
+}
+
+TEST(SnapshotSamplerTest, StopIsIdempotent)
+{
+    QTemporaryDir procDir;
+    QTemporaryDir sysDir;
+    writeMeminfo(procDir.path());
+
+    SnapshotSampler sampler(std::make_unique<SystemSnapshot>(procDir.path(), sysDir.path()), 10ms);
+    sampler.stop();
+    sampler.start();
+    sampler.stop();
+    sampler.stop();
+    EXPECT_GE(sampler.sampleCount(), 1u);
+}
+
+TEST(SnapshotSamplerTest, KeepsScheduleWhileHogRunsInCgroup)
+{
+    const QString cg = makeLimitedCgroup();
+    if (cg.isEmpty()) GTEST_SKIP() << "no writable cgroup v2 memory controller";
+
+    // Stand-in hog: keeps touching four times its cgroup limit so it stays
+    // in reclaim (or gets OOM-killed) while we sample. It waits on a pipe
+    // until it has been moved, so it never allocates in our cgroup.
+    int go[2];
+    ASSERT_EQ(0, pipe(go));
+    const pid_t hog = fork();
+    if (hog < 0) {
+        close(go[0]);
+        close(go[1]);
+        FAIL() << "fork: " << std::strerror(errno);
+    }
+    if (hog == 0) {
+        close(go[1]);
+        char c;
+        if (read(go[0], &c, 1) != 1) _exit(0); // parent gave up
+        const size_t chunk = 256u * 1024u * 1024u;
+        char* p = static_cast<char*>(std::malloc(chunk));
+        for (;;) {
+            if (p) std::memset(p, 1, chunk);
+        }
+    }
+    close(go[0]);
+    // Every way out of the test, failed assertions included, ends the hog
+    const auto cleanup = qScopeGuard([&] {
+        close(go[1]);
+        kill(hog, SIGKILL);
+        waitpid(hog, nullptr, 0);
+        QDir().rmdir(cg);
+    });
+    {
+        QFile procs(cg + "/cgroup.procs");
+        ASSERT_TRUE(procs.open(QIODevice::WriteOnly | QIODevice::Unbuffered));
+        const QByteArray pid = QByteArray::number(hog);
+        ASSERT_EQ(pid.size(), procs.write(pid)) << procs.errorString().toStdString();
+    }
+    ASSERT_EQ(1, write(go[1], "x", 1));
+
+    QTemporaryDir procDir;
+    QTemporaryDir sysDir;
+    writeMeminfo(procDir.path());
+    SnapshotSampler sampler(std::make_unique<SystemSnapshot>(procDir.path(), sysDir.path()), 50ms);
+    sampler.start(true);
+    const auto gap = longestGap(sampler, 1500ms);
+    sampler.stop();
+
+    EXPECT_GE(sampler.sampleCount(), 20u);
+    EXPECT_LT(gap.count(), 250);
+}
@@ -1,6 +1,9 @@
 #include "pch.h"
 #include <gtest/gtest.h>
+#define private public
 #include "SystemSnapshot.h"
+#undef private
+#include <unistd.h>
 #include <QTemporaryDir>
 #include <QTest>
 
@@ -133,4 +136,352 @@ TEST(SystemSnapshotTest, ParsesMultipleSwapEntries)
     EXPECT_DOUBLE_EQ(1.5, snap.mem().swapTotalMiB);
     EXPECT_DOUBLE_EQ(0.875, snap.mem().swapFreeMiB);
     EXPECT_NEAR(58.3333, snap.mem().swapFreePercent, 0.001);
+
+    const SwapInfo& sw = snap.swaps();
+    ASSERT_EQ(2, sw.deviceCount);
+    EXPECT_STREQ("/dev/zram0", sw.devices[0].path);
+    EXPECT_TRUE(sw.devices[0].zram);
+    EXPECT_EQ(100, sw.devices[0].priority);
+    EXPECT_STREQ("/swapfile", sw.devices[1].path);
+    EXPECT_TRUE(sw.devices[1].file);
+    EXPECT_EQ(-2, sw.devices[1].priority);
+    EXPECT_DOUBLE_EQ(0.5, sw.devices[1].usedMiB);
+    EXPECT_DOUBLE_EQ(0.5, sw.spilledMiB); // the swapfile is behind zram
+}
+
+TEST(SystemSnapshotTest, ReparsesSwapsOnlyWhenChanged)
+{
+    QTemporaryDir procDir;
+    QTemporaryDir sysDir;
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("cannot open .*meminfo"));
+    auto writeSwaps = [&](const QByteArray& body) {
+        QFile f(procDir.filePath("swaps"));
+        ASSERT_TRUE(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        f.write("Filename Type Size Used Priority\n" + body);
+    };
+    writeSwaps("/dev/sda2 partition 4096 0 -2\n");
+
+    SystemSnapshot snap(procDir.path(), sysDir.path());
+    snap.refresh();
+    ASSERT_EQ(1, snap.swaps().deviceCount);
+    EXPECT_FALSE(snap.swaps().spilled()); // no zram in front of it
+    const size_t hash = snap.m_swapsHash;
+
+    snap.refresh();
+    EXPECT_EQ(hash, snap.m_swapsHash);
+    EXPECT_DOUBLE_EQ(4.0, snap.mem().swapTotalMiB); // totals reapplied from the cached parse
+
+    writeSwaps("/dev/zram0 partition 2048 2048 100\n/dev/sda2 partition 4096 1024 -2\n");
+    snap.refresh();
+    EXPECT_NE(hash, snap.m_swapsHash);
+    ASSERT_EQ(2, snap.swaps().deviceCount);
+    EXPECT_DOUBLE_EQ(1.0, snap.swaps().spilledMiB);
+}
+
+TEST(SystemSnapshotTest, SamplesCgroupSubtree)
+{
+    QTemporaryDir procDir;
+    QTemporaryDir sysDir;
+    QTemporaryDir cgDir;
+    auto write = [](const QString& path, const QByteArray& content) {
+        QDir().mkpath(QFileInfo(path).path());
+        QFile f(path);
+        ASSERT_TRUE(f.open(QIODevice::WriteOnly));
+        f.write(content);
+    };
+    write(procDir.filePath("meminfo"), "MemTotal: 8388608 kB\nMemAvailable: 4194304 kB\n");
+    write(cgDir.filePath("user.slice/memory.current"), "2147483648\n");
+    write(cgDir.filePath("user.slice/memory.max"), "max\n");
+    write(cgDir.filePath("user.slice/app-x.scope/memory.current"), "1073741824\n");
+    write(cgDir.filePath("user.slice/app-x.scope/memory.max"), "2147483648\n");
+    write(cgDir.filePath("system.slice/memory.current"), "536870912\n");
+
+    SystemSnapshot snap(procDir.path(), sysDir.path());
+    snap.refresh();
+    EXPECT_FALSE(snap.cgroups().present);
+
+    snap.enableCgroups(cgDir.path(), QStringLiteral("/"));
+    snap.refresh();
+    const CgroupInfo& cg = snap.cgroups();
+    ASSERT_TRUE(cg.present);
+    ASSERT_EQ(2, cg.sliceCount);
+    EXPECT_STREQ("user.slice", cg.slices[0].path);
+    EXPECT_DOUBLE_EQ(2048.0, cg.slices[0].currentMiB);
+    EXPECT_DOUBLE_EQ(-1.0, cg.slices[0].maxMiB);
+    ASSERT_EQ(2, cg.scopeCount);
+    EXPECT_STREQ("user.slice/app-x.scope", cg.scopes[0].path);
+    EXPECT_DOUBLE_EQ(2048.0, cg.scopes[0].maxMiB);
+
+    // Survives the trip through SnapshotData
+    SystemSnapshot gui;
+    gui.assign(snap.data());
+    EXPECT_STREQ("system.slice", gui.cgroups().slices[1].path);
+}
+
+static void writeTree(const QString& path, const QByteArray& content)
+{
+    QDir().mkpath(QFileInfo(path).path());
+    QFile f(path);
+    ASSERT_TRUE(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    f.write(content);
+}
+
+TEST(SystemSnapshotTest, LimitCgroupCapsTotalsAndAvailable)
+{
+    QTemporaryDir procDir;
+    QTemporaryDir sysDir;
+    QTemporaryDir cgDir;
+    // Host: 8 GiB RAM with 6 GiB available, 4 GiB swap with 3 GiB free
+    writeTree(procDir.filePath("meminfo"), "MemTotal: 8388608 kB\nMemAvailable: 6291456 kB\n"
+                                           "SwapTotal: 4194304 kB\nSwapFree: 3145728 kB\n");
+    writeTree(procDir.filePath("self/cgroup"), "0::/box.slice/app.scope\n");
+    // The slice caps memory at 2 GiB with 1.5 GiB in use, the scope itself
+    // is unlimited but may only swap 512 MiB
+    writeTree(cgDir.filePath("box.slice/memory.max"), "2147483648\n");
+    writeTree(cgDir.filePath("box.slice/memory.current"), "1610612736\n");
+    writeTree(cgDir.filePath("box.slice/memory.swap.max"), "max\n");
+    writeTree(cgDir.filePath("box.slice/app.scope/memory.max"), "max\n");
+    writeTree(cgDir.filePath("box.slice/app.scope/memory.current"), "1073741824\n");
+    writeTree(cgDir.filePath("box.slice/app.scope/memory.swap.max"), "536870912\n");
+    writeTree(cgDir.filePath("box.slice/app.scope/memory.swap.current"), "134217728\n");
+
+    SystemSnapshot snap(procDir.path(), sysDir.path());
+    snap.setLimitCgroup(cgDir.path(), QStringLiteral("self"));
+    snap.refresh();
+
+    EXPECT_DOUBLE_EQ(8192.0, snap.hostMem().memTotalMiB);
+    EXPECT_DOUBLE_EQ(2048.0, snap.mem().memTotalMiB);
+    EXPECT_DOUBLE_EQ(512.0, snap.mem().memAvailableMiB);   // slice headroom
+    EXPECT_DOUBLE_EQ(25.0, snap.mem().memAvailablePercent);
+    EXPECT_DOUBLE_EQ(512.0, snap.mem().swapTotalMiB);
+    EXPECT_DOUBLE_EQ(384.0, snap.mem().swapFreeMiB);
+
+    const CgroupLimitInfo& lim = snap.limit();
+    ASSERT_TRUE(lim.present);
+    EXPECT_STREQ("/box.slice/app.scope", lim.path);
+    EXPECT_DOUBLE_EQ(2048.0, lim.memMaxMiB);
+    EXPECT_DOUBLE_EQ(1024.0, lim.memCurrentMiB);
+    EXPECT_DOUBLE_EQ(512.0, lim.swapMaxMiB);
+
+    // Limits above the host's totals change nothing
+    writeTree(cgDir.filePath("box.slice/memory.max"), "17179869184\n");
+    writeTree(cgDir.filePath("box.slice/memory.current"), "0\n");
+    snap.refresh();
+    EXPECT_DOUBLE_EQ(8192.0, snap.mem().memTotalMiB);
+    EXPECT_DOUBLE_EQ(6144.0, snap.mem().memAvailableMiB);
+}
+
+TEST(SystemSnapshotTest, MissingLimitCgroupUsesHostTotals)
+{
+    QTemporaryDir procDir;
+    QTemporaryDir sysDir;
+    QTemporaryDir cgDir;
+    writeTree(procDir.filePath("meminfo"), "MemTotal: 2048 kB\nMemAvailable: 1024 kB\n");
+
+    SystemSnapshot snap(procDir.path(), sysDir.path());
+    snap.setLimitCgroup(cgDir.path(), QStringLiteral("/system.slice/nohang-desktop.service"));
+    snap.refresh();
+    EXPECT_FALSE(snap.limit().present);
+    EXPECT_DOUBLE_EQ(2.0, snap.mem().memTotalMiB);
+    EXPECT_DOUBLE_EQ(2.0, snap.hostMem().memTotalMiB);
+}
+
+static void writeVmstat(const QString& path, int majfault, int pswpin, int refaultFile, int scanKswapd, int scanDirect)
+{
+    QFile f(path);
+    ASSERT_TRUE(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    f.write(QStringLiteral("nr_free_pages 1000\n"
+                           "pgmajfault %1\n"
+                           "pswpin %2\n"
+                           "pswpout 0\n"
+                           "workingset_refault_anon 0\n"
+                           "workingset_refault_file %3\n"
+                           "pgscan_kswapd %4\n"
+                           "pgscan_direct %5\n"
+                           "pgsteal_kswapd %4\n"
+                           "oom_kill 3\n")
+                .arg(majfault).arg(pswpin).arg(refaultFile).arg(scanKswapd).arg(scanDirect).toLatin1());
+}
+
+TEST(SystemSnapshotTest, VmstatRatesOverWindow)
+{
+    QTemporaryDir procDir;
+    QTemporaryDir sysDir;
+    writeVmstat(procDir.filePath("vmstat"), 100, 100, 100, 100, 0);
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("cannot open .*meminfo"));
+
+    SystemSnapshot snap(procDir.path(), sysDir.path());
+    snap.refresh();
+    EXPECT_FALSE(snap.vmstat().present); // no window yet
+    EXPECT_EQ(3, snap.vmstat().oomKills);
+
+    // Pretend the first sample is two seconds old
+    snap.m_vmstatPrevMs -= 2000;
+    const double pageMiB = ::sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+    writeVmstat(procDir.filePath("vmstat"), 300, 100 + 512, 100, 1100, 1000);
+    snap.refresh();
+    const VmstatInfo& vm = snap.vmstat();
+    ASSERT_TRUE(vm.present);
+    EXPECT_NEAR(100.0, vm.majorFaultsPerSec, 1.0);
+    EXPECT_NEAR(256 * pageMiB, vm.swapInMiBPerSec, 0.01 * 256 * pageMiB);
+    EXPECT_DOUBLE_EQ(0.0, vm.refaultMiBPerSec());
+    EXPECT_NEAR(1000.0, vm.scanPerSec, 10.0);
+    EXPECT_NEAR(500.0, vm.directScanPerSec, 5.0);
+
+    // Within the window the rates stand
+    writeVmstat(procDir.filePath("vmstat"), 300, 100000, 100, 1100, 1000);
+    snap.refresh();
+    EXPECT_NEAR(256 * pageMiB, snap.vmstat().swapInMiBPerSec, 0.01 * 256 * pageMiB);
+}
+
+TEST(SystemSnapshotTest, ParsesOnlySubscribedMeminfoFields)
+{
+    QTemporaryDir procDir;
+    QTemporaryDir sysDir;
+    QFile meminfo(procDir.filePath("meminfo"));
+    ASSERT_TRUE(meminfo.open(QIODevice::WriteOnly | QIODevice::Text));
+    meminfo.write("MemTotal:       4096 kB\n"
+                  "MemFree:         512 kB\n"
+                  "MemAvailable:   2048 kB\n"
+                  "Active(file):   1024 kB\n"
+                  "Inactive(file):  256 kB\n"
+                  "Dirty:            64 kB\n"
+                  "SwapTotal:         0 kB\n"
+                  "SwapFree:          0 kB\n"
+                  "HugePages_Total:   0\n"
+                  "Hugepagesize:   2048 kB\n");
+    meminfo.close();
+
+    SystemSnapshot snap(procDir.path(), sysDir.path());
+    snap.refresh();
+    EXPECT_DOUBLE_EQ(4.0, snap.mem().memTotalMiB);
+    EXPECT_TRUE(snap.mem().has(MeminfoField::MemTotal));
+    EXPECT_FALSE(snap.mem().has(MeminfoField::ActiveFile)); // not subscribed
+    EXPECT_DOUBLE_EQ(0.0, snap.mem().kib(MeminfoField::ActiveFile));
+
+    snap.subscribeMeminfo(meminfoBits({MeminfoField::ActiveFile, MeminfoField::Dirty, MeminfoField::Shmem}));
+    snap.refresh();
+    EXPECT_TRUE(snap.mem().has(MeminfoField::ActiveFile));
+    EXPECT_DOUBLE_EQ(1024.0, snap.mem().kib(MeminfoField::ActiveFile));
+    EXPECT_DOUBLE_EQ(64.0, snap.hostMem().kib(MeminfoField::Dirty));
+    EXPECT_FALSE(snap.mem().has(MeminfoField::InactiveFile)); // still not subscribed
+    EXPECT_FALSE(snap.mem().has(MeminfoField::Shmem));        // subscribed, not printed
+    EXPECT_DOUBLE_EQ(2.0, snap.mem().memAvailableMiB);
+}
+
+TEST(SystemSnapshotTest, ReadsZswapPool)
+{
+    QTemporaryDir procDir;
+    QTemporaryDir sysDir;
+    QFile meminfo(procDir.filePath("meminfo"));
+    ASSERT_TRUE(meminfo.open(QIODevice::WriteOnly | QIODevice::Text));
+    meminfo.write("MemTotal:     8388608 kB\n"
+                  "MemAvailable: 4194304 kB\n"
+                  "Zswap:         409600 kB\n"
+                  "Zswapped:     1228800 kB\n");
+    meminfo.close();
+
+    SystemSnapshot snap(procDir.path(), sysDir.path());
+    snap.refresh();
+    EXPECT_FALSE(snap.zswap().present);
+
+    const QString params = sysDir.path() + "/module/zswap/parameters";
+    QDir().mkpath(params);
+    auto write = [&](const char* name, const QByteArray& v) {
+        QFile f(params + '/' + name);
+        ASSERT_TRUE(f.open(QIODevice::WriteOnly));
+        f.write(v);
+    };
+    write("enabled", "Y\n");
+    write("max_pool_percent", "20\n");
+    write("compressor", "zstd\n");
+    snap.refresh(); // the reader retries missing files on each batch
+
+    const ZswapInfo& z = snap.zswap();
+    ASSERT_TRUE(z.present);
+    EXPECT_TRUE(z.enabled);
+    EXPECT_STREQ("zstd", z.compressor);
+    EXPECT_DOUBLE_EQ(400.0, z.poolMiB);
+    EXPECT_DOUBLE_EQ(1200.0, z.storedMiB);
+    EXPECT_DOUBLE_EQ(1638.4, z.poolLimitMiB);
+    EXPECT_NEAR(24.41, z.poolUsedPercent, 0.01);
+    EXPECT_DOUBLE_EQ(3.0, z.compressionRatio);
+}
+
+static void addNode(const QString& sysRoot, int id, int totalMiB, int freeMiB, int inactiveFileMiB, int foreign)
+{
+    const QString dir = sysRoot + QStringLiteral("/devices/system/node/node%1").arg(id);
+    QDir().mkpath(dir);
+    QFile mem(dir + "/meminfo");
+    ASSERT_TRUE(mem.open(QIODevice::WriteOnly));
+    mem.write(QStringLiteral("Node %1 MemTotal:       %2 kB\n"
+                             "Node %1 MemFree:        %3 kB\n"
+                             "Node %1 MemUsed:        0 kB\n"
+                             "Node %1 Active:         1024 kB\n"
+                             "Node %1 Inactive:       %4 kB\n"
+                             "Node %1 Inactive(file): %4 kB\n"
+                             "Node %1 FilePages:      %4 kB\n")
+                  .arg(id).arg(totalMiB * 1024).arg(freeMiB * 1024).arg(inactiveFileMiB * 1024).toLatin1());
+    QFile stat(dir + "/numastat");
+    ASSERT_TRUE(stat.open(QIODevice::WriteOnly));
+    stat.write(QStringLiteral("numa_hit 1000\nnuma_miss 7\nnuma_foreign %1\n").arg(foreign).toLatin1());
+}
+
+TEST(SystemSnapshotTest, RanksNumaNodesByAvailable)
+{
+    QTemporaryDir procDir;
+    QTemporaryDir sysDir;
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("cannot open .*meminfo"));
+    addNode(sysDir.path(), 0, 16384, 8000, 2000, 0);
+    addNode(sysDir.path(), 1, 16384, 300, 200, 42);
+    QDir().mkpath(sysDir.path() + "/devices/system/node/possible_not_a_node");
+
+    SystemSnapshot snap(procDir.path(), sysDir.path());
+    snap.enableNuma();
+    snap.refresh();
+
+    const NumaInfo& numa = snap.numa();
+    ASSERT_TRUE(numa.present);
+    EXPECT_EQ(2, numa.nodeCount);
+    ASSERT_EQ(2, numa.shown);
+    EXPECT_EQ(1, numa.nodes[0].id); // most constrained first
+    EXPECT_DOUBLE_EQ(500.0, numa.nodes[0].availableMiB);
+    EXPECT_NEAR(3.05, numa.nodes[0].availablePercent, 0.01);
+    EXPECT_DOUBLE_EQ(200.0, numa.nodes[0].filePagesMiB);
+    EXPECT_EQ(42, numa.nodes[0].numaForeign);
+    EXPECT_EQ(7, numa.nodes[0].numaMiss);
+    EXPECT_EQ(0, numa.nodes[1].id);
+}
+
+TEST(SystemSnapshotTest, SkipsMemorylessNumaNodes)
+{
+    QTemporaryDir procDir;
+    QTemporaryDir sysDir;
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("cannot open .*meminfo"));
+    addNode(sysDir.path(), 0, 16384, 8000, 2000, 0);
+    addNode(sysDir.path(), 1, 16384, 4000, 1000, 0);
+    addNode(sysDir.path(), 2, 0, 0, 0, 0); // CPU-only
+
+    SystemSnapshot snap(procDir.path(), sysDir.path());
+    snap.enableNuma();
+    snap.refresh();
+
+    const NumaInfo& numa = snap.numa();
+    ASSERT_TRUE(numa.present);
+    EXPECT_EQ(2, numa.nodeCount);
+    ASSERT_EQ(2, numa.shown);
+    EXPECT_EQ(1, numa.nodes[0].id); // not the empty node at 0 %
+}
+
+TEST(SystemSnapshotTest, SingleNodeHostSkipsNuma)
+{
+    QTemporaryDir procDir;
+    QTemporaryDir sysDir;
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("cannot open .*meminfo"));
+    addNode(sysDir.path(), 0, 16384, 8000, 2000, 0);
+
+    SystemSnapshot snap(procDir.path(), sysDir.path());
+    snap.enableNuma();
+    snap.refresh();
+    EXPECT_FALSE(snap.numa().present);
 }
@@ -0,0 +1,95 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "ThresholdSimulator.h"
+
+static ThresholdSimulator::Sample sample(float memAvailable, float psiSome = 0)
+{
+    ThresholdSimulator::Sample s;
+    s.memAvailableMiB = memAvailable;
+    s.swapFreeMiB = 1000;
+    s.psiSomeAvg10 = psiSome;
+    s.memTotalMiB = 1000;
+    s.swapTotalMiB = 1000;
+    return s;
+}
+
+TEST(ThresholdSimulatorTest, CountsEntriesPerLevel)
+{
+    ThresholdSimulator sim;
+    // normal, warn, warn, hard, normal, soft
+    const float mem[] = {500, 150, 150, 40, 500, 80};
+    for (int i = 0; i < 6; ++i) sim.append(i * 1000, sample(mem[i]));
+
+    ThresholdsPercent t;
+    t.warn_mem_percent = 20;
+    t.soft_mem_percent = 10;
+    t.hard_mem_percent = 5;
+    const ThresholdSimulator::Result r = sim.evaluate(t);
+    EXPECT_EQ(2, r.events[ThresholdSimulator::Warn]);
+    EXPECT_EQ(2, r.events[ThresholdSimulator::Soft]);
+    EXPECT_EQ(1, r.events[ThresholdSimulator::Hard]);
+    ASSERT_EQ(2u, r.startsMs[ThresholdSimulator::Soft].size());
+    EXPECT_EQ(3000, r.startsMs[ThresholdSimulator::Soft][0]);
+    EXPECT_EQ(5000, r.startsMs[ThresholdSimulator::Soft][1]);
+    EXPECT_EQ(3000, r.durationMs[ThresholdSimulator::Warn]); // the last sample has no length
+    EXPECT_EQ(1000, r.durationMs[ThresholdSimulator::Hard]);
+}
+
+TEST(ThresholdSimulatorTest, ComputesThresholdsPerTotals)
+{
+    ThresholdSimulator sim;
+    sim.append(0, sample(150));
+    ThresholdSimulator::Sample bigger = sample(150);
+    bigger.memTotalMiB = 2000; // 150 of 2000 is below 10 %
+    sim.append(1000, bigger);
+
+    ThresholdsPercent t;
+    t.soft_mem_percent = 10;
+    const ThresholdSimulator::Result r = sim.evaluate(t);
+    EXPECT_EQ(1, r.events[ThresholdSimulator::Soft]);
+    EXPECT_EQ(1000, r.startsMs[ThresholdSimulator::Soft][0]);
+
+    // MiB thresholds do not depend on totals
+    t.soft_mem_percent = -200.0;
+    EXPECT_EQ(0, sim.evaluate(t).startsMs[ThresholdSimulator::Soft][0]);
+}
+
+TEST(ThresholdSimulatorTest, PsiHonoursExcessDuration)
+{
+    ThresholdSimulator sim;
+    const float psi[] = {0, 50, 50, 0, 50, 50, 50, 50};
+    for (int i = 0; i < 8; ++i) sim.append(i * 1000, sample(500, psi[i]));
+
+    ThresholdsPercent t;
+    t.warn_psi = 30;
+    t.psi_metrics = QStringLiteral("some");
+    EXPECT_EQ(2, sim.evaluate(t).events[ThresholdSimulator::Warn]);
+
+    t.psi_duration = 2; // the first burst lasts only 1 s past its start
+    const ThresholdSimulator::Result r = sim.evaluate(t);
+    EXPECT_EQ(1, r.events[ThresholdSimulator::Warn]);
+    EXPECT_EQ(6000, r.startsMs[ThresholdSimulator::Warn][0]);
+
+    // full_avg10 by default, which stayed at zero
+    t.psi_metrics.clear();
+    EXPECT_EQ(0, sim.evaluate(t).events[ThresholdSimulator::Warn]);
+}
+
+TEST(ThresholdSimulatorTest, UnsetThresholdsNeverFire)
+{
+    ThresholdSimulator sim;
+    sim.append(0, sample(0, 100));
+    const ThresholdSimulator::Result r = sim.evaluate(ThresholdsPercent {});
+    EXPECT_EQ(0, r.events[ThresholdSimulator::Warn]);
+    EXPECT_EQ(0, r.events[ThresholdSimulator::Hard]);
+}
+
+TEST(ThresholdSimulatorTest, CapsRecordingGaps)
+{
+    ThresholdSimulator sim;
+    sim.append(0, sample(0));
+    sim.append(3600 * 1000, sample(0));
+    ThresholdsPercent t;
+    t.hard_mem_percent = 5;
+    EXPECT_EQ(ThresholdSimulator::kMaxGapMs, sim.evaluate(t).durationMs[ThresholdSimulator::Hard]);
+}
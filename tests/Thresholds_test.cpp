@@ -1,6 +1,8 @@
 #include "pch.h"
 #include <gtest/gtest.h>
 #include "Thresholds.h"
+#include <QDir>
+#include <QTemporaryDir>
 
 // Stub SystemSnapshot with controllable totals
 class StubSnapshot : public SystemSnapshot {
@@ -92,3 +94,29 @@ TEST(ThresholdsTest, HandlesAbsoluteMiBValues)
     ASSERT_TRUE(out.warn_mem_free.mib.has_value());
     EXPECT_DOUBLE_EQ(100.0, out.warn_mem_free.mib.value());
 }
+
+TEST(ThresholdsTest, PercentagesFollowCgroupLimit)
+{
+    QTemporaryDir procDir;
+    QTemporaryDir sysDir;
+    QTemporaryDir cgDir;
+    auto write = [](const QString& path, const QByteArray& content) {
+        QDir().mkpath(QFileInfo(path).path());
+        QFile f(path);
+        ASSERT_TRUE(f.open(QIODevice::WriteOnly));
+        f.write(content);
+    };
+    write(procDir.filePath("meminfo"), "MemTotal: 16777216 kB\nMemAvailable: 8388608 kB\n");
+    write(cgDir.filePath("nohang.service/memory.max"), "1073741824\n");
+    write(cgDir.filePath("nohang.service/memory.current"), "0\n");
+
+    SystemSnapshot snap(procDir.path(), sysDir.path());
+    snap.setLimitCgroup(cgDir.path(), QStringLiteral("/nohang.service"));
+    snap.refresh();
+
+    ThresholdsPercent t;
+    t.warn_mem_percent = 10.0;
+    const ThresholdSet out = Thresholds::compute(t, snap);
+    ASSERT_TRUE(out.warn_mem_free.mib.has_value());
+    EXPECT_DOUBLE_EQ(102.4, out.warn_mem_free.mib.value()); // 10 % of 1 GiB, not of 16 GiB
+}
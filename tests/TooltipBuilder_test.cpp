@@ -5,6 +5,8 @@
 #include "SystemSnapshot.h"
 #undef private
 #include "TooltipBuilder.h"
+#include "TopConsumers.h"
+#include <cstring>
 
 TEST(TooltipBuilderTest, BuildsSummary)
 {
@@ -105,3 +107,175 @@ TEST(TooltipBuilderTest, OmitsZramSectionWhenAbsent)
     const QString out = tb.build(cfg, snap, false, QString());
     EXPECT_EQ(-1, out.indexOf("ZRAM:"));
 }
+
+TEST(TooltipBuilderTest, ListsTopConsumersWhenGiven)
+{
+    NoHangConfig cfg;
+    SystemSnapshot snap;
+    TooltipBuilder tb;
+    EXPECT_EQ(-1, tb.build(cfg, snap, true, QString()).indexOf("Top memory"));
+
+    ProcessInfo big;
+    big.pid = 4242;
+    big.name = "firefox";
+    big.rssKiB = 2048 * 1024;
+    big.swapKiB = 512 * 1024;
+    big.oomScore = 812;
+    TopConsumersResult top;
+    top.byMemory = {big};
+    top.byOomScore = {big};
+
+    const QString out = tb.build(cfg, snap, true, QString(), &top);
+    EXPECT_TRUE(out.contains("Top memory (RSS + swap):\n  firefox [4242] 2560 MiB\n"));
+    EXPECT_TRUE(out.contains("Likely OOM victims (oom_score):\n  firefox [4242] 812\n"));
+}
+
+TEST(TooltipBuilderTest, ListsCgroupSlicesAndScopes)
+{
+    NoHangConfig cfg;
+    SystemSnapshot snap;
+    snap.m_cgroups.present = true;
+    snap.m_cgroups.sliceCount = 1;
+    std::strcpy(snap.m_cgroups.slices[0].path, "user.slice");
+    snap.m_cgroups.slices[0].currentMiB = 3000;
+    snap.m_cgroups.slices[0].swapCurrentMiB = 64;
+    snap.m_cgroups.scopeCount = 1;
+    std::strcpy(snap.m_cgroups.scopes[0].path, "user.slice/user-1000.slice/app-firefox.scope");
+    snap.m_cgroups.scopes[0].currentMiB = 2000;
+    snap.m_cgroups.scopes[0].maxMiB = 4096;
+    snap.m_cgroups.scopes[0].someAvg10 = 1.5;
+
+    TooltipBuilder tb;
+    const QString out = tb.build(cfg, snap, true, QString());
+    EXPECT_TRUE(out.contains("Slices:\n  user.slice 3000 MiB, swap 64 MiB, PSI some 0.00\n"));
+    EXPECT_TRUE(out.contains("Top scopes:\n  app-firefox.scope 2000 MiB / 4096 MiB, PSI some 1.50\n"));
+}
+
+TEST(TooltipBuilderTest, ShowsCgroupLimit)
+{
+    NoHangConfig cfg;
+    SystemSnapshot snap;
+    snap.m_hostMem.memTotalMiB = 16384;
+    snap.m_limit.present = true;
+    std::strcpy(snap.m_limit.path, "/system.slice/nohang-desktop.service");
+    snap.m_limit.memMaxMiB = 2048;
+    snap.m_limit.memCurrentMiB = 1500;
+
+    TooltipBuilder tb;
+    const QString out = tb.build(cfg, snap, true, QString());
+    EXPECT_TRUE(out.contains("Limit: /system.slice/nohang-desktop.service, memory.max 2048 MiB, current 1500 MiB (host RAM 16384 MiB)\n"));
+
+    snap.m_limit.memMaxMiB = -1;
+    EXPECT_EQ(-1, tb.build(cfg, snap, true, QString()).indexOf("Limit:"));
+}
+
+TEST(TooltipBuilderTest, ShowsPagingRates)
+{
+    NoHangConfig cfg;
+    SystemSnapshot snap;
+    TooltipBuilder tb;
+    EXPECT_EQ(-1, tb.build(cfg, snap, true, QString()).indexOf("Paging:"));
+
+    snap.m_vmstat.present = true;
+    snap.m_vmstat.swapInMiBPerSec = 12.25;
+    snap.m_vmstat.swapOutMiBPerSec = 3;
+    snap.m_vmstat.refaultAnonMiBPerSec = 1;
+    snap.m_vmstat.refaultFileMiBPerSec = 4;
+    snap.m_vmstat.majorFaultsPerSec = 250;
+    snap.m_vmstat.scanPerSec = 2000;
+    snap.m_vmstat.directScanPerSec = 500;
+    snap.m_vmstat.stealPerSec = 500;
+    snap.m_vmstat.oomKills = 2;
+    const QString out = tb.build(cfg, snap, true, QString());
+    EXPECT_TRUE(out.contains("Paging: swap in 12.3 MiB/s, out 3.0 MiB/s, refaults 5.0 MiB/s, major faults 250/s\n")) << qPrintable(out);
+    EXPECT_TRUE(out.contains("Reclaim: scanned 2000 pages/s (direct 500), efficiency 25.0 %\n"));
+    EXPECT_TRUE(out.contains("OOM kills since boot: 2\n"));
+}
+
+TEST(TooltipBuilderTest, ShowsCacheAndAnonBreakdown)
+{
+    NoHangConfig cfg;
+    SystemSnapshot snap;
+    auto set = [&](MeminfoField f, double kib) {
+        snap.m_hostMem.fieldKiB[static_cast<int>(f)] = kib;
+        snap.m_hostMem.fields |= meminfoBit(f);
+    };
+    set(MeminfoField::ActiveFile, 2048 * 1024);
+    set(MeminfoField::InactiveFile, 1024 * 1024);
+    set(MeminfoField::Dirty, 100 * 1024);
+    set(MeminfoField::Writeback, 0);
+    set(MeminfoField::ActiveAnon, 4096 * 1024);
+    set(MeminfoField::InactiveAnon, 512 * 1024);
+    set(MeminfoField::AnonHugePages, 256 * 1024);
+
+    TooltipBuilder tb;
+    const QString out = tb.build(cfg, snap, true, QString());
+    EXPECT_TRUE(out.contains("Cache: active 2048 MiB, inactive 1024 MiB, dirty 100 MiB\n")) << qPrintable(out);
+    EXPECT_TRUE(out.contains("Anon: active 4096 MiB, inactive 512 MiB, THP 256 MiB\n"));
+}
+
+TEST(TooltipBuilderTest, ShowsZswapPool)
+{
+    NoHangConfig cfg;
+    SystemSnapshot snap;
+    snap.m_zswap.present = true;
+    snap.m_zswap.enabled = true;
+    std::strcpy(snap.m_zswap.compressor, "lz4");
+    snap.m_zswap.poolMiB = 400;
+    snap.m_zswap.storedMiB = 1200;
+    snap.m_zswap.poolLimitMiB = 1600;
+    snap.m_zswap.poolUsedPercent = 25;
+    snap.m_zswap.compressionRatio = 3;
+
+    TooltipBuilder tb;
+    EXPECT_TRUE(tb.build(cfg, snap, true, QString())
+                    .contains("zswap: pool 400 MiB of 1600 MiB (25.0 %), stored 1200 MiB, ratio 3.0, lz4\n"));
+
+    snap.m_zswap.enabled = false;
+    snap.m_zswap.poolMiB = 0;
+    EXPECT_EQ(-1, tb.build(cfg, snap, true, QString()).indexOf("zswap:"));
+}
+
+TEST(TooltipBuilderTest, ShowsMostConstrainedNumaNode)
+{
+    NoHangConfig cfg;
+    SystemSnapshot snap;
+    snap.m_numa.present = true;
+    snap.m_numa.nodeCount = 4;
+    snap.m_numa.shown = 4;
+    NumaNode& n = snap.m_numa.nodes[0];
+    n.id = 2;
+    n.availableMiB = 512;
+    n.availablePercent = 3.1;
+    n.freeMiB = 300;
+    n.filePagesMiB = 900;
+    n.numaForeign = 12;
+
+    TooltipBuilder tb;
+    EXPECT_TRUE(tb.build(cfg, snap, true, QString())
+                    .contains("NUMA: node 2 of 4 lowest, available 512 MiB (3.1 %), free 300 MiB, file 900 MiB, foreign allocations 12\n"));
+}
+
+TEST(TooltipBuilderTest, ListsSwapDevicesAndSpill)
+{
+    NoHangConfig cfg;
+    SystemSnapshot snap;
+    snap.m_swaps.deviceCount = 2;
+    std::strcpy(snap.m_swaps.devices[0].path, "/dev/zram0");
+    snap.m_swaps.devices[0].zram = true;
+    snap.m_swaps.devices[0].priority = 100;
+    snap.m_swaps.devices[0].sizeMiB = 4096;
+    snap.m_swaps.devices[0].usedMiB = 4096;
+    std::strcpy(snap.m_swaps.devices[1].path, "/swapfile");
+    snap.m_swaps.devices[1].file = true;
+    snap.m_swaps.devices[1].priority = -2;
+    snap.m_swaps.devices[1].sizeMiB = 8192;
+    snap.m_swaps.devices[1].usedMiB = 300;
+    snap.m_swaps.spilledMiB = 300;
+
+    TooltipBuilder tb;
+    const QString out = tb.build(cfg, snap, true, QString());
+    EXPECT_TRUE(out.contains("  /dev/zram0 (zram, prio 100) 4096 MiB of 4096 MiB\n")) << qPrintable(out);
+    EXPECT_TRUE(out.contains("  /swapfile (file, prio -2) 300 MiB of 8192 MiB\n"));
+    EXPECT_TRUE(out.contains("Spilled to disk swap: 300 MiB\n"));
+}
@@ -0,0 +1,82 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "FakeProc.h"
+#include "TopConsumers.h"
+#include <QDir>
+#include <QTemporaryDir>
+
+// Named proc<pid>, which the expectations below use
+static void addProcess(const QString& root, int pid, qint64 rssKiB, qint64 swapKiB, int oomScore)
+{
+    FakeProc::addProcess(root, pid, "proc" + QByteArray::number(pid), rssKiB, swapKiB, oomScore);
+}
+
+static QVector<int> pids(const QVector<ProcessInfo>& rows)
+{
+    QVector<int> out;
+    for (const ProcessInfo& p : rows) out.push_back(p.pid);
+    return out;
+}
+
+TEST(TopConsumersTest, RanksByMemoryAndOomScore)
+{
+    QTemporaryDir root;
+    // pid, rss, swap, oom_score
+    addProcess(root.path(), 1, 100, 0, 0);
+    addProcess(root.path(), 2, 5000, 0, 100);
+    addProcess(root.path(), 3, 1000, 6000, 900);  // small RSS, large swap
+    addProcess(root.path(), 4, 3000, 0, 300);
+    addProcess(root.path(), 5, 3000, 0, 300);     // tie with 4, lower pid wins
+    addProcess(root.path(), 6, 200, 0, 950);
+    addProcess(root.path(), 7, 4000, 0, 10);
+
+    TopConsumers top(root.path(), 5);
+    EXPECT_TRUE(top.step(std::chrono::seconds(10)));
+    const TopConsumersResult& r = top.result();
+    EXPECT_EQ(7, r.scanned);
+    EXPECT_EQ(1, r.steps);
+    EXPECT_EQ((QVector<int>{3, 2, 7, 4, 5}), pids(r.byMemory));
+    EXPECT_EQ((QVector<int>{6, 3, 4, 5, 2}), pids(r.byOomScore));
+    EXPECT_EQ(7000, TopConsumers::memoryKiB(r.byMemory[0]));
+    EXPECT_EQ(QStringLiteral("proc3"), r.byMemory[0].name);
+}
+
+TEST(TopConsumersTest, BudgetSpreadsPassOverSteps)
+{
+    QTemporaryDir root;
+    for (int pid = 1; pid <= 40; ++pid) addProcess(root.path(), pid, pid * 10, 0, pid);
+
+    TopConsumers top(root.path(), 3);
+    int steps = 1;
+    while (!top.step(std::chrono::microseconds(0))) {
+        EXPECT_TRUE(top.inPass());
+        ASSERT_LT(++steps, 100);
+    }
+    EXPECT_GT(steps, 1);
+    EXPECT_EQ(steps, top.result().steps);
+    EXPECT_EQ(40, top.result().scanned);
+    EXPECT_EQ((QVector<int>{40, 39, 38}), pids(top.result().byMemory));
+
+    // Next pass reuses the buffers and picks up changes
+    QDir(root.filePath("40")).removeRecursively();
+    addProcess(root.path(), 2, 99999, 0, 1);
+    while (!top.step(std::chrono::seconds(10))) {}
+    EXPECT_EQ(39, top.result().scanned);
+    EXPECT_EQ((QVector<int>{2, 39, 38}), pids(top.result().byMemory));
+    EXPECT_EQ((QVector<int>{39, 38, 37}), pids(top.result().byOomScore));
+}
+
+TEST(TopConsumersTest, HandlesFewerProcessesThanCount)
+{
+    QTemporaryDir root;
+    addProcess(root.path(), 8, 10, 0, 1);
+    TopConsumers top(root.path(), 5);
+    EXPECT_TRUE(top.step(std::chrono::seconds(1)));
+    EXPECT_EQ(1, top.result().byMemory.size());
+    EXPECT_EQ(1, top.result().byOomScore.size());
+
+    QTemporaryDir empty;
+    TopConsumers none(empty.path(), 5);
+    EXPECT_TRUE(none.step(std::chrono::seconds(1)));
+    EXPECT_TRUE(none.result().byMemory.isEmpty());
+}
@@ -0,0 +1,121 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+#include "SystemSnapshot.h"
+#include "TraceReplay.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTimer>
+
+// One frame as the capture one-liner writes it; zram only when zramMiB > 0
+static QByteArray frame(qint64 atMs, int availableMiB, int zramMiB = 0)
+{
+    QByteArray f = "@" + QByteArray::number(atMs) + "\n";
+    f += "==> /proc/meminfo <==\n";
+    f += "MemTotal:        8388608 kB\n";
+    f += "MemAvailable:    " + QByteArray::number(availableMiB * 1024) + " kB\n";
+    f += "SwapTotal:       0 kB\n";
+    f += "SwapFree:        0 kB\n";
+    f += "\n==> /proc/pressure/memory <==\n";
+    f += "some avg10=1.50 avg60=0.00 avg300=0.00 total=0\n";
+    f += "full avg10=0.25 avg60=0.00 avg300=0.00 total=0\n";
+    if (zramMiB > 0) {
+        f += "\n==> /sys/block/zram0/disksize <==\n";
+        f += QByteArray::number(qint64(4096) * 1024 * 1024) + "\n";
+        f += "\n==> /sys/block/zram0/mm_stat <==\n";
+        f += QByteArray::number(qint64(zramMiB) * 1024 * 1024) + " 0 0 0 0 0 0\n";
+    }
+    return f;
+}
+
+TEST(TraceTest, IndexesFramesAndSplitsFiles)
+{
+    Trace t;
+    t.setText(frame(1000, 4096, 512) + frame(2000, 2048));
+    ASSERT_EQ(2, t.frameCount());
+    EXPECT_EQ(1000, t.timeMs(0));
+    EXPECT_EQ(2000, t.timeMs(1));
+
+    std::vector<Trace::File> files;
+    t.files(0, &files);
+    ASSERT_EQ(4u, files.size());
+    EXPECT_EQ(QByteArrayView("/proc/meminfo"), files[0].first);
+    EXPECT_TRUE(files[0].second.startsWith("MemTotal:"));
+    EXPECT_TRUE(files[0].second.endsWith(" kB\n")); // head's blank separator is not content
+    EXPECT_EQ(QByteArrayView("/sys/block/zram0/mm_stat"), files[3].first);
+
+    t.files(1, &files);
+    EXPECT_EQ(2u, files.size());
+}
+
+TEST(TraceTest, RejectsFilesWithoutSamples)
+{
+    Trace t;
+    t.setText("MemTotal: 1 kB\n");
+    EXPECT_EQ(0, t.frameCount());
+    QString err;
+    EXPECT_FALSE(t.load(QStringLiteral("/nonexistent/nohang.trace"), &err));
+    EXPECT_FALSE(err.isEmpty());
+}
+
+TEST(TraceReplayTest, DrivesSnapshotOnRecordedClock)
+{
+    TraceReplay r;
+    r.setTrace(frame(5000, 4096, 512) + frame(6000, 1024));
+    const SystemSnapshot& snap = r.snapshot();
+
+    ASSERT_TRUE(r.step());
+    EXPECT_EQ(5000, r.nowMs());
+    EXPECT_EQ(5000, snap.sampledAtMs());
+    EXPECT_DOUBLE_EQ(4096, snap.mem().memAvailableMiB);
+    EXPECT_DOUBLE_EQ(1.5, snap.psi().some_avg10);
+    EXPECT_TRUE(snap.zram().present);
+    EXPECT_DOUBLE_EQ(512, snap.zram().origDataMiB);
+
+    // A file missing from a frame reads as missing, not as the last value
+    ASSERT_TRUE(r.step());
+    EXPECT_EQ(6000, snap.sampledAtMs());
+    EXPECT_DOUBLE_EQ(1024, snap.mem().memAvailableMiB);
+    EXPECT_FALSE(snap.zram().present);
+    EXPECT_TRUE(r.atEnd());
+    EXPECT_FALSE(r.step());
+}
+
+TEST(TraceReplayTest, RunPlaysEveryFrame)
+{
+    QByteArray text;
+    for (int i = 0; i < 100; ++i) text += frame(i * 1000, 4096 - i);
+    TraceReplay r;
+    r.setTrace(text);
+    int sampled = 0;
+    int finished = 0;
+    QObject::connect(&r, &TraceReplay::sampled, [&] { ++sampled; });
+    QObject::connect(&r, &TraceReplay::finished, [&] { ++finished; });
+    r.run();
+    EXPECT_EQ(100, sampled);
+    EXPECT_EQ(1, finished);
+    EXPECT_EQ(99000, r.nowMs());
+    EXPECT_DOUBLE_EQ(3997, r.snapshot().mem().memAvailableMiB);
+}
+
+TEST(TraceReplayTest, StartKeepsRecordedPacingScaled)
+{
+    int argc = 0;
+    QCoreApplication app(argc, nullptr);
+    QByteArray text;
+    for (int i = 0; i < 5; ++i) text += frame(i * 1000, 4096);
+    TraceReplay r;
+    r.setTrace(text);
+    int sampled = 0;
+    QObject::connect(&r, &TraceReplay::sampled, [&] { ++sampled; });
+    QObject::connect(&r, &TraceReplay::finished, &app, &QCoreApplication::quit, Qt::QueuedConnection);
+    QTimer::singleShot(5000, &app, &QCoreApplication::quit); // guard
+
+    QElapsedTimer wall;
+    wall.start();
+    r.start(100); // four recorded seconds in 40 ms
+    app.exec();
+    EXPECT_EQ(5, sampled);
+    EXPECT_TRUE(r.atEnd());
+    EXPECT_GE(wall.elapsed(), 30);
+    EXPECT_LT(wall.elapsed(), 2000);
+}
@@ -0,0 +1,95 @@
+// ===== tools/metrics_client.cpp =====
+// Reference client for the tray's metrics socket (nohang-tray --metrics-socket).
+//
+//   nohang-tray-metrics [--watch] [socket]
+//
+// Prints the latest sample once, or every change with --watch. The socket
+// defaults to $XDG_RUNTIME_DIR/nohang-tray.sock. Only needs MetricsProtocol.h.
+#include "MetricsProtocol.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using MetricsProtocol::Message;
+
+// The tray answers a get only once it has published a first sample
+static constexpr int kGetTimeoutSeconds = 3;
+
+static const char* levelName(unsigned s) {
+    static const char* names[] = {"normal", "warn", "soft", "hard"};
+    return s < 4 ? names[s] : "?";
+}
+
+static void print(const Message& m) {
+    std::printf("seq=%llu severity=%s cause=%u active=%d mem_available=%u/%u MiB swap_free=%u/%u MiB "
+                "psi_some=%.2f psi_full=%.2f swap_in=%u KiB/s refault=%u KiB/s majfault=%u/s",
+                static_cast<unsigned long long>(m.seq), levelName(m.severity), m.cause,
+                (m.flags & MetricsProtocol::DaemonActive) ? 1 : 0, m.memAvailableMiB, m.memTotalMiB,
+                m.swapFreeMiB, m.swapTotalMiB, m.psiSomeAvg10 / 100.0, m.psiFullAvg10 / 100.0,
+                m.swapInKiBPerSec, m.refaultKiBPerSec, m.majorFaultsPerSec);
+    if (m.flags & MetricsProtocol::HasZram) std::printf(" zram=%u MiB", m.zramUsedMiB);
+    if (m.flags & MetricsProtocol::HasZswap) std::printf(" zswap=%u MiB", m.zswapPoolMiB);
+    if (m.flags & MetricsProtocol::SpilledToDisk) std::printf(" spilled=%u MiB", m.spilledMiB);
+    if (m.flags & MetricsProtocol::HasNuma) std::printf(" worst_node=%.1f%%", m.worstNodePermille / 10.0);
+    std::printf("\n");
+    std::fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    bool watch = false;
+    std::string path;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--watch") == 0) watch = true;
+        else path = argv[i];
+    }
+    if (path.empty()) {
+        const char* runtime = std::getenv("XDG_RUNTIME_DIR");
+        path = std::string(runtime ? runtime : "/tmp") + "/nohang-tray.sock";
+    }
+
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::fprintf(stderr, "socket path too long\n");
+        return 2;
+    }
+    std::memcpy(addr.sun_path, path.data(), path.size());
+    const int fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::perror(path.c_str());
+        return 1;
+    }
+    if (!watch) {
+        const timeval timeout {kGetTimeoutSeconds, 0};
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+    const char req = watch ? MetricsProtocol::Subscribe : MetricsProtocol::Get;
+    if (::send(fd, &req, 1, MSG_NOSIGNAL) != 1) {
+        std::perror("send");
+        return 1;
+    }
+    for (;;) {
+        Message m;
+        const ssize_t n = ::recv(fd, &m, sizeof(m), 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            std::fprintf(stderr, "no sample within %d s, is the tray sampling yet?\n", kGetTimeoutSeconds);
+            ::close(fd);
+            return 1;
+        }
+        if (n <= 0) break;
+        if (n != static_cast<ssize_t>(sizeof(m)) || m.magic != MetricsProtocol::kMagic || m.size != sizeof(m)) {
+            std::fprintf(stderr, "unexpected message, version mismatch?\n");
+            return 1;
+        }
+        print(m);
+        if (!watch) break;
+    }
+    ::close(fd);
+    return 0;
+}